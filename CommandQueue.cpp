@@ -0,0 +1,58 @@
+/**
+ * @file CommandQueue.cpp
+ * @brief Implementation of the CommandQueue class.
+ */
+
+#include "CommandQueue.h"
+
+/**
+ * @brief Constructs an empty queue.
+ *
+ * @param capacity Minimum number of commands the queue holds; rounded up to a power of two.
+ */
+CommandQueue::CommandQueue(size_t capacity)
+        : head(0), tail(0) {
+    size_t size = 1;
+    while (size < capacity) {
+        size *= 2;
+    }
+    slots.resize(size);
+    mask = size - 1;
+}
+
+/**
+ * @brief Appends a command; called from the producer thread only.
+ *
+ * The command is written before the tail is published with release ordering, so the consumer
+ * never sees a slot it may read before its contents.
+ *
+ * @param command Command to enqueue.
+ * @return True if it was enqueued, false if the queue is full.
+ */
+bool CommandQueue::push(const PlayerCommand& command) {
+    size_t position = tail.load(memory_order_relaxed);
+    if (position - head.load(memory_order_acquire) == slots.size()) {
+        return false;
+    }
+
+    slots[position & mask] = command;
+    tail.store(position + 1, memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Takes the oldest command; called from the consumer thread only.
+ *
+ * @param command Receives the command.
+ * @return True if a command was taken, false if the queue is empty.
+ */
+bool CommandQueue::pop(PlayerCommand& command) {
+    size_t position = head.load(memory_order_relaxed);
+    if (position == tail.load(memory_order_acquire)) {
+        return false;
+    }
+
+    command = slots[position & mask];
+    head.store(position + 1, memory_order_release);
+    return true;
+}
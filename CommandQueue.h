@@ -0,0 +1,60 @@
+/**
+ * @file CommandQueue.h
+ * @brief Declaration of the CommandQueue class that hands player commands to the game loop.
+ */
+
+#ifndef COMMAND_QUEUE_H
+#define COMMAND_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+#include "Simulation.h"
+
+using namespace std;
+
+/**
+ * @class CommandQueue
+ * @brief Lock-free single-producer single-consumer ring of player commands.
+ *
+ * One thread (an input reader) pushes, one thread (the game loop) pops; neither ever waits
+ * for the other. The producer only writes the tail and the consumer only writes the head,
+ * and the two counters live on separate cache lines so they do not bounce between cores.
+ * When the ring is full, push() fails instead of blocking.
+ */
+class CommandQueue {
+private:
+    vector<PlayerCommand> slots;        ///< Ring storage; its size is a power of two
+    size_t mask;                        ///< slots.size() - 1
+    alignas(64) atomic<size_t> head;    ///< Count of commands popped; written by the consumer only
+    alignas(64) atomic<size_t> tail;    ///< Count of commands pushed; written by the producer only
+
+public:
+    /**
+     * @brief Constructs an empty queue.
+     * @param capacity Minimum number of commands the queue holds; rounded up to a power of two.
+     */
+    explicit CommandQueue(size_t capacity = 256);
+
+    CommandQueue(const CommandQueue&) = delete;
+    CommandQueue& operator=(const CommandQueue&) = delete;
+
+    /**
+     * @brief Appends a command; called from the producer thread only.
+     * @param command Command to enqueue.
+     * @return True if it was enqueued, false if the queue is full.
+     */
+    bool push(const PlayerCommand& command);
+
+    /**
+     * @brief Takes the oldest command; called from the consumer thread only.
+     * @param command Receives the command.
+     * @return True if a command was taken, false if the queue is empty.
+     */
+    bool pop(PlayerCommand& command);
+
+    /** @brief Gets the number of commands the queue holds. */
+    size_t capacity() const { return slots.size(); }
+};
+
+#endif // COMMAND_QUEUE_H
@@ -0,0 +1,141 @@
+/**
+ * @file ConsoleInput.cpp
+ * @brief Implementation of the ConsoleInput class.
+ */
+
+#include "ConsoleInput.h"
+#include <cerrno>
+#include <poll.h>
+#include <sstream>
+#include <unistd.h>
+#include "Logger.h"
+
+/// Longest the reader waits for input before checking whether it should stop.
+static const int POLL_TIMEOUT_MS = 100;
+
+/**
+ * @brief Parses one line of console input into a player command.
+ *
+ * @param line Line without its newline.
+ * @param command Receives the parsed command.
+ * @return True if the line is a valid command.
+ */
+bool parseCommand(const string& line, PlayerCommand& command) {
+    istringstream words(line);
+    string verb;
+    if (!(words >> verb)) {
+        return false;
+    }
+
+    if (verb == "place" || verb == "p") {
+        string type;
+        if (!(words >> type)) {
+            return false;
+        }
+        if (type == "basic" || type == "b" || type == "1") {
+            command.towerType = BASIC_TOWER;
+        } else if (type == "aoe" || type == "a" || type == "2") {
+            command.towerType = AOE_TOWER;
+        } else {
+            return false;
+        }
+        command.type = COMMAND_PLACE;
+    } else if (verb == "sell" || verb == "s") {
+        command.type = COMMAND_SELL;
+    } else if (verb == "upgrade" || verb == "u") {
+        command.type = COMMAND_UPGRADE;
+    } else {
+        return false;
+    }
+
+    string rest;
+    if (!(words >> command.x >> command.y) || (words >> rest)) {
+        return false;
+    }
+    command.tick = 0;
+    return true;
+}
+
+/**
+ * @brief Starts reading standard input.
+ *
+ * @param queue Queue receiving the commands.
+ */
+ConsoleInput::ConsoleInput(CommandQueue& queue)
+        : queue(queue), stopping(false) {
+    reader = thread(&ConsoleInput::readLoop, this);
+}
+
+/**
+ * @brief Stops and joins the reader thread.
+ */
+ConsoleInput::~ConsoleInput() {
+    stop();
+}
+
+/**
+ * @brief Stops the reader thread; input typed afterwards is ignored.
+ */
+void ConsoleInput::stop() {
+    stopping.store(true);
+    if (reader.joinable()) {
+        reader.join();
+    }
+}
+
+/**
+ * @brief Parses a complete line and queues the command, reporting invalid input.
+ *
+ * @param line Line without its newline.
+ */
+void ConsoleInput::handleLine(const string& line) {
+    if (line.find_first_not_of(" \t\r") == string::npos) {
+        return;
+    }
+
+    PlayerCommand command;
+    if (!parseCommand(line, command)) {
+        TD_LOG_WARN("Unknown command: %s (expected place basic|aoe X Y, sell X Y or upgrade X Y)", line.c_str());
+    } else if (!queue.push(command)) {
+        TD_LOG_WARN("Input queue full, command dropped: %s", line.c_str());
+    }
+}
+
+/**
+ * @brief Main loop of the reader thread.
+ *
+ * Reads whatever is available on standard input and splits it into lines; ends on stop(),
+ * end of input or a read error.
+ */
+void ConsoleInput::readLoop() {
+    string pending;
+    char buffer[256];
+    pollfd input = {STDIN_FILENO, POLLIN, 0};
+
+    while (!stopping.load()) {
+        int ready = poll(&input, 1, POLL_TIMEOUT_MS);
+        if (ready == 0 || (ready < 0 && errno == EINTR)) {
+            continue;
+        }
+        if (ready < 0 || (input.revents & (POLLIN | POLLHUP)) == 0) {
+            return;
+        }
+
+        ssize_t count = read(STDIN_FILENO, buffer, sizeof(buffer));
+        if (count <= 0) {
+            break;
+        }
+        pending.append(buffer, static_cast<size_t>(count));
+
+        size_t newline;
+        while ((newline = pending.find('\n')) != string::npos) {
+            handleLine(pending.substr(0, newline));
+            pending.erase(0, newline + 1);
+        }
+    }
+
+    // A last command without a trailing newline still counts at end of input
+    if (!stopping.load()) {
+        handleLine(pending);
+    }
+}
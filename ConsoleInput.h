@@ -0,0 +1,68 @@
+/**
+ * @file ConsoleInput.h
+ * @brief Declaration of the ConsoleInput class that reads player commands from the terminal.
+ */
+
+#ifndef CONSOLE_INPUT_H
+#define CONSOLE_INPUT_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include "CommandQueue.h"
+
+using namespace std;
+
+/**
+ * @brief Parses one line of console input into a player command.
+ *
+ * Accepted forms are "place TYPE X Y" (TYPE is basic, aoe, b, a, 1 or 2), "sell X Y" and
+ * "upgrade X Y"; keywords are case-sensitive and may be abbreviated to p, s and u.
+ *
+ * @param line Line without its newline.
+ * @param command Receives the parsed command; its tick is left at 0.
+ * @return True if the line is a valid command.
+ */
+bool parseCommand(const string& line, PlayerCommand& command);
+
+/**
+ * @class ConsoleInput
+ * @brief Background reader that turns lines typed on standard input into queued commands.
+ *
+ * The reader thread is the queue's only producer. It waits for input with a short poll()
+ * timeout rather than a blocking read, so stop() returns promptly even if nothing is typed,
+ * and the game loop, which only ever pops from the queue, never waits on the terminal.
+ */
+class ConsoleInput {
+private:
+    CommandQueue& queue;     ///< Destination of parsed commands
+    atomic<bool> stopping;   ///< Set by stop() to end the reader thread
+    thread reader;           ///< Thread running readLoop()
+
+    /** @brief Main loop of the reader thread. */
+    void readLoop();
+
+    /**
+     * @brief Parses a complete line and queues the command, reporting invalid input.
+     * @param line Line without its newline.
+     */
+    void handleLine(const string& line);
+
+public:
+    /**
+     * @brief Starts reading standard input.
+     * @param queue Queue receiving the commands; this reader must be its only producer.
+     */
+    explicit ConsoleInput(CommandQueue& queue);
+
+    /** @brief Stops and joins the reader thread. */
+    ~ConsoleInput();
+
+    ConsoleInput(const ConsoleInput&) = delete;
+    ConsoleInput& operator=(const ConsoleInput&) = delete;
+
+    /** @brief Stops the reader thread; input typed afterwards is ignored. */
+    void stop();
+};
+
+#endif // CONSOLE_INPUT_H
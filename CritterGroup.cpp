@@ -6,14 +6,28 @@
 #include "CritterGroup.h"
 #include <cmath>
 #include <algorithm>
+#include "Zobrist.h"
 
 /**
  * @brief Constructs a CritterGroup object associated with a given map.
  *
  * @param map Pointer to the game map for critter pathfinding.
+ * @param memory Memory resource the critter lists allocate from.
  */
-CritterGroup::CritterGroup(const Map* map)
-        : waveNum(0), map(map) {
+CritterGroup::CritterGroup(const Map* map, pmr::memory_resource* memory)
+        : waveNum(0), waveBase(5), waveGrowth(2), hitPointPercent(100), nextCritterId(1), map(map), distances(nullptr), activeCritters(memory), spawnQueue(memory), zobrist(0) {
+}
+
+/**
+ * @brief Gets the Zobrist key of an active critter.
+ *
+ * @param critter Critter to key.
+ * @return Key derived from the critter's identifier, hit points and cell.
+ */
+uint64_t CritterGroup::critterZobrist(const Critter& critter) {
+    pair<int, int> position = critter.getPosition();
+    return zobristKey(ZOBRIST_CRITTER_HP, critter.getId(), static_cast<uint32_t>(critter.getHitPoints()))
+           ^ zobristKey(ZOBRIST_CRITTER_CELL, critter.getId(), zobristCell(position.first, position.second));
 }
 
 /**
@@ -24,7 +38,7 @@ CritterGroup::CritterGroup(const Map* map)
  */
 std::tuple<int, int, int, int> CritterGroup::calculateCritterStats(int waveNum) {
     // Base stats
-    double baseHP = 100.0;
+    double baseHP = 100.0 * hitPointPercent / 100.0;
     double baseStrength = 10.0;
     double baseSpeed = 1.0;
     double baseReward = 20.0;
@@ -54,39 +68,66 @@ std::tuple<int, int, int, int> CritterGroup::calculateCritterStats(int waveNum)
 int CritterGroup::generateWave() {
     waveNum++;
 
-    int numCritters = 5 + (waveNum * 2); // Base 5 critters + 2 per wave
+    int numCritters = max(waveBase + waveNum * waveGrowth, 1);
 
     activeCritters.clear();
-    while (!spawnQueue.empty()) {
-        spawnQueue.pop();
-    }
+    spawnQueue.clear();
+    zobrist = 0;
 
     pair<int, int> entryPoint = map->getEntry();
 
     for (int i = 0; i < numCritters; i++) {
         auto [hp, strength, speed, reward] = calculateCritterStats(waveNum);
         Critter newCritter(hp, strength, speed, waveNum, reward, entryPoint, map);
-        spawnQueue.push(newCritter);
+        spawnQueue.push_back(newCritter);
     }
 
     return numCritters;
 }
 
+/**
+ * @brief Sets how many critters the following waves hold and how tough they are.
+ *
+ * Wave n holds base + n * growth critters, and at least one.
+ *
+ * @param base Constant part of the wave size.
+ * @param growth Critters added with every wave.
+ * @param hitPoints Hit points of the critters, in percent of the standard wave.
+ */
+void CritterGroup::setWaveShape(int base, int growth, int hitPoints) {
+    waveBase = base;
+    waveGrowth = growth;
+    hitPointPercent = max(hitPoints, 1);
+}
+
 /**
  * @brief Moves all active critters along their path.
  *
+ * Critters that reach the exit are compacted out in one pass, keeping the others in order,
+ * so a tick stays linear in the number of critters.
+ *
  * @param onCritterExit Callback function when a critter reaches the exit.
  */
 void CritterGroup::moveAllCritters(std::function<void(int)> onCritterExit) {
-    for (auto it = activeCritters.begin(); it != activeCritters.end();) {
-        it->move();
+    auto kept = activeCritters.begin();
+    for (auto it = activeCritters.begin(); it != activeCritters.end(); ++it) {
+        zobrist ^= critterZobrist(*it);
+        if (distances != nullptr) {
+            it->moveAlong(*distances);
+        } else {
+            it->move();
+        }
         if (it->hasReachedExit()) {
             onCritterExit(it->getStrength());
-            it = activeCritters.erase(it);
         } else {
-            ++it;
+            zobrist ^= critterZobrist(*it);
+            if (kept != it) {
+                *kept = std::move(*it);
+            }
+            ++kept;
         }
     }
+    activeCritters.erase(kept, activeCritters.end());
 }
 
 /**
@@ -100,7 +141,9 @@ bool CritterGroup::spawnNextCritter() {
     }
 
     activeCritters.push_back(spawnQueue.front());
-    spawnQueue.pop();
+    activeCritters.back().setId(nextCritterId++);
+    zobrist ^= critterZobrist(activeCritters.back());
+    spawnQueue.pop_front();
     return true;
 }
 
@@ -117,7 +160,9 @@ bool CritterGroup::processCritterHit(size_t critterIndex, int damage, std::funct
         return false;
     }
 
+    zobrist ^= critterZobrist(activeCritters[critterIndex]);
     activeCritters[critterIndex].takeDamage(damage);
+    zobrist ^= critterZobrist(activeCritters[critterIndex]);
 
     if (activeCritters[critterIndex].isDead()) {
         onCritterDeath(activeCritters[critterIndex].getReward());
@@ -127,28 +172,105 @@ bool CritterGroup::processCritterHit(size_t critterIndex, int damage, std::funct
     return false;
 }
 
+/**
+ * @brief Resolves a tick's damage buffer against the active critters.
+ *
+ * Damage is applied slot by slot in ascending order, so the result is the same whatever
+ * order the towers recorded their hits in.
+ *
+ * @param hits Damage buffer filled by the towers during the attack phase.
+ * @param onCritterDeath Callback function for each critter killed.
+ * @return Number of critters killed.
+ */
+int CritterGroup::applyDamage(const DamageBuffer& hits, std::function<void(int)> onCritterDeath) {
+    size_t slots = min(hits.size(), activeCritters.size());
+    bool anyDeaths = false;
+
+    for (size_t i = 0; i < slots; i++) {
+        int damage = hits.getDamage(i);
+        if (damage == 0) {
+            continue;
+        }
+        zobrist ^= critterZobrist(activeCritters[i]);
+        activeCritters[i].takeDamage(damage);
+        zobrist ^= critterZobrist(activeCritters[i]);
+        anyDeaths = anyDeaths || activeCritters[i].isDead();
+    }
+
+    if (!anyDeaths) {
+        return 0;
+    }
+
+    size_t before = activeCritters.size();
+    removeDeadCritters(onCritterDeath);
+    return static_cast<int>(before - activeCritters.size());
+}
+
 /**
  * @brief Removes dead critters from the active list.
  *
  * @param onCritterDeath Callback function for each removed critter.
  */
 void CritterGroup::removeDeadCritters(std::function<void(int)> onCritterDeath) {
-    auto it = activeCritters.begin();
-    while (it != activeCritters.end()) {
+    auto kept = activeCritters.begin();
+    for (auto it = activeCritters.begin(); it != activeCritters.end(); ++it) {
         if (it->isDead()) {
             onCritterDeath(it->getReward());
-            it = activeCritters.erase(it);
+            zobrist ^= critterZobrist(*it);
         } else {
-            ++it;
+            if (kept != it) {
+                *kept = std::move(*it);
+            }
+            ++kept;
         }
     }
+    activeCritters.erase(kept, activeCritters.end());
+}
+
+/**
+ * @brief Computes the Zobrist hash of the active critters from scratch.
+ *
+ * @return Hash of the active critters.
+ */
+uint64_t CritterGroup::computeZobrist() const {
+    uint64_t hash = 0;
+    for (const Critter& critter : activeCritters) {
+        hash ^= critterZobrist(critter);
+    }
+    return hash;
+}
+
+/**
+ * @brief Finds the active critter with the given identifier.
+ *
+ * @param critterId Identifier returned by Critter::getId().
+ * @return Index of the critter in the active list, or -1 if it is no longer active.
+ */
+int CritterGroup::findCritter(uint32_t critterId) const {
+    auto it = lower_bound(activeCritters.begin(), activeCritters.end(), critterId,
+                          [](const Critter& critter, uint32_t id) { return critter.getId() < id; });
+    if (it == activeCritters.end() || it->getId() != critterId) {
+        return -1;
+    }
+    return static_cast<int>(it - activeCritters.begin());
 }
 
 /**
- * @brief Gets the list of active critters.
+ * @brief Replaces the whole state of the group, e.g. when loading a snapshot.
  *
- * @return A reference to the vector of active critters.
+ * @param wave Wave number to resume at.
+ * @param nextId Identifier given to the next spawned critter.
+ * @param active Active critters, in increasing identifier order.
+ * @param spawns Critters still waiting to spawn, in spawn order.
  */
-vector<Critter>& CritterGroup::getActiveCritters() {
-    return activeCritters;
+void CritterGroup::restoreState(int wave, uint32_t nextId, vector<Critter> active, deque<Critter> spawns) {
+    waveNum = wave;
+    nextCritterId = nextId;
+    activeCritters.assign(active.begin(), active.end());
+    spawnQueue.assign(spawns.begin(), spawns.end());
+
+    zobrist = 0;
+    for (const Critter& critter : activeCritters) {
+        zobrist ^= critterZobrist(critter);
+    }
 }
@@ -9,11 +9,14 @@
 #include <vector>
 #include <iostream>
 #include <utility>
-#include <queue>
+#include <deque>
+#include <memory_resource>
 #include <cmath>
 #include <functional>
 #include "critter.h"
 #include "mapgen.h"
+#include "DamageBuffer.h"
+#include "DistanceField.h"
 
 using namespace std;
 
@@ -27,9 +30,15 @@ using namespace std;
 class CritterGroup {
 private:
     int waveNum;                  ///< Current wave number
+    int waveBase;                 ///< Wave n holds waveBase + n * waveGrowth critters
+    int waveGrowth;               ///< Critters added with every wave
+    int hitPointPercent;          ///< Critter hit points, in percent of the standard wave
+    uint32_t nextCritterId;         ///< Identifier given to the next spawned critter
     const Map* map;                ///< Pointer to the game map for pathfinding
-    vector<Critter> activeCritters; ///< List of active critters on the map
-    queue<Critter> spawnQueue;      ///< Queue of critters waiting to spawn
+    const DistanceField* distances; ///< Route of open-field maps, or nullptr to follow the PATH cells
+    pmr::vector<Critter> activeCritters; ///< List of active critters on the map
+    pmr::deque<Critter> spawnQueue;      ///< Queue of critters waiting to spawn
+    uint64_t zobrist;               ///< XOR of the Zobrist keys of the active critters
 
     /**
      * @brief Calculates critter stats based on the wave number.
@@ -38,12 +47,34 @@ private:
      */
     tuple<int, int, int, int> calculateCritterStats(int waveNum);
 
+    /**
+     * @brief Gets the Zobrist key of an active critter: its identifier, hit points and cell.
+     * @param critter Critter to key.
+     * @return Key to XOR into the group's hash.
+     */
+    static uint64_t critterZobrist(const Critter& critter);
+
 public:
     /**
      * @brief Constructs a CritterGroup object.
      * @param map Pointer to the game map.
+     * @param memory Memory resource the critter lists allocate from.
+     */
+    explicit CritterGroup(const Map* map, pmr::memory_resource* memory = pmr::get_default_resource());
+
+    /**
+     * @brief Sets how many critters the following waves hold and how tough they are.
+     * @param base Constant part of the wave size.
+     * @param growth Critters added with every wave.
+     * @param hitPoints Hit points of the critters, in percent of the standard wave.
+     */
+    void setWaveShape(int base, int growth, int hitPoints = 100);
+
+    /**
+     * @brief Makes the critters follow a distance field instead of the PATH cells.
+     * @param field Distances to the exit, kept current by the owner; nullptr to follow the PATH cells.
      */
-    explicit CritterGroup(const Map* map);
+    void setDistanceField(const DistanceField* field) { distances = field; }
 
     /**
      * @brief Generates a new wave of critters.
@@ -72,6 +103,16 @@ public:
      */
     bool processCritterHit(size_t critterIndex, int damage, function<void(int)> onCritterDeath);
 
+    /**
+     * @brief Resolves a tick's damage buffer against the active critters.
+     *
+     * Applies the summed damage of every slot, then removes the critters that died.
+     * @param hits Damage buffer filled by the towers during the attack phase.
+     * @param onCritterDeath Callback function triggered with the reward of each critter killed.
+     * @return Number of critters killed.
+     */
+    int applyDamage(const DamageBuffer& hits, function<void(int)> onCritterDeath);
+
     /**
      * @brief Removes dead critters from the active list.
      * @param onCritterDeath Callback function triggered for each removed critter.
@@ -86,9 +127,27 @@ public:
 
     /**
      * @brief Gets the list of active critters.
-     * @return A reference to the vector of active critters.
+     *
+     * Read-only: critters only change through the group, which keeps the hash current.
+     * @return A read-only reference to the vector of active critters.
+     */
+    const pmr::vector<Critter>& getActiveCritters() const { return activeCritters; }
+
+    /**
+     * @brief Gets a read-only view of the active critters.
+     * @return View over the active critters; invalidated when critters spawn or are removed.
+     */
+    ConstCritterSpan view() const { return ConstCritterSpan(activeCritters); }
+
+    /**
+     * @brief Finds the active critter with the given identifier.
+     *
+     * Critters receive increasing identifiers as they spawn and removals keep the active list
+     * in order, so the lookup is a binary search.
+     * @param critterId Identifier returned by Critter::getId().
+     * @return Index of the critter in the active list, or -1 if it died or left the map.
      */
-    vector<Critter>& getActiveCritters();
+    int findCritter(uint32_t critterId) const;
 
     /**
      * @brief Gets the number of critters remaining to spawn.
@@ -101,6 +160,45 @@ public:
      * @return True if the wave is complete, false otherwise.
      */
     bool isWaveComplete() const { return spawnQueue.empty() && activeCritters.empty(); }
+
+    /**
+     * @brief Gets the critters waiting to spawn, front first.
+     * @return A read-only reference to the spawn queue.
+     */
+    const pmr::deque<Critter>& getSpawnQueue() const { return spawnQueue; }
+
+    /**
+     * @brief Gets the identifier that the next spawned critter will receive.
+     * @return The next critter identifier.
+     */
+    uint32_t getNextCritterId() const { return nextCritterId; }
+
+    /**
+     * @brief Gets the Zobrist hash of the active critters.
+     *
+     * Updated in O(1) per spawn, hit, move and removal. The group hands out its critters
+     * read-only, so every change goes through it and the hash is always current.
+     * @return Current hash; 0 when no critter is active.
+     */
+    uint64_t getZobrist() const { return zobrist; }
+
+    /**
+     * @brief Computes the Zobrist hash of the active critters from scratch.
+     * @return Hash of the active critters; equals getZobrist() unless an update was missed.
+     */
+    uint64_t computeZobrist() const;
+
+    /** @brief Gets the map the critters walk on. */
+    const Map* getMap() const { return map; }
+
+    /**
+     * @brief Replaces the whole state of the group, e.g. when loading a snapshot.
+     * @param wave Wave number to resume at.
+     * @param nextId Identifier given to the next spawned critter.
+     * @param active Active critters, in increasing identifier order.
+     * @param spawns Critters still waiting to spawn, in spawn order.
+     */
+    void restoreState(int wave, uint32_t nextId, vector<Critter> active, deque<Critter> spawns);
 };
 
 #endif // CRITTER_GROUP_H
\ No newline at end of file
@@ -0,0 +1,136 @@
+/**
+ * @file CritterIndex.cpp
+ * @brief Implementation of the CritterIndex class.
+ */
+
+#include "CritterIndex.h"
+#include <algorithm>
+
+/// Side of the smallest bucket, as a power of two (8 cells).
+static const int MIN_BUCKET_SHIFT = 3;
+
+/// Largest bucket side, as a power of two; keeps the shift meaningful on any map.
+static const int MAX_BUCKET_SHIFT = 15;
+
+/**
+ * @brief Constructs an empty index.
+ */
+CritterIndex::CritterIndex()
+        : width(0), height(0), shift(MIN_BUCKET_SHIFT), bucketsX(0), bucketsY(0) {
+}
+
+/**
+ * @brief Rebuilds the index for a tick.
+ *
+ * Bucket sizes double until there are no more buckets than critters (and at least a few),
+ * which bounds the cost of the build by the number of critters on any map size.
+ *
+ * @param critters Active critters, in slot order.
+ * @param mapWidth Width of the map in cells.
+ * @param mapHeight Height of the map in cells.
+ */
+void CritterIndex::build(ConstCritterSpan critters, int mapWidth, int mapHeight) {
+    width = max(mapWidth, 1);
+    height = max(mapHeight, 1);
+
+    size_t targetBuckets = max(critters.size(), size_t(64));
+    shift = MIN_BUCKET_SHIFT;
+    while (shift < MAX_BUCKET_SHIFT
+           && static_cast<size_t>((width >> shift) + 1) * static_cast<size_t>((height >> shift) + 1) > targetBuckets) {
+        shift++;
+    }
+    bucketsX = ((width - 1) >> shift) + 1;
+    bucketsY = ((height - 1) >> shift) + 1;
+
+    // Counting sort by bucket: count, turn counts into offsets, then place in slot order
+    bucketStart.assign(static_cast<size_t>(bucketsX) * bucketsY + 1, 0);
+    auto bucketOf = [this](int x, int y) {
+        int bx = min(max(x, 0), width - 1) >> shift;
+        int by = min(max(y, 0), height - 1) >> shift;
+        return static_cast<size_t>(by) * bucketsX + bx;
+    };
+
+    size_t live = 0;
+    for (const Critter& critter : critters) {
+        if (!critter.isDead()) {
+            pair<int, int> position = critter.getPosition();
+            bucketStart[bucketOf(position.first, position.second) + 1]++;
+            live++;
+        }
+    }
+    for (size_t i = 1; i < bucketStart.size(); i++) {
+        bucketStart[i] += bucketStart[i - 1];
+    }
+
+    // Each offset is advanced past its bucket while filling, then the offsets are shifted back
+    entries.resize(live);
+    for (size_t slot = 0; slot < critters.size(); slot++) {
+        const Critter& critter = critters[slot];
+        if (!critter.isDead()) {
+            pair<int, int> position = critter.getPosition();
+            size_t bucket = bucketOf(position.first, position.second);
+            entries[bucketStart[bucket]++] = Entry{static_cast<uint32_t>(slot), position.first, position.second};
+        }
+    }
+    for (size_t i = bucketStart.size() - 1; i > 0; i--) {
+        bucketStart[i] = bucketStart[i - 1];
+    }
+    bucketStart[0] = 0;
+}
+
+/**
+ * @brief Clamps a cell coordinate range to the buckets that contain it.
+ *
+ * @param low First cell.
+ * @param high Last cell.
+ * @param cells Map size along the axis.
+ * @param buckets Bucket count along the axis.
+ * @param first Receives the first bucket.
+ * @param last Receives the last bucket.
+ * @return False if the range misses the map or the index is empty.
+ */
+bool CritterIndex::bucketSpan(int low, int high, int cells, int buckets, int& first, int& last) const {
+    if (buckets == 0 || high < 0 || low >= cells) {
+        return false;
+    }
+    first = max(low, 0) >> shift;
+    last = min(min(high, cells - 1) >> shift, buckets - 1);
+    return true;
+}
+
+/**
+ * @brief Finds the live critter with the lowest slot within Manhattan range of a cell.
+ *
+ * Entries of a bucket are in slot order, so each bucket is scanned only up to its first
+ * critter in range or to the best slot found so far.
+ *
+ * @param x X-coordinate of the cell.
+ * @param y Y-coordinate of the cell.
+ * @param range Manhattan range.
+ * @return Slot of that critter, or -1 if none is in range.
+ */
+int CritterIndex::findFirst(int x, int y, int range) const {
+    int bx0, bx1, by0, by1;
+    if (!bucketSpan(x - range, x + range, width, bucketsX, bx0, bx1)
+        || !bucketSpan(y - range, y + range, height, bucketsY, by0, by1)) {
+        return -1;
+    }
+
+    uint32_t best = UINT32_MAX;
+    for (int by = by0; by <= by1; by++) {
+        for (int bx = bx0; bx <= bx1; bx++) {
+            size_t bucket = static_cast<size_t>(by) * bucketsX + bx;
+            for (uint32_t i = bucketStart[bucket]; i < bucketStart[bucket + 1]; i++) {
+                const Entry& entry = entries[i];
+                if (entry.slot >= best) {
+                    break;
+                }
+                if (abs(entry.x - x) + abs(entry.y - y) <= range) {
+                    best = entry.slot;
+                    break;
+                }
+            }
+        }
+    }
+    return best == UINT32_MAX ? -1 : static_cast<int>(best);
+}
@@ -0,0 +1,114 @@
+/**
+ * @file CritterIndex.h
+ * @brief Declaration of the CritterIndex class, a per-tick spatial index of the active critters.
+ */
+
+#ifndef CRITTER_INDEX_H
+#define CRITTER_INDEX_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "critter.h"
+
+using namespace std;
+
+/**
+ * @class CritterIndex
+ * @brief Uniform grid of buckets over the map, each listing the critters standing in it.
+ *
+ * Built once per tick from the frozen critter view, so that a tower only looks at the
+ * critters in the buckets its range diamond overlaps instead of at every critter on the map.
+ * Buckets are square blocks of cells whose side is picked so that there are about as many
+ * buckets as critters. Entries are filled with a counting sort in critter order, so inside
+ * a bucket they are in increasing slot order, which lets towers reproduce the exact targets
+ * of a linear scan over the view. Dead critters are left out.
+ */
+class CritterIndex {
+public:
+    /**
+     * @struct Entry
+     * @brief A live critter: its slot in the view and its cell.
+     */
+    struct Entry {
+        uint32_t slot;  ///< Index of the critter in the active critter list
+        int x, y;       ///< Cell of the critter
+    };
+
+private:
+    int width, height;              ///< Map size in cells
+    int shift;                      ///< Buckets are (1 << shift) cells on a side
+    int bucketsX, bucketsY;         ///< Number of buckets along each axis
+    vector<uint32_t> bucketStart;   ///< Offset of each bucket's entries; one extra end offset
+    vector<Entry> entries;          ///< Live critters grouped by bucket
+
+    /**
+     * @brief Clamps a cell coordinate range to the buckets that contain it.
+     * @param low First cell, may lie outside the map.
+     * @param high Last cell, may lie outside the map.
+     * @param cells Map size along the axis.
+     * @param buckets Bucket count along the axis.
+     * @param first Receives the first bucket.
+     * @param last Receives the last bucket.
+     * @return False if the range misses the map.
+     */
+    bool bucketSpan(int low, int high, int cells, int buckets, int& first, int& last) const;
+
+public:
+    /** @brief Constructs an empty index. */
+    CritterIndex();
+
+    /**
+     * @brief Rebuilds the index for a tick; buffers are reused between builds.
+     * @param critters Active critters, in slot order.
+     * @param mapWidth Width of the map in cells.
+     * @param mapHeight Height of the map in cells.
+     */
+    void build(ConstCritterSpan critters, int mapWidth, int mapHeight);
+
+    /**
+     * @brief Finds the live critter with the lowest slot within Manhattan range of a cell.
+     * @param x X-coordinate of the cell.
+     * @param y Y-coordinate of the cell.
+     * @param range Manhattan range.
+     * @return Slot of that critter, or -1 if none is in range.
+     */
+    int findFirst(int x, int y, int range) const;
+
+    /**
+     * @brief Calls visit(slot) for every live critter within Manhattan range of a cell.
+     *
+     * Critters are visited bucket by bucket, not in slot order.
+     * @param x X-coordinate of the cell.
+     * @param y Y-coordinate of the cell.
+     * @param range Manhattan range.
+     * @param visit Function called with the slot of each critter in range.
+     */
+    template <class Visitor>
+    void forEachInRange(int x, int y, int range, Visitor&& visit) const {
+        int bx0, bx1, by0, by1;
+        if (!bucketSpan(x - range, x + range, width, bucketsX, bx0, bx1)
+            || !bucketSpan(y - range, y + range, height, bucketsY, by0, by1)) {
+            return;
+        }
+        for (int by = by0; by <= by1; by++) {
+            for (int bx = bx0; bx <= bx1; bx++) {
+                size_t bucket = static_cast<size_t>(by) * bucketsX + bx;
+                for (uint32_t i = bucketStart[bucket]; i < bucketStart[bucket + 1]; i++) {
+                    const Entry& entry = entries[i];
+                    if (abs(entry.x - x) + abs(entry.y - y) <= range) {
+                        visit(entry.slot);
+                    }
+                }
+            }
+        }
+    }
+
+    /** @brief Gets the number of live critters in the index. */
+    size_t size() const { return entries.size(); }
+
+    /** @brief Gets the side of a bucket in cells. */
+    int getBucketSize() const { return 1 << shift; }
+};
+
+#endif // CRITTER_INDEX_H
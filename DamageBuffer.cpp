@@ -0,0 +1,51 @@
+/**
+ * @file DamageBuffer.cpp
+ * @brief Implementation of the DamageBuffer class.
+ */
+
+#include "DamageBuffer.h"
+
+/**
+ * @brief Constructs an empty buffer.
+ *
+ * @param memory Memory resource the buffer allocates from.
+ */
+DamageBuffer::DamageBuffer(pmr::memory_resource* memory)
+        : damage(memory), touched(memory), hitCount(0), shots(memory) {
+}
+
+/**
+ * @brief Clears all recorded hits and sizes the buffer for a new tick.
+ *
+ * Only the slots touched during the previous tick are cleared, so resetting a mostly idle
+ * buffer is cheap even with many critters on the map.
+ *
+ * @param critterCount Number of critter slots that can be hit this tick.
+ */
+void DamageBuffer::reset(size_t critterCount) {
+    for (uint32_t slot : touched) {
+        if (slot < damage.size()) {
+            damage[slot] = 0;
+        }
+    }
+    touched.clear();
+    shots.clear();
+    hitCount = 0;
+    damage.resize(critterCount, 0);
+}
+
+/**
+ * @brief Adds every hit and shot recorded in another buffer of the same size to this one.
+ *
+ * @param other Buffer to merge in.
+ */
+void DamageBuffer::merge(const DamageBuffer& other) {
+    for (uint32_t slot : other.touched) {
+        if (damage[slot] == 0) {
+            touched.push_back(slot);
+        }
+        damage[slot] += other.damage[slot];
+    }
+    hitCount += other.hitCount;
+    shots.insert(shots.end(), other.shots.begin(), other.shots.end());
+}
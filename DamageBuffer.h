@@ -0,0 +1,116 @@
+/**
+ * @file DamageBuffer.h
+ * @brief Declaration of the DamageBuffer class used to defer tower damage until the end of the attack phase.
+ */
+
+#ifndef DAMAGE_BUFFER_H
+#define DAMAGE_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @class DamageBuffer
+ * @brief Per-tick accumulator of tower hits, indexed by critter slot.
+ *
+ * During the attack phase towers only read critters and record their hits here; nothing is
+ * applied until CritterGroup::applyDamage resolves the buffer. Because damage is summed per
+ * slot, the outcome of a tick no longer depends on the order in which towers attack, and the
+ * attack phase can be split across threads with one buffer each.
+ */
+class DamageBuffer {
+public:
+    /**
+     * @struct Shot
+     * @brief A projectile fired this tick that still has to travel to its target.
+     */
+    struct Shot {
+        uint32_t slot;   ///< Critter slot the shot was aimed at
+        int damage;      ///< Damage dealt when the shot lands
+        int originX;     ///< X-coordinate of the firing tower
+        int originY;     ///< Y-coordinate of the firing tower
+        int speed;       ///< Travel speed in cells per tick
+    };
+
+private:
+    pmr::vector<int> damage;       ///< Summed damage for each critter slot
+    pmr::vector<uint32_t> touched; ///< Slots that received damage since the last reset
+    size_t hitCount;               ///< Number of individual hits recorded since the last reset
+    pmr::vector<Shot> shots;       ///< Projectiles fired since the last reset
+
+public:
+    /**
+     * @brief Constructs an empty buffer.
+     * @param memory Memory resource the buffer allocates from.
+     */
+    explicit DamageBuffer(pmr::memory_resource* memory = pmr::get_default_resource());
+
+    /**
+     * @brief Clears all recorded hits and sizes the buffer for a new tick.
+     * @param critterCount Number of critter slots that can be hit this tick.
+     */
+    void reset(size_t critterCount);
+
+    /**
+     * @brief Records a hit on a critter slot.
+     * @param slot Index of the critter in the active critter list.
+     * @param amount Damage dealt by the hit.
+     */
+    void addHit(size_t slot, int amount) {
+        if (damage[slot] == 0 && amount != 0) {
+            touched.push_back(static_cast<uint32_t>(slot));
+        }
+        damage[slot] += amount;
+        hitCount++;
+    }
+
+    /**
+     * @brief Records a projectile fired at a critter slot.
+     *
+     * The damage is not part of this tick's hits; the ProjectilePool applies it when the shot lands.
+     * A speed of 0 or less means the hit is instant and is recorded with addHit instead.
+     * @param slot Index of the critter in the active critter list.
+     * @param amount Damage dealt when the shot lands.
+     * @param originX X-coordinate of the firing tower.
+     * @param originY Y-coordinate of the firing tower.
+     * @param speed Travel speed in cells per tick.
+     */
+    void addShot(size_t slot, int amount, int originX, int originY, int speed) {
+        if (speed <= 0) {
+            addHit(slot, amount);
+            return;
+        }
+        shots.push_back(Shot{static_cast<uint32_t>(slot), amount, originX, originY, speed});
+    }
+
+    /**
+     * @brief Adds every hit recorded in another buffer of the same size to this one.
+     * @param other Buffer to merge in.
+     */
+    void merge(const DamageBuffer& other);
+
+    /**
+     * @brief Gets the total damage recorded for a critter slot.
+     * @param slot Index of the critter in the active critter list.
+     * @return Summed damage for that slot.
+     */
+    int getDamage(size_t slot) const { return damage[slot]; }
+
+    /** @brief Gets the number of critter slots covered by the buffer. */
+    size_t size() const { return damage.size(); }
+
+    /** @brief Gets the number of individual hits recorded this tick. */
+    size_t getHitCount() const { return hitCount; }
+
+    /** @brief Gets the projectiles fired this tick, in the order they were fired. */
+    const pmr::vector<Shot>& getShots() const { return shots; }
+
+    /** @brief Gets the slots that received damage this tick, in the order they were first hit. */
+    const pmr::vector<uint32_t>& getTouchedSlots() const { return touched; }
+};
+
+#endif // DAMAGE_BUFFER_H
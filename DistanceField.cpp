@@ -0,0 +1,214 @@
+/**
+ * @file DistanceField.cpp
+ * @brief Implementation of the DistanceField class.
+ */
+
+#include "DistanceField.h"
+#include <algorithm>
+
+/// Neighbour offsets in the order critters try them: right, down, up, left.
+static const int STEP_X[4] = {1, 0, 0, -1};
+static const int STEP_Y[4] = {0, 1, -1, 0};
+
+/**
+ * @brief Constructs an empty field.
+ */
+DistanceField::DistanceField()
+        : width(0), height(0), goal(0), lowestKey(UNREACHABLE), highestKey(0), expanded(0) {
+}
+
+/**
+ * @brief Computes the field from scratch with a breadth-first search from the exit.
+ *
+ * Every cell ends up consistent (distance equals lookahead), so the queue starts empty.
+ *
+ * @param map Map whose walkable cells critters may enter.
+ */
+void DistanceField::build(const Map& map) {
+    width = map.getWidth();
+    height = map.getHeight();
+    size_t cells = static_cast<size_t>(width) * height;
+    goal = static_cast<uint32_t>(map.getExit().second * width + map.getExit().first);
+
+    blocked.assign(cells, 0);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            blocked[static_cast<size_t>(y) * width + x] = map.isWalkable(x, y) ? 0 : 1;
+        }
+    }
+    distance.assign(cells, UNREACHABLE);
+    queuedKey.assign(cells, UNREACHABLE);
+    buckets.clear();
+    lowestKey = UNREACHABLE;
+    highestKey = 0;
+
+    vector<uint32_t> frontier;
+    if (!blocked[goal]) {
+        distance[goal] = 0;
+        frontier.push_back(goal);
+    }
+    for (size_t head = 0; head < frontier.size(); head++) {
+        uint32_t cell = frontier[head];
+        int x = static_cast<int>(cell % width), y = static_cast<int>(cell / width);
+        for (int i = 0; i < 4; i++) {
+            int nx = x + STEP_X[i], ny = y + STEP_Y[i];
+            if (nx < 0 || nx >= width || ny < 0 || ny >= height) {
+                continue;
+            }
+            uint32_t neighbour = static_cast<uint32_t>(ny * width + nx);
+            if (!blocked[neighbour] && distance[neighbour] == UNREACHABLE) {
+                distance[neighbour] = distance[cell] + 1;
+                frontier.push_back(neighbour);
+            }
+        }
+    }
+    lookahead = distance;
+    expanded = frontier.size();
+}
+
+/**
+ * @brief Recomputes a cell's lookahead and queues or dequeues it.
+ *
+ * A cell is queued with key min(distance, lookahead) while the two differ. Entries are never
+ * removed from their bucket; a changed queuedKey marks them stale instead.
+ *
+ * @param cell Cell index.
+ */
+void DistanceField::updateCell(uint32_t cell) {
+    if (blocked[cell]) {
+        lookahead[cell] = UNREACHABLE;
+    } else if (cell == goal) {
+        lookahead[cell] = 0;
+    } else {
+        int x = static_cast<int>(cell % width), y = static_cast<int>(cell / width);
+        uint32_t best = UNREACHABLE;
+        for (int i = 0; i < 4; i++) {
+            int nx = x + STEP_X[i], ny = y + STEP_Y[i];
+            if (nx >= 0 && nx < width && ny >= 0 && ny < height) {
+                best = min(best, distance[static_cast<size_t>(ny) * width + nx]);
+            }
+        }
+        lookahead[cell] = best == UNREACHABLE ? UNREACHABLE : best + 1;
+    }
+
+    if (distance[cell] == lookahead[cell]) {
+        queuedKey[cell] = UNREACHABLE;
+        return;
+    }
+    uint32_t key = min(distance[cell], lookahead[cell]);
+    if (queuedKey[cell] == key) {
+        return;
+    }
+    queuedKey[cell] = key;
+    if (key >= buckets.size()) {
+        buckets.resize(static_cast<size_t>(key) + 1);
+    }
+    buckets[key].push_back(cell);
+    lowestKey = min(lowestKey, key);
+    highestKey = max(highestKey, key);
+}
+
+/**
+ * @brief Expands queued cells, lowest key first, until every cell is consistent.
+ *
+ * An overconsistent cell (distance > lookahead) got closer to the exit: its distance drops to
+ * the lookahead and its neighbours are updated. An underconsistent cell got farther: its
+ * distance is reset to unreachable and it is updated along with its neighbours, which
+ * re-queues it at its new distance if it can still reach the exit. Expanded keys never
+ * decrease, so one upward sweep over the buckets finishes the repair.
+ */
+void DistanceField::repair() {
+    expanded = 0;
+    while (lowestKey <= highestKey && lowestKey < buckets.size()) {
+        vector<uint32_t>& bucket = buckets[lowestKey];
+        if (bucket.empty()) {
+            lowestKey++;
+            continue;
+        }
+        uint32_t cell = bucket.back();
+        bucket.pop_back();
+        if (queuedKey[cell] != lowestKey) {
+            continue;  // Stale: the cell was re-queued or became consistent since
+        }
+        queuedKey[cell] = UNREACHABLE;
+        expanded++;
+
+        if (distance[cell] > lookahead[cell]) {
+            distance[cell] = lookahead[cell];
+        } else {
+            distance[cell] = UNREACHABLE;
+            updateCell(cell);
+        }
+        int x = static_cast<int>(cell % width), y = static_cast<int>(cell / width);
+        for (int i = 0; i < 4; i++) {
+            int nx = x + STEP_X[i], ny = y + STEP_Y[i];
+            if (nx >= 0 && nx < width && ny >= 0 && ny < height) {
+                updateCell(static_cast<uint32_t>(ny * width + nx));
+            }
+        }
+    }
+    lowestKey = UNREACHABLE;
+    highestKey = 0;
+}
+
+/**
+ * @brief Opens or closes a cell and repairs the distances that depend on it.
+ *
+ * @param x X-coordinate of the cell.
+ * @param y Y-coordinate of the cell.
+ * @param closed True if critters can no longer enter the cell.
+ */
+void DistanceField::setBlocked(int x, int y, bool closed) {
+    if (x < 0 || x >= width || y < 0 || y >= height) {
+        return;
+    }
+    uint32_t cell = static_cast<uint32_t>(y * width + x);
+    if ((blocked[cell] != 0) == closed) {
+        return;
+    }
+    blocked[cell] = closed ? 1 : 0;
+    updateCell(cell);
+    repair();
+}
+
+/**
+ * @brief Gets the number of steps from a cell to the exit.
+ *
+ * @param x X-coordinate of the cell.
+ * @param y Y-coordinate of the cell.
+ * @return Steps to the exit, or -1 if the cell is closed, cut off or off the map.
+ */
+int DistanceField::getDistance(int x, int y) const {
+    if (x < 0 || x >= width || y < 0 || y >= height) {
+        return -1;
+    }
+    uint32_t steps = distance[static_cast<size_t>(y) * width + x];
+    return steps == UNREACHABLE ? -1 : static_cast<int>(steps);
+}
+
+/**
+ * @brief Picks the step a critter on a cell takes towards the exit.
+ *
+ * A critter on a closed or cut-off cell steps to any neighbour that reaches the exit.
+ *
+ * @param x X-coordinate of the critter.
+ * @param y Y-coordinate of the critter.
+ * @param next Receives the neighbour to step to.
+ * @return False if no neighbour is closer to the exit.
+ */
+bool DistanceField::nextStep(int x, int y, pair<int, int>& next) const {
+    if (x < 0 || x >= width || y < 0 || y >= height) {
+        return false;
+    }
+    uint32_t best = distance[static_cast<size_t>(y) * width + x];
+    bool found = false;
+    for (int i = 0; i < 4; i++) {
+        int nx = x + STEP_X[i], ny = y + STEP_Y[i];
+        if (nx >= 0 && nx < width && ny >= 0 && ny < height && distance[static_cast<size_t>(ny) * width + nx] < best) {
+            best = distance[static_cast<size_t>(ny) * width + nx];
+            next = {nx, ny};
+            found = true;
+        }
+    }
+    return found;
+}
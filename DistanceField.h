@@ -0,0 +1,97 @@
+/**
+ * @file DistanceField.h
+ * @brief Declaration of the DistanceField class, walking distances to the exit kept current as cells open and close.
+ */
+
+#ifndef DISTANCE_FIELD_H
+#define DISTANCE_FIELD_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "mapgen.h"
+
+using namespace std;
+
+/**
+ * @class DistanceField
+ * @brief Number of steps from every cell to the exit, for critters that walk the open field.
+ *
+ * Critters step to the neighbour with the smallest distance, so the field is their route.
+ * When a tower closes a cell or a sale opens one, the field is repaired with the LPA* update
+ * that D* Lite is built on: every cell keeps its distance g and a one-step lookahead
+ * rhs = 1 + min(g of its neighbours), and only cells where the two disagree are queued and
+ * fixed, lowest key first. The search runs backwards from the exit, like D* Lite's, but with
+ * a zero heuristic and until the queue is empty, because every critter is a start; a repair
+ * therefore touches only the cells whose distance actually changed and their neighbours.
+ * Distances are integers, so the priority queue is a bucket queue.
+ */
+class DistanceField {
+public:
+    /// Distance of cells that cannot reach the exit.
+    static constexpr uint32_t UNREACHABLE = UINT32_MAX;
+
+private:
+    int width, height;                ///< Map size in cells
+    uint32_t goal;                    ///< Cell index of the exit
+    vector<uint32_t> distance;        ///< g: steps to the exit as of the last repair
+    vector<uint32_t> lookahead;       ///< rhs: 0 at the exit, else 1 + the smallest neighbour distance
+    vector<uint8_t> blocked;          ///< 1 for cells critters cannot enter
+    vector<uint32_t> queuedKey;       ///< Key a cell is queued with, or UNREACHABLE; older bucket entries are stale
+    vector<vector<uint32_t>> buckets; ///< Queued cells by key
+    uint32_t lowestKey;               ///< No bucket below this one holds a live entry
+    uint32_t highestKey;              ///< No bucket above this one holds a live entry
+    size_t expanded;                  ///< Cells expanded by the last repair
+
+    /**
+     * @brief Recomputes a cell's lookahead and queues or dequeues it.
+     * @param cell Cell index.
+     */
+    void updateCell(uint32_t cell);
+
+    /** @brief Expands queued cells, lowest key first, until every cell is consistent. */
+    void repair();
+
+public:
+    /** @brief Constructs an empty field; build() must be called before use. */
+    DistanceField();
+
+    /**
+     * @brief Computes the field from scratch with a breadth-first search from the exit.
+     * @param map Map whose walkable cells critters may enter.
+     */
+    void build(const Map& map);
+
+    /**
+     * @brief Opens or closes a cell and repairs the distances that depend on it.
+     * @param x X-coordinate of the cell.
+     * @param y Y-coordinate of the cell.
+     * @param closed True if critters can no longer enter the cell.
+     */
+    void setBlocked(int x, int y, bool closed);
+
+    /**
+     * @brief Gets the number of steps from a cell to the exit.
+     * @param x X-coordinate of the cell.
+     * @param y Y-coordinate of the cell.
+     * @return Steps to the exit, or -1 if the cell is closed, cut off or off the map.
+     */
+    int getDistance(int x, int y) const;
+
+    /**
+     * @brief Picks the step a critter on a cell takes towards the exit.
+     *
+     * Neighbours are tried right, down, up, left, and the first one with the smallest
+     * distance wins, so every run moves critters the same way.
+     * @param x X-coordinate of the critter.
+     * @param y Y-coordinate of the critter.
+     * @param next Receives the neighbour to step to.
+     * @return False if no neighbour is closer to the exit.
+     */
+    bool nextStep(int x, int y, pair<int, int>& next) const;
+
+    /** @brief Gets the number of cells expanded by the last repair, a measure of its cost. */
+    size_t getExpandedCount() const { return expanded; }
+};
+
+#endif // DISTANCE_FIELD_H
@@ -0,0 +1,87 @@
+/**
+ * @file FixedTimestep.cpp
+ * @brief Implementation of the FixedTimestep class.
+ */
+
+#include "FixedTimestep.h"
+#include <chrono>
+
+/**
+ * @brief Constructs a timestep.
+ *
+ * @param ticksPerSecond Tick rate at 1x speed.
+ * @param maxTicksPerFrame Maximum ticks run in one frame before the backlog is dropped.
+ * @param uncappedBudget Seconds of each frame spent simulating in uncapped mode.
+ */
+FixedTimestep::FixedTimestep(double ticksPerSecond, int maxTicksPerFrame, double uncappedBudget)
+        : tickSeconds(1.0 / ticksPerSecond), accumulator(0.0), maxTicksPerFrame(maxTicksPerFrame),
+          uncappedBudget(uncappedBudget), speed(SPEED_1X), droppedTicks(0) {
+}
+
+/**
+ * @brief Gets the multiplier applied to wall time.
+ *
+ * @return 1, 2 or 8, or 0 in uncapped mode.
+ */
+double FixedTimestep::getMultiplier() const {
+    switch (speed) {
+        case SPEED_1X: return 1.0;
+        case SPEED_2X: return 2.0;
+        case SPEED_8X: return 8.0;
+        case SPEED_UNCAPPED: return 0.0;
+    }
+    return 1.0;
+}
+
+/**
+ * @brief Sets the speed multiplier.
+ *
+ * @param newSpeed Speed to run at from the next frame on.
+ */
+void FixedTimestep::setSpeed(GameSpeed newSpeed) {
+    speed = newSpeed;
+    accumulator = 0.0;
+}
+
+/**
+ * @brief Runs the ticks owed for a frame.
+ *
+ * @param frameSeconds Wall time elapsed since the previous frame.
+ * @param tick Function running one simulation tick; returns false to stop early.
+ * @return Number of ticks run.
+ */
+int FixedTimestep::advance(double frameSeconds, const function<bool()>& tick) {
+    int ticksRun = 0;
+
+    if (speed == SPEED_UNCAPPED) {
+        // Tick until this frame's budget is used up; rendering is the only brake
+        auto deadline = chrono::steady_clock::now() + chrono::duration<double>(uncappedBudget);
+        do {
+            if (!tick()) {
+                break;
+            }
+            ticksRun++;
+        } while (chrono::steady_clock::now() < deadline);
+        return ticksRun;
+    }
+
+    accumulator += frameSeconds * getMultiplier();
+
+    while (accumulator >= tickSeconds) {
+        if (ticksRun == maxTicksPerFrame) {
+            // Too far behind: drop the backlog rather than trying to catch up next frame
+            long long owed = static_cast<long long>(accumulator / tickSeconds);
+            droppedTicks += owed;
+            accumulator -= owed * tickSeconds;
+            break;
+        }
+        if (!tick()) {
+            accumulator = 0.0;
+            break;
+        }
+        accumulator -= tickSeconds;
+        ticksRun++;
+    }
+
+    return ticksRun;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file FixedTimestep.h
+ * @brief Declaration of the FixedTimestep class that decouples simulation ticks from rendered frames.
+ */
+
+#ifndef FIXED_TIMESTEP_H
+#define FIXED_TIMESTEP_H
+
+#include <functional>
+
+using namespace std;
+
+/**
+ * @enum GameSpeed
+ * @brief Speed multipliers offered to the player.
+ */
+enum GameSpeed { SPEED_1X, SPEED_2X, SPEED_8X, SPEED_UNCAPPED };
+
+/**
+ * @class FixedTimestep
+ * @brief Accumulator that turns variable frame times into a whole number of fixed ticks.
+ *
+ * Every frame, the elapsed wall time (scaled by the speed multiplier) is added to an
+ * accumulator and one tick is run per full tick duration it holds, so the game runs at the
+ * same pace whatever the refresh rate. The number of ticks per frame is capped; when the
+ * simulation cannot keep up, the backlog is dropped instead of growing every frame (the
+ * "spiral of death"). In uncapped mode the simulation simply runs as many ticks as fit in a
+ * per-frame time budget.
+ */
+class FixedTimestep {
+private:
+    double tickSeconds;       ///< Duration of one tick at 1x speed
+    double accumulator;       ///< Scaled time not yet consumed by ticks
+    int maxTicksPerFrame;     ///< Catch-up cap for the multiplied speeds
+    double uncappedBudget;    ///< Seconds per frame spent on ticks in uncapped mode
+    GameSpeed speed;          ///< Current speed multiplier
+    long long droppedTicks;   ///< Ticks skipped because of the catch-up cap
+
+public:
+    /**
+     * @brief Constructs a timestep.
+     * @param ticksPerSecond Tick rate at 1x speed.
+     * @param maxTicksPerFrame Maximum ticks run in one frame before the backlog is dropped.
+     * @param uncappedBudget Seconds of each frame spent simulating in uncapped mode.
+     */
+    explicit FixedTimestep(double ticksPerSecond = 10.0, int maxTicksPerFrame = 32, double uncappedBudget = 0.012);
+
+    /**
+     * @brief Runs the ticks owed for a frame.
+     * @param frameSeconds Wall time elapsed since the previous frame.
+     * @param tick Function running one simulation tick; returns false to stop early (e.g. game over).
+     * @return Number of ticks run.
+     */
+    int advance(double frameSeconds, const function<bool()>& tick);
+
+    /**
+     * @brief Sets the speed multiplier.
+     * @param newSpeed Speed to run at from the next frame on.
+     */
+    void setSpeed(GameSpeed newSpeed);
+
+    /** @brief Gets the speed multiplier. */
+    GameSpeed getSpeed() const { return speed; }
+
+    /** @brief Gets the multiplier applied to wall time, or 0 in uncapped mode. */
+    double getMultiplier() const;
+
+    /**
+     * @brief Gets how far the accumulator is into the next tick.
+     * @return Fraction in [0, 1) that renderers can use to interpolate between ticks.
+     */
+    double getAlpha() const { return accumulator / tickSeconds; }
+
+    /** @brief Gets the number of ticks skipped by the catch-up cap so far. */
+    long long getDroppedTicks() const { return droppedTicks; }
+};
+
+#endif // FIXED_TIMESTEP_H
@@ -0,0 +1,309 @@
+/**
+ * @file LayoutOptimizer.cpp
+ * @brief Implementation of the LayoutOptimizer class.
+ */
+
+#include "LayoutOptimizer.h"
+#include <algorithm>
+#include <unordered_set>
+#include "TowerLayout.h"
+#include "Zobrist.h"
+
+/**
+ * @brief Prepares a search on the map of a game configuration.
+ *
+ * @param config Game whose map and rules the layouts are evaluated with.
+ * @param options Search parameters.
+ * @param pool Optional worker pool.
+ */
+LayoutOptimizer::LayoutOptimizer(const SimulationConfig& config, const OptimizerConfig& options, ThreadPool* pool)
+        : config(config), options(options), pool(pool) {
+    this->config.threads = 1;
+    this->config.startingGold = max(config.startingGold, options.budget);
+
+    // Candidate cells: the buildable cells covering the most path for either tower type
+    Simulation sim(this->config);
+    Map& map = sim.getMap();
+    vector<pair<int, int>> ranked;  // (best coverage, cell index)
+    for (int y = 0; y < map.getHeight(); y++) {
+        for (int x = 0; x < map.getWidth(); x++) {
+            if (!map.isPath(x, y)) {
+                int best = max(map.getCoverage(x, y, getTowerRange(BASIC_TOWER)),
+                               map.getCoverage(x, y, getTowerRange(AOE_TOWER)));
+                ranked.push_back({best, y * map.getWidth() + x});
+            }
+        }
+    }
+    sort(ranked.begin(), ranked.end(), [](const pair<int, int>& a, const pair<int, int>& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+
+    for (int i = 0; i < options.candidateCells && i < static_cast<int>(ranked.size()); i++) {
+        int x = ranked[i].second % map.getWidth();
+        int y = ranked[i].second / map.getWidth();
+        cells.push_back({x, y});
+        coverage[BASIC_TOWER].push_back(map.getCoverage(x, y, getTowerRange(BASIC_TOWER)));
+        coverage[AOE_TOWER].push_back(map.getCoverage(x, y, getTowerRange(AOE_TOWER)));
+    }
+}
+
+/**
+ * @brief Computes the order-independent hash of a layout.
+ *
+ * Each tower contributes the key a placed level-1 tower of its type would have in the
+ * engine's state hash, and the keys are XORed, so the hash does not depend on the order
+ * the towers are listed in.
+ */
+uint64_t LayoutOptimizer::hashLayout(const vector<TowerPlacement>& layout) {
+    uint64_t hash = 0;
+    for (const TowerPlacement& tower : layout) {
+        hash ^= Tower::zobristKey(tower.x, tower.y, tower.type, 1);
+    }
+    return hash;
+}
+
+/**
+ * @brief Gets the gold needed to buy a layout.
+ */
+int LayoutOptimizer::layoutCost(const vector<TowerPlacement>& layout) {
+    int cost = 0;
+    for (const TowerPlacement& tower : layout) {
+        cost += getTowerCost(tower.type);
+    }
+    return cost;
+}
+
+/**
+ * @brief Estimates a layout's strength without simulating it.
+ *
+ * Sum over towers of (path cells in range) x (damage per hit). It ignores overlap and
+ * targeting, which is why it only serves to discard clearly weaker candidates.
+ */
+long LayoutOptimizer::estimate(const vector<TowerPlacement>& layout) const {
+    long total = 0;
+    for (const TowerPlacement& tower : layout) {
+        for (size_t i = 0; i < cells.size(); i++) {
+            if (cells[i].first == tower.x && cells[i].second == tower.y) {
+                total += static_cast<long>(coverage[tower.type][i]) * getTowerPower(tower.type);
+                break;
+            }
+        }
+    }
+    return total;
+}
+
+/**
+ * @brief Places a layout in a game.
+ *
+ * @param sim Game to place the towers in.
+ * @param layout Layout to buy.
+ * @return Number of towers placed.
+ */
+int LayoutOptimizer::applyLayout(Simulation& sim, const vector<TowerPlacement>& layout) {
+    int placed = 0;
+    for (const TowerPlacement& tower : layout) {
+        PlayerCommand command;
+        command.type = COMMAND_PLACE;
+        command.towerType = tower.type;
+        command.x = tower.x;
+        command.y = tower.y;
+        placed += sim.apply(command) ? 1 : 0;
+    }
+    return placed;
+}
+
+/**
+ * @brief Simulates a layout on the configured map.
+ */
+LayoutScore LayoutOptimizer::simulate(const vector<TowerPlacement>& layout) const {
+    const int STEP_TICKS = 32;
+    const uint64_t MAX_TICKS_PER_WAVE = 20000;
+
+    Simulation sim(config);
+    applyLayout(sim, layout);
+
+    uint64_t tickLimit = MAX_TICKS_PER_WAVE * static_cast<uint64_t>(options.maxWaves);
+    while (!sim.isGameOver() && sim.getWave() <= options.maxWaves && sim.getTick() < tickLimit) {
+        sim.step(STEP_TICKS);
+    }
+
+    LayoutScore score;
+    score.wavesSurvived = min(sim.getWave() - 1, options.maxWaves);
+    score.kills = sim.getKills();
+    score.leaks = sim.getLeaks();
+    return score;
+}
+
+/**
+ * @brief Adds every one-tower variation of a layout that fits the budget.
+ *
+ * Variations: add a tower on a free candidate cell, remove a tower, move a tower to a free
+ * candidate cell, or switch a tower's type. Every result is kept sorted by cell.
+ */
+void LayoutOptimizer::expand(const vector<TowerPlacement>& layout, vector<vector<TowerPlacement>>& out) const {
+    const TowerType TYPES[] = {BASIC_TOWER, AOE_TOWER};
+    int cost = layoutCost(layout);
+
+    auto occupied = [&layout](int x, int y) {
+        for (const TowerPlacement& tower : layout) {
+            if (tower.x == x && tower.y == y) {
+                return true;
+            }
+        }
+        return false;
+    };
+    auto emit = [&out](vector<TowerPlacement> candidate) {
+        sort(candidate.begin(), candidate.end());
+        out.push_back(std::move(candidate));
+    };
+
+    for (const pair<int, int>& cell : cells) {
+        if (occupied(cell.first, cell.second)) {
+            continue;
+        }
+        for (TowerType type : TYPES) {
+            if (cost + getTowerCost(type) <= options.budget) {
+                vector<TowerPlacement> added = layout;
+                added.push_back(TowerPlacement{type, cell.first, cell.second});
+                emit(added);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < layout.size(); i++) {
+        vector<TowerPlacement> removed = layout;
+        removed.erase(removed.begin() + i);
+        emit(removed);
+
+        TowerType other = layout[i].type == BASIC_TOWER ? AOE_TOWER : BASIC_TOWER;
+        if (cost - getTowerCost(layout[i].type) + getTowerCost(other) <= options.budget) {
+            vector<TowerPlacement> retyped = layout;
+            retyped[i].type = other;
+            emit(retyped);
+        }
+
+        for (const pair<int, int>& cell : cells) {
+            if (!occupied(cell.first, cell.second)) {
+                vector<TowerPlacement> moved = layout;
+                moved[i].x = cell.first;
+                moved[i].y = cell.second;
+                emit(moved);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Runs the search.
+ *
+ * @return Best layout found and search statistics.
+ */
+OptimizerResult LayoutOptimizer::optimize() {
+    OptimizerResult result;
+
+    // Seed the beam with the greedy layout: AoE-heavy and basic-only variants
+    vector<vector<TowerPlacement>> beam;
+    for (TowerType first : {BASIC_TOWER, AOE_TOWER}) {
+        vector<TowerPlacement> greedy;
+        int gold = options.budget;
+        for (const pair<int, int>& cell : cells) {
+            TowerType type = getTowerCost(first) <= gold ? first : BASIC_TOWER;
+            if (getTowerCost(type) > gold) {
+                break;
+            }
+            greedy.push_back(TowerPlacement{type, cell.first, cell.second});
+            gold -= getTowerCost(type);
+        }
+        sort(greedy.begin(), greedy.end());
+        beam.push_back(greedy);
+    }
+
+    vector<pair<LayoutScore, vector<TowerPlacement>>> scored;
+    for (int generation = 0; generation <= options.generations; generation++) {
+        // Candidates: the initial beam, then every variation of the current beam
+        vector<vector<TowerPlacement>> candidates;
+        if (generation == 0) {
+            candidates = beam;
+        } else {
+            for (const vector<TowerPlacement>& layout : beam) {
+                expand(layout, candidates);
+            }
+        }
+
+        // Transposition table: layouts scored in an earlier generation (and so either still in
+        // the beam or already beaten) and duplicates within this generation are skipped
+        vector<pair<long, size_t>> fresh;  // (estimate, candidate index)
+        unordered_set<uint64_t> seen;
+        for (size_t i = 0; i < candidates.size(); i++) {
+            uint64_t hash = hashLayout(candidates[i]);
+            if (table.count(hash) != 0 || !seen.insert(hash).second) {
+                result.cacheHits++;
+                continue;
+            }
+            fresh.push_back({estimate(candidates[i]), i});
+        }
+
+        // Prune candidates dominated on (cost, estimate): another one is no more expensive and stronger
+        sort(fresh.begin(), fresh.end(), [&candidates](const pair<long, size_t>& a, const pair<long, size_t>& b) {
+            int costA = layoutCost(candidates[a.second]), costB = layoutCost(candidates[b.second]);
+            return costA != costB ? costA < costB : a.first > b.first;
+        });
+        vector<pair<long, size_t>> frontier;
+        long bestSoFar = -1;
+        for (const pair<long, size_t>& candidate : fresh) {
+            if (candidate.first > bestSoFar) {
+                frontier.push_back(candidate);
+                bestSoFar = candidate.first;
+            } else if (candidate.first < bestSoFar) {
+                result.pruned++;
+            } else {
+                frontier.push_back(candidate);  // Ties are not dominated
+            }
+        }
+        sort(frontier.begin(), frontier.end(), [](const pair<long, size_t>& a, const pair<long, size_t>& b) {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+        });
+        if (static_cast<int>(frontier.size()) > options.maxEvaluations) {
+            result.pruned += frontier.size() - options.maxEvaluations;
+            frontier.resize(options.maxEvaluations);
+        }
+
+        // Simulate the survivors in parallel; each task owns its game
+        vector<LayoutScore> scores(frontier.size());
+        auto evaluate = [&](size_t i) { scores[i] = simulate(candidates[frontier[i].second]); };
+        if (pool != nullptr) {
+            pool->run(frontier.size(), evaluate);
+        } else {
+            for (size_t i = 0; i < frontier.size(); i++) {
+                evaluate(i);
+            }
+        }
+        for (size_t i = 0; i < frontier.size(); i++) {
+            const vector<TowerPlacement>& layout = candidates[frontier[i].second];
+            table[hashLayout(layout)] = scores[i];
+            scored.push_back({scores[i], layout});
+        }
+        result.simulated += frontier.size();
+
+        // The next beam: the best layouts found so far
+        stable_sort(scored.begin(), scored.end(),
+                    [](const pair<LayoutScore, vector<TowerPlacement>>& a,
+                       const pair<LayoutScore, vector<TowerPlacement>>& b) { return b.first < a.first; });
+        if (static_cast<int>(scored.size()) > options.beamWidth) {
+            scored.resize(options.beamWidth);
+        }
+        beam.clear();
+        for (const auto& entry : scored) {
+            beam.push_back(entry.second);
+        }
+        if (generation == 0 && !scored.empty()) {
+            result.greedyScore = scored.front().first;
+        }
+    }
+
+    if (!scored.empty()) {
+        result.score = scored.front().first;
+        result.layout = scored.front().second;
+    }
+    return result;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file LayoutOptimizer.h
+ * @brief Declaration of the LayoutOptimizer class, a search for the strongest tower layout on a map.
+ */
+
+#ifndef LAYOUT_OPTIMIZER_H
+#define LAYOUT_OPTIMIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Simulation.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+/**
+ * @struct TowerPlacement
+ * @brief One tower of a layout.
+ */
+struct TowerPlacement {
+    TowerType type = BASIC_TOWER;  ///< Tower type
+    int x = 0;                     ///< X-coordinate of the cell
+    int y = 0;                     ///< Y-coordinate of the cell
+
+    bool operator<(const TowerPlacement& other) const {
+        return y != other.y ? y < other.y : (x != other.x ? x < other.x : type < other.type);
+    }
+    bool operator==(const TowerPlacement& other) const {
+        return type == other.type && x == other.x && y == other.y;
+    }
+};
+
+/**
+ * @struct LayoutScore
+ * @brief Result of simulating a layout; higher is better, compared field by field.
+ */
+struct LayoutScore {
+    int wavesSurvived = 0;  ///< Waves fully cleared before dying or reaching the wave cap
+    int kills = 0;          ///< Critters killed, breaks ties between equal wave counts
+    int leaks = 0;          ///< Critters that reached the exit; fewer is better
+
+    bool operator<(const LayoutScore& other) const {
+        if (wavesSurvived != other.wavesSurvived) return wavesSurvived < other.wavesSurvived;
+        if (kills != other.kills) return kills < other.kills;
+        return leaks > other.leaks;
+    }
+};
+
+/**
+ * @struct OptimizerConfig
+ * @brief Parameters of a layout search.
+ */
+struct OptimizerConfig {
+    int budget = 500;         ///< Gold available for towers
+    int maxWaves = 20;        ///< Waves a layout has to survive to get the best score
+    int candidateCells = 24;  ///< Buildable cells considered, best coverage first
+    int beamWidth = 6;        ///< Layouts kept from one generation to the next
+    int generations = 8;      ///< Rounds of neighbour expansion
+    int maxEvaluations = 48;  ///< Simulations per generation, after pruning
+};
+
+/**
+ * @struct OptimizerResult
+ * @brief Best layout found and statistics of the search.
+ */
+struct OptimizerResult {
+    vector<TowerPlacement> layout;  ///< Best layout, sorted by cell
+    LayoutScore score;              ///< Its simulated score
+    LayoutScore greedyScore;        ///< Score of the greedy layout the search started from
+    size_t simulated = 0;           ///< Layouts actually simulated
+    size_t cacheHits = 0;           ///< Candidates answered from the transposition table
+    size_t pruned = 0;              ///< Candidates rejected by the coverage estimate
+};
+
+/**
+ * @class LayoutOptimizer
+ * @brief Beam search over tower layouts, with the headless simulation as fitness function.
+ *
+ * The search starts from the greedy coverage layout and repeatedly expands the best layouts
+ * by adding, removing, moving or retyping one tower. Before anything is simulated:
+ *  - every candidate is looked up in a transposition table keyed by an order-independent
+ *    layout hash, so a layout reached along several paths is simulated once;
+ *  - candidates dominated on (cost, coverage estimate) by another candidate are pruned,
+ *    and only the maxEvaluations best estimates are kept.
+ * The remaining candidates are simulated in parallel, one game each.
+ */
+class LayoutOptimizer {
+private:
+    SimulationConfig config;                      ///< Game the layouts are evaluated in
+    OptimizerConfig options;                      ///< Search parameters
+    ThreadPool* pool;                             ///< Worker pool for the simulations, or nullptr
+    vector<pair<int, int>> cells;                 ///< Candidate cells, best coverage first
+    vector<int> coverage[AOE_TOWER + 1];          ///< Path coverage of each candidate cell, per tower type
+    unordered_map<uint64_t, LayoutScore> table;   ///< Transposition table: layout hash to score
+
+    /** @brief Computes the order-independent hash of a layout. */
+    static uint64_t hashLayout(const vector<TowerPlacement>& layout);
+
+    /** @brief Gets the gold needed to buy a layout. */
+    static int layoutCost(const vector<TowerPlacement>& layout);
+
+    /** @brief Estimates a layout's strength from path coverage and tower power, without simulating. */
+    long estimate(const vector<TowerPlacement>& layout) const;
+
+    /** @brief Simulates a layout on the configured map. */
+    LayoutScore simulate(const vector<TowerPlacement>& layout) const;
+
+    /** @brief Adds every one-tower variation of a layout that fits the budget. */
+    void expand(const vector<TowerPlacement>& layout, vector<vector<TowerPlacement>>& out) const;
+
+public:
+    /**
+     * @brief Prepares a search on the map of a game configuration.
+     * @param config Game whose map and rules the layouts are evaluated with.
+     * @param options Search parameters.
+     * @param pool Optional worker pool; nullptr simulates on the calling thread.
+     */
+    LayoutOptimizer(const SimulationConfig& config, const OptimizerConfig& options, ThreadPool* pool = nullptr);
+
+    /**
+     * @brief Runs the search.
+     * @return Best layout found and search statistics.
+     */
+    OptimizerResult optimize();
+
+    /**
+     * @brief Places a layout in a game.
+     * @param sim Game to place the towers in.
+     * @param layout Layout to buy.
+     * @return Number of towers placed.
+     */
+    static int applyLayout(Simulation& sim, const vector<TowerPlacement>& layout);
+
+    /** @brief Gets the number of layouts in the transposition table. */
+    size_t getTableSize() const { return table.size(); }
+};
+
+#endif // LAYOUT_OPTIMIZER_H
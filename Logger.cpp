@@ -0,0 +1,142 @@
+/**
+ * @file Logger.cpp
+ * @brief Implementation of the Logger class.
+ */
+
+#include "Logger.h"
+#include <chrono>
+#include <cstdarg>
+
+/**
+ * @brief Starts a logger writing to stdout.
+ *
+ * @param capacity Number of messages the ring can hold; rounded up to a power of two.
+ */
+Logger::Logger(size_t capacity)
+        : capacity(1), enqueuePos(0), dequeuePos(0), minLevel(LOG_INFO), output(stdout), dropped(0), stopping(false) {
+    while (this->capacity < capacity) {
+        this->capacity <<= 1;
+    }
+    slots.reset(new Slot[this->capacity]);
+    for (size_t i = 0; i < this->capacity; i++) {
+        slots[i].sequence.store(i, memory_order_relaxed);
+    }
+    worker = thread(&Logger::run, this);
+}
+
+/**
+ * @brief Writes the remaining messages and stops the writer thread.
+ */
+Logger::~Logger() {
+    {
+        lock_guard<mutex> lock(wakeMutex);
+        stopping.store(true);
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+/**
+ * @brief Gets the process-wide logger used by the TD_LOG_* macros.
+ */
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+/**
+ * @brief Formats a message and queues it for the writer thread.
+ *
+ * A slot whose sequence equals the claimed position is free; the producer publishes it by
+ * setting the sequence to position + 1, and the writer frees it again for the next lap by
+ * setting it to position + capacity.
+ *
+ * @param level Level of the message.
+ * @param format printf-style format string.
+ */
+void Logger::write(LogLevel level, const char* format, ...) {
+    size_t pos = enqueuePos.load(memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+        slot = &slots[pos & (capacity - 1)];
+        size_t sequence = slot->sequence.load(memory_order_acquire);
+        if (sequence == pos) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                break;
+            }
+        } else if (sequence < pos) {
+            dropped.fetch_add(1, memory_order_relaxed);  // Ring is full
+            return;
+        } else {
+            pos = enqueuePos.load(memory_order_relaxed);
+        }
+    }
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(slot->text, MESSAGE_SIZE, format, args);
+    va_end(args);
+    slot->level = level;
+    slot->sequence.store(pos + 1, memory_order_release);
+}
+
+/**
+ * @brief Writes every published message to the output.
+ *
+ * @return True if at least one message was written.
+ */
+bool Logger::drain() {
+    static const char* const LEVEL_NAMES[] = {"TRACE", "DEBUG", "INFO", "WARN", "ERROR", "OFF"};
+
+    bool wrote = false;
+    size_t pos = dequeuePos.load(memory_order_relaxed);
+    while (true) {
+        Slot& slot = slots[pos & (capacity - 1)];
+        if (slot.sequence.load(memory_order_acquire) != pos + 1) {
+            break;
+        }
+
+        FILE* file = output.load(memory_order_relaxed);
+        if (file != nullptr) {
+            fprintf(file, "[%s] %s\n", LEVEL_NAMES[slot.level], slot.text);
+        }
+        slot.sequence.store(pos + capacity, memory_order_release);
+        dequeuePos.store(++pos, memory_order_release);
+        wrote = true;
+    }
+
+    if (wrote) {
+        FILE* file = output.load(memory_order_relaxed);
+        if (file != nullptr) {
+            fflush(file);
+        }
+    }
+    return wrote;
+}
+
+/**
+ * @brief Main loop of the writer thread: drains the ring until shut down.
+ */
+void Logger::run() {
+    while (true) {
+        bool stop = stopping.load();
+        if (!drain()) {
+            if (stop) {
+                return;  // Nothing left after the shutdown request
+            }
+            unique_lock<mutex> lock(wakeMutex);
+            wake.wait_for(lock, chrono::milliseconds(2));
+        }
+    }
+}
+
+/**
+ * @brief Blocks until every message queued so far has been written.
+ */
+void Logger::flush() {
+    size_t target = enqueuePos.load(memory_order_acquire);
+    while (dequeuePos.load(memory_order_acquire) < target) {
+        wake.notify_one();
+        this_thread::sleep_for(chrono::microseconds(200));
+    }
+}
@@ -0,0 +1,157 @@
+/**
+ * @file Logger.h
+ * @brief Declaration of the Logger class and the TD_LOG_* macros.
+ */
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+/**
+ * @enum LogLevel
+ * @brief Severity of a log message.
+ */
+enum LogLevel {
+    LOG_TRACE = 0,  ///< Very frequent details, e.g. individual hits
+    LOG_DEBUG = 1,  ///< Per-tick summaries
+    LOG_INFO = 2,   ///< Player-visible events such as placing or upgrading towers
+    LOG_WARN = 3,   ///< Rejected actions
+    LOG_ERROR = 4,  ///< Invalid game state
+    LOG_OFF = 5     ///< Disables logging
+};
+
+/**
+ * Lowest level compiled into the binary. Calls below it are removed by the compiler, including
+ * the evaluation of their arguments. Set with -DTD_LOG_LEVEL=<0..5>.
+ */
+#ifndef TD_LOG_LEVEL
+#define TD_LOG_LEVEL 1
+#endif
+
+#if defined(__GNUC__)
+#define TD_PRINTF_FORMAT(fmt, args) __attribute__((format(printf, fmt, args)))
+#else
+#define TD_PRINTF_FORMAT(fmt, args)
+#endif
+
+/**
+ * @class Logger
+ * @brief Leveled logger whose messages are formatted by the caller and written by a background thread.
+ *
+ * Messages go through a fixed-size lock-free ring: producers claim a slot with one atomic
+ * compare-and-swap, format into it and publish it, and never wait for I/O. When the ring is
+ * full the message is dropped and counted rather than blocking the game loop.
+ */
+class Logger {
+private:
+    /// Longest message kept, including the terminating null; longer messages are truncated.
+    static constexpr size_t MESSAGE_SIZE = 248;
+
+    /**
+     * @struct Slot
+     * @brief One message in the ring.
+     */
+    struct Slot {
+        atomic<size_t> sequence;   ///< Ring position the slot is ready for (see write/drain)
+        LogLevel level;            ///< Level of the message
+        char text[MESSAGE_SIZE];   ///< Formatted message
+    };
+
+    size_t capacity;                  ///< Number of slots; a power of two
+    unique_ptr<Slot[]> slots;         ///< Ring storage
+    atomic<size_t> enqueuePos;        ///< Next position claimed by a producer
+    atomic<size_t> dequeuePos;        ///< Next position read by the writer thread
+    atomic<int> minLevel;             ///< Runtime filter on top of TD_LOG_LEVEL
+    atomic<FILE*> output;             ///< Destination of the messages, or nullptr to discard them
+    atomic<size_t> dropped;           ///< Messages lost because the ring was full
+    atomic<bool> stopping;            ///< Set on shutdown
+    mutex wakeMutex;                  ///< Used only to sleep the writer thread
+    condition_variable wake;          ///< Wakes the writer thread early on flush and shutdown
+    thread worker;                    ///< Background writer
+
+    /** @brief Main loop of the writer thread. */
+    void run();
+
+    /**
+     * @brief Writes every published message to the output.
+     * @return True if at least one message was written.
+     */
+    bool drain();
+
+public:
+    /**
+     * @brief Starts a logger writing to stdout.
+     * @param capacity Number of messages the ring can hold; rounded up to a power of two.
+     */
+    explicit Logger(size_t capacity = 4096);
+
+    /** @brief Writes the remaining messages and stops the writer thread. */
+    ~Logger();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    /** @brief Gets the process-wide logger used by the TD_LOG_* macros. */
+    static Logger& instance();
+
+    /**
+     * @brief Formats a message and queues it for the writer thread.
+     * @param level Level of the message.
+     * @param format printf-style format string.
+     */
+    void write(LogLevel level, const char* format, ...) TD_PRINTF_FORMAT(3, 4);
+
+    /** @brief Checks if messages of a level pass the runtime filter. */
+    bool isEnabled(LogLevel level) const {
+        return level >= minLevel.load(memory_order_relaxed) && output.load(memory_order_relaxed) != nullptr;
+    }
+
+    /**
+     * @brief Sets the lowest level written at runtime; levels below TD_LOG_LEVEL stay compiled out.
+     * @param level Lowest level to write; LOG_OFF silences the logger.
+     */
+    void setLevel(LogLevel level) { minLevel.store(level, memory_order_relaxed); }
+
+    /**
+     * @brief Redirects the messages.
+     * @param file Destination, or nullptr to discard messages.
+     */
+    void setOutput(FILE* file) { output.store(file, memory_order_relaxed); }
+
+    /** @brief Blocks until every message queued so far has been written. */
+    void flush();
+
+    /** @brief Gets the number of messages lost because the ring was full. */
+    size_t getDroppedCount() const { return dropped.load(memory_order_relaxed); }
+};
+
+/**
+ * @brief Logs a printf-style message at a level.
+ *
+ * Compiles to nothing when the level is below TD_LOG_LEVEL; otherwise costs one relaxed
+ * load when the level is filtered out at runtime.
+ */
+#define TD_LOG(level, ...)                                                        \
+    do {                                                                          \
+        if ((level) >= TD_LOG_LEVEL && Logger::instance().isEnabled(level)) {     \
+            Logger::instance().write((level), __VA_ARGS__);                       \
+        }                                                                         \
+    } while (0)
+
+#define TD_LOG_TRACE(...) TD_LOG(LOG_TRACE, __VA_ARGS__)
+#define TD_LOG_DEBUG(...) TD_LOG(LOG_DEBUG, __VA_ARGS__)
+#define TD_LOG_INFO(...) TD_LOG(LOG_INFO, __VA_ARGS__)
+#define TD_LOG_WARN(...) TD_LOG(LOG_WARN, __VA_ARGS__)
+#define TD_LOG_ERROR(...) TD_LOG(LOG_ERROR, __VA_ARGS__)
+
+#endif // LOGGER_H
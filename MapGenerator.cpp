@@ -0,0 +1,222 @@
+/**
+ * @file MapGenerator.cpp
+ * @brief Implementation of the MapGenerator class.
+ */
+
+#include "MapGenerator.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include "Zobrist.h"
+
+/// Lattice steps in the order a walk considers them: right, down, up, left.
+static const int STEP_X[4] = {1, 0, 0, -1};
+static const int STEP_Y[4] = {0, 1, -1, 0};
+
+/**
+ * @brief Creates a generator for maps of one size.
+ *
+ * @param width Map width in cells.
+ * @param height Map height in cells.
+ * @param constraints Requirements of the generated maps.
+ */
+MapGenerator::MapGenerator(int width, int height, const MapConstraints& constraints)
+        : width(width), height(height), constraints(constraints) {
+}
+
+/**
+ * @brief Gets constraints that suit a map size.
+ *
+ * The path must cover a sixth of the map and turn once per three cells of width and height,
+ * a quarter of the map must be within tower range of it, and there must be one strong slot
+ * per 100 cells. A strong slot sees three times the tower's range in path cells, which in
+ * practice means it sits between two corridors.
+ *
+ * @param width Map width in cells.
+ * @param height Map height in cells.
+ * @param towerRange Range of the towers the slots are meant for.
+ * @return Constraints most seeds can meet within DEFAULT_CANDIDATES candidates.
+ */
+MapConstraints MapGenerator::defaultConstraints(int width, int height, int towerRange) {
+    MapConstraints constraints;
+    constraints.minPathLength = width * height / 6;
+    constraints.minTurns = (width + height) / 3;
+    constraints.minBuildable = width * height / 4;
+    constraints.towerSlots = max(2, width * height / 100);
+    constraints.minSlotCoverage = 3 * towerRange;
+    constraints.towerRange = towerRange;
+    return constraints;
+}
+
+/**
+ * @brief Samples and scores one candidate.
+ *
+ * The walk runs over the lattice of even cells. Every step moves two cells, so the cell in
+ * between joins the path too and lattice cells next to each other but not joined by a step
+ * keep a scenery cell between them. On maps of even width the lattice stops one cell short
+ * of the right edge, and the path takes one more step to reach it.
+ *
+ * @param seed Seed of the candidate.
+ * @param path Receives the path from entry to exit, if not nullptr.
+ * @return Measurements and score of the candidate.
+ */
+MapScore MapGenerator::sample(unsigned int seed, vector<pair<int, int>>* path) const {
+    mt19937 rng(seed);
+    int latticeWidth = (width + 1) / 2, latticeHeight = (height + 1) / 2;
+    int entry = static_cast<int>(rng() % latticeHeight) * latticeWidth;
+    int exit = static_cast<int>(rng() % latticeHeight) * latticeWidth + latticeWidth - 1;
+    unsigned int straightness = rng() % 4;  // Chance, in quarters, that the walk keeps its direction
+
+    // Randomized depth-first walk; when it reaches the exit, the stack is the path
+    vector<uint8_t> visited(static_cast<size_t>(latticeWidth) * latticeHeight, 0);
+    vector<int> stack = {entry};
+    vector<int> heading = {-1};
+    visited[entry] = 1;
+    while (stack.back() != exit) {
+        int node = stack.back();
+        int x = node % latticeWidth, y = node / latticeWidth;
+        int options[4], count = 0;
+        for (int i = 0; i < 4; i++) {
+            int nx = x + STEP_X[i], ny = y + STEP_Y[i];
+            if (nx >= 0 && nx < latticeWidth && ny >= 0 && ny < latticeHeight && !visited[ny * latticeWidth + nx]) {
+                options[count++] = i;
+            }
+        }
+        if (count == 0) {
+            stack.pop_back();
+            heading.pop_back();
+            continue;
+        }
+        int direction = options[rng() % count];
+        if (heading.back() >= 0 && rng() % 4 < straightness) {
+            for (int i = 0; i < count; i++) {
+                direction = options[i] == heading.back() ? options[i] : direction;
+            }
+        }
+        int next = (y + STEP_Y[direction]) * latticeWidth + x + STEP_X[direction];
+        visited[next] = 1;
+        stack.push_back(next);
+        heading.push_back(direction);
+    }
+
+    vector<pair<int, int>> cells;
+    cells.reserve(stack.size() * 2 + 1);
+    for (size_t i = 0; i < stack.size(); i++) {
+        int x = stack[i] % latticeWidth * 2, y = stack[i] / latticeWidth * 2;
+        if (i > 0) {
+            cells.push_back({x - STEP_X[heading[i]], y - STEP_Y[heading[i]]});
+        }
+        cells.push_back({x, y});
+    }
+    if (cells.back().first != width - 1) {
+        cells.push_back({width - 1, cells.back().second});
+    }
+
+    MapScore score;
+    score.seed = seed;
+    score.pathLength = static_cast<int>(cells.size());
+    for (size_t i = 2; i < cells.size(); i++) {
+        bool straight = cells[i].first - cells[i - 1].first == cells[i - 1].first - cells[i - 2].first
+                        && cells[i].second - cells[i - 1].second == cells[i - 1].second - cells[i - 2].second;
+        score.turns += straight ? 0 : 1;
+    }
+
+    // Coverage of every scenery cell: for each row within range, a prefix-sum lookup of the
+    // path cells within the remaining horizontal reach
+    int range = constraints.towerRange;
+    vector<uint8_t> grid(static_cast<size_t>(width) * height, 0);
+    for (const pair<int, int>& cell : cells) {
+        grid[static_cast<size_t>(cell.second) * width + cell.first] = 1;
+    }
+    vector<int> prefix(static_cast<size_t>(width + 1) * height, 0);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            prefix[static_cast<size_t>(y) * (width + 1) + x + 1] = prefix[static_cast<size_t>(y) * (width + 1) + x]
+                                                                  + grid[static_cast<size_t>(y) * width + x];
+        }
+    }
+    vector<int> slots;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (grid[static_cast<size_t>(y) * width + x]) {
+                continue;
+            }
+            int covered = 0;
+            for (int ny = max(0, y - range); ny <= min(height - 1, y + range); ny++) {
+                int reach = range - abs(ny - y);
+                const int* row = &prefix[static_cast<size_t>(ny) * (width + 1)];
+                covered += row[min(width, x + reach + 1)] - row[max(0, x - reach)];
+            }
+            if (covered > 0) {
+                score.buildable++;
+                slots.push_back(covered);
+            }
+        }
+    }
+    int slotCount = min(constraints.towerSlots, static_cast<int>(slots.size()));
+    nth_element(slots.begin(), slots.begin() + slotCount, slots.end(), greater<int>());
+    for (int i = 0; i < slotCount; i++) {
+        score.slotCoverage += slots[i];
+    }
+    score.worstSlot = slotCount > 0 ? *min_element(slots.begin(), slots.begin() + slotCount) : 0;
+
+    long shortfall = max(0, constraints.minPathLength - score.pathLength) + max(0, constraints.minTurns - score.turns)
+                     + max(0, constraints.minBuildable - score.buildable);
+    if (slotCount < constraints.towerSlots) {
+        shortfall += static_cast<long>(constraints.towerSlots - slotCount) * constraints.minSlotCoverage;
+    }
+    for (int i = 0; i < slotCount; i++) {
+        shortfall += max(0, constraints.minSlotCoverage - slots[i]);
+    }
+    score.feasible = shortfall == 0;
+    score.score = score.feasible ? score.pathLength + 2L * score.turns + score.slotCoverage : -shortfall;
+
+    if (path != nullptr) {
+        path->swap(cells);
+    }
+    return score;
+}
+
+/**
+ * @brief Samples candidates and lays the best one out on a map.
+ *
+ * Candidate seeds are mixed from the seed and the candidate number, and every candidate
+ * writes its score to its own entry, so the choice is the same with or without a pool. Only
+ * the winner's path is kept: it is sampled a second time from its seed.
+ *
+ * @param map Map to lay the path out on; must have the generator's size.
+ * @param seed Seed the candidate seeds are derived from.
+ * @param candidates Number of candidates to sample.
+ * @param pool Worker pool to score the candidates in parallel, or nullptr.
+ * @param best Receives the score of the chosen candidate, if not nullptr.
+ * @return True if the chosen candidate meets every constraint.
+ */
+bool MapGenerator::generate(Map& map, unsigned int seed, int candidates, ThreadPool* pool, MapScore* best) const {
+    vector<MapScore> scores(static_cast<size_t>(max(1, candidates)));
+    auto score = [&](size_t i) {
+        scores[i] = sample(static_cast<unsigned int>(splitmix64(static_cast<uint64_t>(seed) << 32 | i)));
+    };
+    if (pool != nullptr) {
+        pool->run(scores.size(), score);
+    } else {
+        for (size_t i = 0; i < scores.size(); i++) {
+            score(i);
+        }
+    }
+
+    size_t chosen = 0;
+    for (size_t i = 1; i < scores.size(); i++) {
+        if (scores[i].feasible != scores[chosen].feasible ? scores[i].feasible : scores[i].score > scores[chosen].score) {
+            chosen = i;
+        }
+    }
+
+    vector<pair<int, int>> path;
+    sample(scores[chosen].seed, &path);
+    map.loadPath(path);
+    if (best != nullptr) {
+        *best = scores[chosen];
+    }
+    return scores[chosen].feasible;
+}
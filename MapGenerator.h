@@ -0,0 +1,112 @@
+/**
+ * @file MapGenerator.h
+ * @brief Declaration of the MapGenerator class, winding paths sampled in bulk and checked against constraints.
+ */
+
+#ifndef MAP_GENERATOR_H
+#define MAP_GENERATOR_H
+
+#include <utility>
+#include <vector>
+#include "mapgen.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+/**
+ * @struct MapConstraints
+ * @brief Requirements a generated map must meet.
+ */
+struct MapConstraints {
+    int minPathLength = 0;    ///< Fewest PATH cells from entry to exit, both included
+    int minTurns = 0;         ///< Fewest changes of direction along the path
+    int minBuildable = 0;     ///< Fewest SCENERY cells within towerRange of the path
+    int towerSlots = 0;       ///< Number of SCENERY cells that must each cover minSlotCoverage path cells
+    int minSlotCoverage = 0;  ///< Path cells each of the towerSlots best cells must cover
+    int towerRange = 3;       ///< Manhattan range coverage is measured for
+};
+
+/**
+ * @struct MapScore
+ * @brief Measurements of one candidate map.
+ */
+struct MapScore {
+    unsigned int seed = 0;   ///< Seed the candidate was sampled from
+    int pathLength = 0;      ///< PATH cells from entry to exit
+    int turns = 0;           ///< Changes of direction along the path
+    int buildable = 0;       ///< SCENERY cells within range of the path
+    int slotCoverage = 0;    ///< Path cells covered by the towerSlots best cells together
+    int worstSlot = 0;       ///< Path cells covered by the weakest of those cells
+    bool feasible = false;   ///< True if every constraint is met
+    long score = 0;          ///< Higher is better; for infeasible candidates, minus the total shortfall
+};
+
+/**
+ * @class MapGenerator
+ * @brief Samples many winding, maze-like paths and keeps the one that best meets the constraints.
+ *
+ * A candidate path is a randomized depth-first walk over every other cell, from a cell on the
+ * left edge until it reaches one on the right edge. Corridors therefore always have a row or
+ * column of scenery between them. That scenery is where towers cover two corridors at once,
+ * and critters can never take a shortcut between corridors. Each candidate also picks how
+ * strongly the walk keeps going straight, so the candidates range from long straight runs
+ * to tight switchbacks.
+ *
+ * Scoring a candidate is a few passes over a byte grid of the map: path length and turns from
+ * the walk, then per-cell coverage from row prefix sums. Candidates are independent, so
+ * generate() scores them in parallel on a ThreadPool and only builds a Map for the winner.
+ * The result depends only on the seed and the candidate count, not on the thread count.
+ */
+class MapGenerator {
+public:
+    /// Candidates generate() samples unless told otherwise.
+    static const int DEFAULT_CANDIDATES = 64;
+
+private:
+    int width, height;            ///< Map size in cells
+    MapConstraints constraints;   ///< Requirements of the generated maps
+
+public:
+    /**
+     * @brief Creates a generator for maps of one size.
+     * @param width Map width in cells.
+     * @param height Map height in cells.
+     * @param constraints Requirements of the generated maps.
+     */
+    MapGenerator(int width, int height, const MapConstraints& constraints);
+
+    /**
+     * @brief Gets constraints that suit a map size: a path winding over much of the map and
+     * enough strong tower slots for a game.
+     * @param width Map width in cells.
+     * @param height Map height in cells.
+     * @param towerRange Range of the towers the slots are meant for.
+     * @return Constraints most seeds can meet within DEFAULT_CANDIDATES candidates.
+     */
+    static MapConstraints defaultConstraints(int width, int height, int towerRange);
+
+    /**
+     * @brief Samples and scores one candidate.
+     * @param seed Seed of the candidate.
+     * @param path Receives the path from entry to exit, if not nullptr.
+     * @return Measurements and score of the candidate.
+     */
+    MapScore sample(unsigned int seed, vector<pair<int, int>>* path = nullptr) const;
+
+    /**
+     * @brief Samples candidates and lays the best one out on a map.
+     *
+     * Feasible candidates beat infeasible ones, then the higher score wins, then the lower
+     * candidate number. If no candidate is feasible, the map still gets the closest one.
+     * @param map Map to lay the path out on; must have the generator's size.
+     * @param seed Seed the candidate seeds are derived from.
+     * @param candidates Number of candidates to sample.
+     * @param pool Worker pool to score the candidates in parallel, or nullptr.
+     * @param best Receives the score of the chosen candidate, if not nullptr.
+     * @return True if the chosen candidate meets every constraint.
+     */
+    bool generate(Map& map, unsigned int seed, int candidates = DEFAULT_CANDIDATES, ThreadPool* pool = nullptr,
+                  MapScore* best = nullptr) const;
+};
+
+#endif // MAP_GENERATOR_H
@@ -0,0 +1,543 @@
+/**
+ * @file PathHierarchy.cpp
+ * @brief Implementation of the PathHierarchy class.
+ */
+
+#include "PathHierarchy.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+
+/// Entrances up to this many cells long get a single transition in their middle.
+static const int SHORT_ENTRANCE = 6;
+
+/// Steps of cells that cannot be reached.
+static const uint32_t NO_STEPS = UINT32_MAX;
+
+/// Stand-ins for the start and goal in the abstract search; no cell index is this large.
+static const uint32_t START_ID = UINT32_MAX - 1;
+static const uint32_t GOAL_ID = UINT32_MAX - 2;
+
+/**
+ * @brief Runs a task for every index of a list, on a pool if there is one.
+ *
+ * @param pool Worker pool, or nullptr to run on the calling thread.
+ * @param indices Indices to run the task for.
+ * @param task Task taking an index from the list.
+ */
+static void forEach(ThreadPool* pool, const vector<uint32_t>& indices, const function<void(size_t)>& task) {
+    if (pool != nullptr && indices.size() > 1) {
+        pool->run(indices.size(), [&](size_t i) { task(indices[i]); });
+    } else {
+        for (uint32_t index : indices) {
+            task(index);
+        }
+    }
+}
+
+/**
+ * @brief Builds the hierarchy of a map.
+ *
+ * Borders are scanned for every cluster first, since a cluster's nodes come from its own
+ * borders and those of its west and north neighbours; then every cluster is linked.
+ *
+ * @param map Map to route on; must outlive the hierarchy.
+ * @param clusterSize Side of a cluster in cells; 8 to 256.
+ * @param pool Worker pool to build the clusters in parallel, or nullptr.
+ */
+PathHierarchy::PathHierarchy(const Map& map, int clusterSize, ThreadPool* pool)
+        : map(&map), width(map.getWidth()), height(map.getHeight()), clusterSize(max(8, min(clusterSize, 256))),
+          searchCount(0) {
+    clustersX = (width + this->clusterSize - 1) / this->clusterSize;
+    clustersY = (height + this->clusterSize - 1) / this->clusterSize;
+    clusters.resize(static_cast<size_t>(clustersX) * clustersY);
+    dirty.assign(clusters.size(), 0);
+
+    vector<uint32_t> all(clusters.size());
+    for (size_t i = 0; i < all.size(); i++) {
+        all[i] = static_cast<uint32_t>(i);
+    }
+    forEach(pool, all, [this](size_t index) { scanBorders(index); });
+    forEach(pool, all, [this](size_t index) { linkCluster(index); });
+}
+
+/**
+ * @brief Finds the transitions across a cluster's east and south borders.
+ *
+ * An entrance is a maximal run of border cells that are walkable on both sides. Short
+ * entrances get one transition in the middle, long ones one at each end.
+ *
+ * @param index Cluster index.
+ */
+void PathHierarchy::scanBorders(size_t index) {
+    Cluster& cluster = clusters[index];
+    int cx = static_cast<int>(index % clustersX), cy = static_cast<int>(index / clustersX);
+    int x0 = cx * clusterSize, y0 = cy * clusterSize;
+    int w = min(clusterSize, width - x0), h = min(clusterSize, height - y0);
+
+    auto addEntrance = [](vector<uint16_t>& transitions, int first, int last) {
+        if (last - first + 1 <= SHORT_ENTRANCE) {
+            transitions.push_back(static_cast<uint16_t>((first + last) / 2));
+        } else {
+            transitions.push_back(static_cast<uint16_t>(first));
+            transitions.push_back(static_cast<uint16_t>(last));
+        }
+    };
+
+    cluster.east.clear();
+    if (cx + 1 < clustersX) {
+        int x = x0 + w - 1;
+        int runStart = -1;
+        for (int i = 0; i <= h; i++) {
+            bool open = i < h && map->isWalkable(x, y0 + i) && map->isWalkable(x + 1, y0 + i);
+            if (open && runStart < 0) {
+                runStart = i;
+            } else if (!open && runStart >= 0) {
+                addEntrance(cluster.east, runStart, i - 1);
+                runStart = -1;
+            }
+        }
+    }
+
+    cluster.south.clear();
+    if (cy + 1 < clustersY) {
+        int y = y0 + h - 1;
+        int runStart = -1;
+        for (int i = 0; i <= w; i++) {
+            bool open = i < w && map->isWalkable(x0 + i, y) && map->isWalkable(x0 + i, y + 1);
+            if (open && runStart < 0) {
+                runStart = i;
+            } else if (!open && runStart >= 0) {
+                addEntrance(cluster.south, runStart, i - 1);
+                runStart = -1;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Reads which cells of a cluster are walkable.
+ *
+ * The cells are stored with a closed frame one cell wide, so a search never needs bounds checks.
+ *
+ * @param index Cluster index.
+ * @param open Receives 1 for walkable cells, by local index; the frame around the cluster and cells past the map edge are 0.
+ */
+void PathHierarchy::loadCluster(size_t index, vector<uint8_t>& open) const {
+    int x0 = static_cast<int>(index % clustersX) * clusterSize, y0 = static_cast<int>(index / clustersX) * clusterSize;
+    int w = min(clusterSize, width - x0), h = min(clusterSize, height - y0);
+    size_t stride = static_cast<size_t>(clusterSize) + 2;
+    open.assign(stride * stride, 0);
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            open[(y + 1) * stride + x + 1] = map->isWalkable(x0 + x, y0 + y) ? 1 : 0;
+        }
+    }
+}
+
+/**
+ * @brief Walks a cluster breadth-first from one cell, without leaving it.
+ *
+ * @param open Walkable cells of the cluster, from loadCluster(); targets are marked 2.
+ * @param from Local index of the cell to start from.
+ * @param targets Number of target cells after which to stop, or 0 to walk the whole cluster.
+ * @param steps Receives the steps to every cell reached, by local index; UINT32_MAX for the others.
+ * @param parents Receives the local index of each cell's predecessor, if not nullptr.
+ */
+void PathHierarchy::searchCluster(const vector<uint8_t>& open, uint32_t from, size_t targets, vector<uint32_t>& steps,
+                                  vector<uint32_t>* parents) const {
+    steps.assign(open.size(), NO_STEPS);
+    if (parents != nullptr) {
+        parents->assign(open.size(), from);
+    }
+    if (!open[from]) {
+        return;
+    }
+
+    vector<uint32_t> frontier;
+    frontier.reserve(open.size());
+    steps[from] = 0;
+    frontier.push_back(from);
+    size_t found = open[from] == 2 ? 1 : 0;
+    uint32_t stride = static_cast<uint32_t>(clusterSize) + 2;
+    for (size_t head = 0; head < frontier.size() && (targets == 0 || found < targets); head++) {
+        uint32_t cell = frontier[head];
+        uint32_t next[4] = {cell + 1, cell + stride, cell - stride, cell - 1};
+        for (uint32_t neighbour : next) {
+            if (open[neighbour] && steps[neighbour] == NO_STEPS) {
+                steps[neighbour] = steps[cell] + 1;
+                if (parents != nullptr) {
+                    (*parents)[neighbour] = cell;
+                }
+                found += open[neighbour] == 2;
+                frontier.push_back(neighbour);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Collects a cluster's nodes from its own and its neighbours' borders and links them.
+ *
+ * Transitions on the cluster's east and south borders come from its own scan, those on its
+ * west and north borders from the scans of the neighbours there. A cell can be a transition
+ * across two borders at a corner; it becomes one node with both link bits. Each node is then
+ * linked to the nodes it can walk to inside the cluster.
+ *
+ * @param index Cluster index.
+ */
+void PathHierarchy::linkCluster(size_t index) {
+    Cluster& cluster = clusters[index];
+    int cx = static_cast<int>(index % clustersX), cy = static_cast<int>(index / clustersX);
+    int x0 = cx * clusterSize, y0 = cy * clusterSize;
+    int w = min(clusterSize, width - x0), h = min(clusterSize, height - y0);
+    auto cellAt = [this](int x, int y) { return static_cast<uint32_t>(y * width + x); };
+
+    vector<Node> nodes;
+    for (uint16_t row : cluster.east) {
+        nodes.push_back({cellAt(x0 + w - 1, y0 + row), 1});
+    }
+    for (uint16_t column : cluster.south) {
+        nodes.push_back({cellAt(x0 + column, y0 + h - 1), 2});
+    }
+    if (cx > 0) {
+        for (uint16_t row : clusters[index - 1].east) {
+            nodes.push_back({cellAt(x0, y0 + row), 4});
+        }
+    }
+    if (cy > 0) {
+        for (uint16_t column : clusters[index - clustersX].south) {
+            nodes.push_back({cellAt(x0 + column, y0), 8});
+        }
+    }
+    sort(nodes.begin(), nodes.end(), [](const Node& a, const Node& b) { return a.cell < b.cell; });
+    cluster.nodes.clear();
+    for (const Node& node : nodes) {
+        if (!cluster.nodes.empty() && cluster.nodes.back().cell == node.cell) {
+            cluster.nodes.back().links |= node.links;
+        } else {
+            cluster.nodes.push_back(node);
+        }
+    }
+
+    cluster.edgeStart.assign(1, 0);
+    cluster.edges.clear();
+    vector<uint8_t> open;
+    vector<uint32_t> steps;
+    loadCluster(index, open);
+
+    // Distances are symmetric, so each search only has to reach the nodes after its own
+    size_t count = cluster.nodes.size();
+    vector<uint32_t> costs(count * count, NO_STEPS);
+    for (size_t i = 0; i < count; i++) {
+        open[localIndex(cluster.nodes[i].cell)] = 2;
+    }
+    for (size_t i = 0; i + 1 < count; i++) {
+        open[localIndex(cluster.nodes[i].cell)] = 1;
+        searchCluster(open, localIndex(cluster.nodes[i].cell), count - 1 - i, steps, nullptr);
+        for (size_t j = i + 1; j < count; j++) {
+            costs[i * count + j] = costs[j * count + i] = steps[localIndex(cluster.nodes[j].cell)];
+        }
+    }
+
+    // An edge is left out when another node lies on a shortest walk between its ends; the
+    // two edges through that node give the same distance, and open clusters lose most edges
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = 0; j < count; j++) {
+            uint32_t direct = costs[i * count + j];
+            bool implied = false;
+            for (size_t k = 0; k < count && !implied && direct != NO_STEPS; k++) {
+                implied = k != i && k != j && costs[i * count + k] != NO_STEPS && costs[k * count + j] != NO_STEPS
+                          && costs[i * count + k] + costs[k * count + j] == direct;
+            }
+            if (direct != NO_STEPS && !implied) {
+                cluster.edges.push_back({static_cast<uint32_t>(j), costs[i * count + j]});
+            }
+        }
+        cluster.edgeStart.push_back(static_cast<uint32_t>(cluster.edges.size()));
+    }
+}
+
+/**
+ * @brief Finds a node of a cluster by its cell.
+ *
+ * @param index Cluster index.
+ * @param cell Cell index.
+ * @return Index in the cluster's node list, or -1 if the cell is not a node.
+ */
+int PathHierarchy::findNode(size_t index, uint32_t cell) const {
+    const vector<Node>& nodes = clusters[index].nodes;
+    auto found = lower_bound(nodes.begin(), nodes.end(), cell, [](const Node& node, uint32_t c) { return node.cell < c; });
+    return found != nodes.end() && found->cell == cell ? static_cast<int>(found - nodes.begin()) : -1;
+}
+
+/**
+ * @brief Records that a cell may have changed walkability; applied by the next update().
+ *
+ * @param x X-coordinate of the cell.
+ * @param y Y-coordinate of the cell.
+ */
+void PathHierarchy::markChanged(int x, int y) {
+    if (x < 0 || x >= width || y < 0 || y >= height) {
+        return;
+    }
+    size_t index = clusterOf(x, y);
+    if (!dirty[index]) {
+        dirty[index] = 1;
+        dirtyClusters.push_back(static_cast<uint32_t>(index));
+    }
+}
+
+/**
+ * @brief Rebuilds the changed clusters and relinks their neighbours.
+ *
+ * A changed cluster shares its west and north borders with the neighbours there, so their
+ * scans are redone along with its own. The changed clusters are relinked, since distances
+ * inside them may differ; a neighbour is relinked only if the transitions on the border it
+ * shares with one of them moved, which most edits away from a border leave alone.
+ *
+ * @param pool Worker pool to relink the clusters in parallel, or nullptr.
+ * @return Number of clusters relinked.
+ */
+size_t PathHierarchy::update(ThreadPool* pool) {
+    if (dirtyClusters.empty()) {
+        return 0;
+    }
+
+    vector<uint32_t> rescan, relink;
+    for (uint32_t index : dirtyClusters) {
+        rescan.push_back(index);
+        relink.push_back(index);
+        if (index % clustersX > 0) {
+            rescan.push_back(index - 1);
+        }
+        if (index / clustersX > 0) {
+            rescan.push_back(index - clustersX);
+        }
+        dirty[index] = 0;
+    }
+    dirtyClusters.clear();
+    sort(rescan.begin(), rescan.end());
+    rescan.erase(unique(rescan.begin(), rescan.end()), rescan.end());
+
+    vector<vector<uint16_t>> oldEast(rescan.size()), oldSouth(rescan.size());
+    for (size_t i = 0; i < rescan.size(); i++) {
+        oldEast[i].swap(clusters[rescan[i]].east);
+        oldSouth[i].swap(clusters[rescan[i]].south);
+    }
+    forEach(pool, rescan, [this](size_t index) { scanBorders(index); });
+    for (size_t i = 0; i < rescan.size(); i++) {
+        const Cluster& cluster = clusters[rescan[i]];
+        if (cluster.east != oldEast[i]) {
+            relink.push_back(rescan[i]);
+            relink.push_back(rescan[i] + 1);
+        }
+        if (cluster.south != oldSouth[i]) {
+            relink.push_back(rescan[i]);
+            relink.push_back(rescan[i] + clustersX);
+        }
+    }
+    sort(relink.begin(), relink.end());
+    relink.erase(unique(relink.begin(), relink.end()), relink.end());
+
+    forEach(pool, relink, [this](size_t index) { linkCluster(index); });
+    return relink.size();
+}
+
+/**
+ * @brief Appends the cells of a walk inside a cluster to a route, from one cell to another.
+ *
+ * @param index Cluster index.
+ * @param from First cell; already on the route.
+ * @param to Last cell.
+ * @param route Route to extend.
+ */
+void PathHierarchy::appendWalk(size_t index, uint32_t from, uint32_t to, vector<pair<int, int>>& route) const {
+    vector<uint8_t> open;
+    vector<uint32_t> steps, parents;
+    loadCluster(index, open);
+    uint32_t local = localIndex(from);
+    open[localIndex(to)] = 2;
+    searchCluster(open, local, 1, steps, &parents);
+
+    int x0 = static_cast<int>(index % clustersX) * clusterSize - 1, y0 = static_cast<int>(index / clustersX) * clusterSize - 1;
+    int stride = clusterSize + 2;
+    vector<pair<int, int>> walk;
+    for (uint32_t cell = localIndex(to); cell != local; cell = parents[cell]) {
+        walk.push_back({x0 + static_cast<int>(cell % stride), y0 + static_cast<int>(cell / stride)});
+    }
+    route.insert(route.end(), walk.rbegin(), walk.rend());
+}
+
+/**
+ * @brief Finds a route between two cells, applying pending changes first.
+ *
+ * The start and goal are joined to the nodes of their clusters by a search inside each
+ * cluster, then A* with the Manhattan distance as heuristic runs over the nodes: along
+ * intra-cluster edges and across the borders between transition cells. A start and goal in
+ * the same cluster that are connected inside it take the direct walk. The route is refined
+ * into cells by walking each abstract edge again inside its cluster.
+ *
+ * @param startX X-coordinate of the start.
+ * @param startY Y-coordinate of the start.
+ * @param goalX X-coordinate of the goal.
+ * @param goalY Y-coordinate of the goal.
+ * @param route Receives the cells of the route, start and goal included, if not nullptr.
+ * @return Length of the route in steps, or -1 if the goal cannot be reached.
+ */
+int PathHierarchy::findRoute(int startX, int startY, int goalX, int goalY, vector<pair<int, int>>* route) {
+    update();
+    if (route != nullptr) {
+        route->clear();
+    }
+    if (startX < 0 || startX >= width || startY < 0 || startY >= height || goalX < 0 || goalX >= width || goalY < 0
+        || goalY >= height || !map->isWalkable(startX, startY) || !map->isWalkable(goalX, goalY)) {
+        return -1;
+    }
+
+    uint32_t start = static_cast<uint32_t>(startY * width + startX), goal = static_cast<uint32_t>(goalY * width + goalX);
+    size_t startCluster = clusterOf(startX, startY), goalCluster = clusterOf(goalX, goalY);
+    vector<uint8_t> open;
+    vector<uint32_t> fromStart, toGoal;
+    loadCluster(startCluster, open);
+    searchCluster(open, localIndex(start), 0, fromStart, nullptr);
+    if (startCluster == goalCluster && fromStart[localIndex(goal)] != NO_STEPS) {
+        if (route != nullptr) {
+            route->push_back({startX, startY});
+            appendWalk(startCluster, start, goal, *route);
+        }
+        return static_cast<int>(fromStart[localIndex(goal)]);
+    }
+    loadCluster(goalCluster, open);
+    searchCluster(open, localIndex(goal), 0, toGoal, nullptr);
+
+    // A goal walled in within its cluster would make the search below flood the whole map
+    bool goalLinked = false;
+    for (const Node& node : clusters[goalCluster].nodes) {
+        goalLinked = goalLinked || toGoal[localIndex(node.cell)] != NO_STEPS;
+    }
+    if (!goalLinked) {
+        return -1;
+    }
+
+    // Search state lives in the nodes, stamped with the search it belongs to
+    searchCount++;
+    uint32_t goalCost = NO_STEPS, goalParent = START_ID;
+
+    // Keyed by f = cost + estimate, then by the larger cost, so among the many equally good
+    // nodes on an open map the search keeps following the one closest to the goal
+    typedef pair<uint64_t, uint64_t> Entry;
+    priority_queue<Entry, vector<Entry>, greater<Entry>> frontier;
+    auto key = [&](uint32_t cell, uint32_t cost) -> uint64_t {
+        uint64_t estimate = 0;
+        if (cell != GOAL_ID) {
+            estimate = static_cast<uint64_t>(abs(static_cast<int>(cell % width) - goalX) + abs(static_cast<int>(cell / width) - goalY));
+        }
+        return (cost + estimate) << 32 | (UINT32_MAX - cost);
+    };
+    auto relax = [&](size_t index, uint32_t node, uint32_t cost, uint32_t parent) {
+        Node& visit = clusters[index].nodes[node];
+        if (visit.searchId != searchCount) {
+            visit.searchId = searchCount;
+            visit.searchCost = NO_STEPS;
+            visit.searchClosed = false;
+        }
+        if (!visit.searchClosed && cost < visit.searchCost) {
+            visit.searchCost = cost;
+            visit.searchParent = parent;
+            frontier.push({key(visit.cell, cost), static_cast<uint64_t>(index) << 32 | node});
+        }
+    };
+    auto relaxAcross = [&](size_t index, uint32_t cell, uint32_t cost, uint32_t parent) {
+        int node = findNode(index, cell);
+        if (node >= 0) {
+            relax(index, static_cast<uint32_t>(node), cost, parent);
+        }
+    };
+
+    const vector<Node>& startNodes = clusters[startCluster].nodes;
+    for (size_t i = 0; i < startNodes.size(); i++) {
+        uint32_t steps = fromStart[localIndex(startNodes[i].cell)];
+        if (steps != NO_STEPS) {
+            relax(startCluster, static_cast<uint32_t>(i), steps, START_ID);
+        }
+    }
+    while (!frontier.empty()) {
+        Entry top = frontier.top();
+        frontier.pop();
+        if (top.second == UINT64_MAX) {
+            if (key(GOAL_ID, goalCost) == top.first) {
+                break;
+            }
+            continue;
+        }
+        size_t index = static_cast<size_t>(top.second >> 32);
+        uint32_t node = static_cast<uint32_t>(top.second);
+        Cluster& cluster = clusters[index];
+        Node& visit = cluster.nodes[node];
+        if (visit.searchClosed || key(visit.cell, visit.searchCost) != top.first) {
+            continue;  // Stale: the node was reached more cheaply since
+        }
+        visit.searchClosed = true;
+        uint32_t cell = visit.cell, cost = visit.searchCost;
+
+        if (index == goalCluster && toGoal[localIndex(cell)] != NO_STEPS && cost + toGoal[localIndex(cell)] < goalCost) {
+            goalCost = cost + toGoal[localIndex(cell)];
+            goalParent = cell;
+            frontier.push({key(GOAL_ID, goalCost), UINT64_MAX});
+        }
+        for (uint32_t e = cluster.edgeStart[node]; e < cluster.edgeStart[node + 1]; e++) {
+            relax(index, cluster.edges[e].to, cost + cluster.edges[e].cost, cell);
+        }
+        uint8_t links = visit.links;
+        if (links & 1) {
+            relaxAcross(index + 1, cell + 1, cost + 1, cell);
+        }
+        if (links & 2) {
+            relaxAcross(index + clustersX, cell + width, cost + 1, cell);
+        }
+        if (links & 4) {
+            relaxAcross(index - 1, cell - 1, cost + 1, cell);
+        }
+        if (links & 8) {
+            relaxAcross(index - clustersX, cell - width, cost + 1, cell);
+        }
+    }
+
+    if (goalCost == NO_STEPS) {
+        return -1;
+    }
+    if (route != nullptr) {
+        vector<uint32_t> waypoints = {goal};
+        for (uint32_t cell = goalParent; cell != START_ID;) {
+            waypoints.push_back(cell);
+            size_t index = clusterOf(cell);
+            cell = clusters[index].nodes[findNode(index, cell)].searchParent;
+        }
+        waypoints.push_back(start);
+        reverse(waypoints.begin(), waypoints.end());
+
+        route->push_back({startX, startY});
+        for (size_t i = 1; i < waypoints.size(); i++) {
+            uint32_t from = waypoints[i - 1], to = waypoints[i];
+            if (clusterOf(from) != clusterOf(to)) {
+                route->push_back({static_cast<int>(to % width), static_cast<int>(to / width)});
+            } else {
+                appendWalk(clusterOf(to), from, to, *route);
+            }
+        }
+    }
+    return static_cast<int>(goalCost);
+}
+
+/**
+ * @brief Gets the number of abstract nodes over all clusters.
+ */
+size_t PathHierarchy::getNodeCount() const {
+    size_t count = 0;
+    for (const Cluster& cluster : clusters) {
+        count += cluster.nodes.size();
+    }
+    return count;
+}
@@ -0,0 +1,192 @@
+/**
+ * @file PathHierarchy.h
+ * @brief Declaration of the PathHierarchy class, HPA*-style route finding over clusters of a map.
+ */
+
+#ifndef PATH_HIERARCHY_H
+#define PATH_HIERARCHY_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "mapgen.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+/**
+ * @class PathHierarchy
+ * @brief Abstract graph of a map's walkable cells, cut into square clusters, for routes on huge maps.
+ *
+ * Following HPA*, the map is split into clusters of clusterSize x clusterSize cells. Every
+ * run of walkable cells facing each other across a cluster border is an entrance; it gets
+ * one transition in its middle, or one at each end if it is long, and each transition adds
+ * a node on both sides of the border. Inside a cluster, nodes are linked by their walking
+ * distance within the cluster, found with a breadth-first search over its cells only.
+ *
+ * A route query connects the start and goal to the nodes of their clusters and runs A* over
+ * the abstract graph, which has a few nodes per cluster instead of a thousand cells. Routes
+ * are at most a few percent longer than the shortest ones, as usual for HPA*.
+ *
+ * Map edits are reported with markChanged(). Only the changed clusters rescan their borders,
+ * and only they and their four neighbours relink their nodes, so keeping the hierarchy
+ * current after an edit costs the same on an 8k x 8k map as on a small one. Walkability is
+ * read through Map::isWalkable, so both PATH maps and open-field maps work.
+ */
+class PathHierarchy {
+public:
+    /// Default side of a cluster in cells.
+    static const int DEFAULT_CLUSTER_SIZE = 32;
+
+private:
+    /**
+     * @struct Node
+     * @brief Transition cell of a cluster.
+     */
+    struct Node {
+        uint32_t cell;              ///< Cell index (y * width + x)
+        uint8_t links;              ///< Bit per direction with a transition across the border: 1 east, 2 south, 4 west, 8 north
+        bool searchClosed = false;  ///< Expanded by search searchId
+        uint32_t searchId = 0;      ///< Route search the fields below belong to
+        uint32_t searchCost = 0;    ///< Steps from the start in that search
+        uint32_t searchParent = 0;  ///< Previous cell on that search's route
+    };
+
+    /**
+     * @struct Edge
+     * @brief Walking distance between two nodes of a cluster.
+     */
+    struct Edge {
+        uint32_t to;     ///< Index of the other node in the cluster's node list
+        uint32_t cost;   ///< Steps between the two nodes, staying inside the cluster
+    };
+
+    /**
+     * @struct Cluster
+     * @brief Nodes of a cluster and the distances between them.
+     */
+    struct Cluster {
+        vector<Node> nodes;           ///< Transition cells, sorted by cell index
+        vector<uint32_t> edgeStart;   ///< Edges of node i are edges[edgeStart[i]] .. edges[edgeStart[i + 1] - 1]
+        vector<Edge> edges;           ///< Intra-cluster edges
+        vector<uint16_t> east;        ///< Rows (within the cluster) of the transitions across its east border
+        vector<uint16_t> south;       ///< Columns (within the cluster) of the transitions across its south border
+    };
+
+    const Map* map;                   ///< Map the hierarchy is built over
+    int width, height;                ///< Map size in cells
+    int clusterSize;                  ///< Side of a cluster in cells
+    int clustersX, clustersY;         ///< Number of clusters along each axis
+    vector<Cluster> clusters;         ///< Clusters in row-major order
+    vector<uint8_t> dirty;            ///< 1 for clusters with unprocessed changes
+    vector<uint32_t> dirtyClusters;   ///< Clusters with unprocessed changes
+    uint32_t searchCount;             ///< Route searches run so far; stamps the search state of the nodes
+
+    /**
+     * @brief Finds the transitions across a cluster's east and south borders.
+     * @param index Cluster index.
+     */
+    void scanBorders(size_t index);
+
+    /**
+     * @brief Collects a cluster's nodes from its own and its neighbours' borders and links them.
+     * @param index Cluster index.
+     */
+    void linkCluster(size_t index);
+
+    /**
+     * @brief Reads which cells of a cluster are walkable.
+     * @param index Cluster index.
+     * @param open Receives 1 for walkable cells, by local index; the frame around the cluster and cells past the map edge are 0.
+     */
+    void loadCluster(size_t index, vector<uint8_t>& open) const;
+
+    /**
+     * @brief Walks a cluster breadth-first from one cell, without leaving it.
+     * @param open Walkable cells of the cluster, from loadCluster(); targets are marked 2.
+     * @param from Local index of the cell to start from.
+     * @param targets Number of target cells after which to stop, or 0 to walk the whole cluster.
+     * @param steps Receives the steps to every cell reached, by local index; UINT32_MAX for the others.
+     * @param parents Receives the local index of each cell's predecessor, if not nullptr.
+     */
+    void searchCluster(const vector<uint8_t>& open, uint32_t from, size_t targets, vector<uint32_t>& steps,
+                       vector<uint32_t>* parents) const;
+
+    /**
+     * @brief Appends the cells of a walk inside a cluster to a route, from one cell to another.
+     * @param index Cluster index.
+     * @param from First cell; already on the route.
+     * @param to Last cell.
+     * @param route Route to extend.
+     */
+    void appendWalk(size_t index, uint32_t from, uint32_t to, vector<pair<int, int>>& route) const;
+
+    /**
+     * @brief Finds a node of a cluster by its cell.
+     * @param index Cluster index.
+     * @param cell Cell index.
+     * @return Index in the cluster's node list, or -1 if the cell is not a node.
+     */
+    int findNode(size_t index, uint32_t cell) const;
+
+    /** @brief Gets the cluster holding a cell. */
+    size_t clusterOf(int x, int y) const { return static_cast<size_t>(y / clusterSize) * clustersX + x / clusterSize; }
+
+    /** @brief Gets the cluster holding a cell index. */
+    size_t clusterOf(uint32_t cell) const { return clusterOf(static_cast<int>(cell % width), static_cast<int>(cell / width)); }
+
+    /** @brief Gets the index of a cell within its cluster, which is stored with a one-cell frame. */
+    uint32_t localIndex(uint32_t cell) const {
+        return (cell / width % clusterSize + 1) * (clusterSize + 2) + cell % width % clusterSize + 1;
+    }
+
+public:
+    /**
+     * @brief Builds the hierarchy of a map.
+     * @param map Map to route on; must outlive the hierarchy.
+     * @param clusterSize Side of a cluster in cells; 8 to 256.
+     * @param pool Worker pool to build the clusters in parallel, or nullptr.
+     */
+    explicit PathHierarchy(const Map& map, int clusterSize = DEFAULT_CLUSTER_SIZE, ThreadPool* pool = nullptr);
+
+    /**
+     * @brief Records that a cell may have changed walkability; applied by the next update().
+     * @param x X-coordinate of the cell.
+     * @param y Y-coordinate of the cell.
+     */
+    void markChanged(int x, int y);
+
+    /**
+     * @brief Rebuilds the changed clusters and relinks their neighbours.
+     * @param pool Worker pool to relink the clusters in parallel, or nullptr.
+     * @return Number of clusters relinked.
+     */
+    size_t update(ThreadPool* pool = nullptr);
+
+    /**
+     * @brief Finds a route between two cells, applying pending changes first.
+     *
+     * The search keeps its state in the nodes, so one hierarchy serves one query at a time.
+     * @param startX X-coordinate of the start.
+     * @param startY Y-coordinate of the start.
+     * @param goalX X-coordinate of the goal.
+     * @param goalY Y-coordinate of the goal.
+     * @param route Receives the cells of the route, start and goal included, if not nullptr.
+     * @return Length of the route in steps, or -1 if the goal cannot be reached.
+     */
+    int findRoute(int startX, int startY, int goalX, int goalY, vector<pair<int, int>>* route = nullptr);
+
+    /** @brief Gets the side of a cluster in cells. */
+    int getClusterSize() const { return clusterSize; }
+
+    /** @brief Gets the number of clusters. */
+    size_t getClusterCount() const { return clusters.size(); }
+
+    /** @brief Gets the number of abstract nodes over all clusters. */
+    size_t getNodeCount() const;
+
+    /** @brief Gets the number of clusters waiting for update(). */
+    size_t getDirtyCount() const { return dirtyClusters.size(); }
+};
+
+#endif // PATH_HIERARCHY_H
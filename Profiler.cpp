@@ -0,0 +1,215 @@
+/**
+ * @file Profiler.cpp
+ * @brief Implementation of the LatencyHistogram and Profiler classes.
+ */
+
+#include "Profiler.h"
+#include <cmath>
+#include <cstdio>
+
+/**
+ * @brief Constructs an empty histogram.
+ */
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+/**
+ * @brief Gets the bucket of a value.
+ *
+ * Values below SUB_BUCKETS map to themselves; above that, the bucket is given by the
+ * position of the highest set bit and the SUB_BUCKET_BITS bits below it.
+ */
+int LatencyHistogram::bucketOf(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+        return static_cast<int>(value);
+    }
+    int exponent = 63 - __builtin_clzll(value);
+    int shift = exponent - SUB_BUCKET_BITS;
+    return (shift + 1) * SUB_BUCKETS + static_cast<int>((value >> shift) & (SUB_BUCKETS - 1));
+}
+
+/**
+ * @brief Gets the smallest value that falls into a bucket.
+ */
+uint64_t LatencyHistogram::bucketStart(int bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return static_cast<uint64_t>(bucket);
+    }
+    int shift = bucket / SUB_BUCKETS - 1;
+    uint64_t mantissa = SUB_BUCKETS + bucket % SUB_BUCKETS;
+    return mantissa << shift;
+}
+
+/**
+ * @brief Gets the value at a percentile.
+ *
+ * @param percentile Percentile between 0 and 100.
+ * @return Start of the bucket holding that rank, or 0 if the histogram is empty.
+ */
+uint64_t LatencyHistogram::getPercentile(double percentile) const {
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(ceil(percentile / 100.0 * total));
+    rank = rank < 1 ? 1 : (rank > total ? total : rank);
+
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+        seen += counts[bucket];
+        if (seen >= rank) {
+            uint64_t value = bucketStart(bucket);
+            return value < maximum ? value : maximum;
+        }
+    }
+    return maximum;
+}
+
+/**
+ * @brief Forgets every recorded value.
+ */
+void LatencyHistogram::reset() {
+    counts.fill(0);
+    total = 0;
+    sum = 0;
+    maximum = 0;
+}
+
+/**
+ * @brief Constructs an empty profiler.
+ *
+ * @param keepTicks True to keep every measured tick's timings for export.
+ * @param sampleInterval Measure one tick out of this many.
+ */
+Profiler::Profiler(bool keepTicks, uint64_t sampleInterval)
+        : keepTicks(keepTicks), sampleInterval(sampleInterval > 0 ? sampleInterval : 1) {
+    currentRow.tick = 0;
+    currentRow.phases.fill(0);
+}
+
+/**
+ * @brief Records the duration of one phase.
+ *
+ * @param phase Measured phase; PHASE_TICK also closes the current row.
+ * @param nanoseconds Duration.
+ */
+void Profiler::record(ProfilePhase phase, uint64_t nanoseconds) {
+    histograms[phase].record(nanoseconds);
+    if (!keepTicks) {
+        return;
+    }
+
+    currentRow.phases[phase] += static_cast<uint32_t>(nanoseconds < UINT32_MAX ? nanoseconds : UINT32_MAX);
+    if (phase == PHASE_TICK) {
+        rows.push_back(currentRow);
+        currentRow.phases.fill(0);
+    }
+}
+
+/**
+ * @brief Gets the name of a phase as used in reports.
+ */
+const char* Profiler::getPhaseName(ProfilePhase phase) {
+    static const char* const NAMES[PHASE_COUNT] = {"spawn", "attack", "projectiles", "damage",
+                                                   "move", "cleanup", "render", "tick"};
+    return NAMES[phase];
+}
+
+/**
+ * @brief Forgets every recorded duration and row.
+ */
+void Profiler::reset() {
+    for (LatencyHistogram& histogram : histograms) {
+        histogram.reset();
+    }
+    rows.clear();
+    currentRow.phases.fill(0);
+}
+
+/**
+ * @brief Prints count, mean, p50, p99 and max of every phase that was measured.
+ *
+ * @param file Destination, e.g. stdout.
+ */
+void Profiler::printSummary(FILE* file) const {
+    fprintf(file, "%-12s %10s %10s %10s %10s %10s\n", "phase", "count", "mean_ns", "p50_ns", "p99_ns", "max_ns");
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        const LatencyHistogram& histogram = histograms[i];
+        if (histogram.getCount() == 0) {
+            continue;
+        }
+        fprintf(file, "%-12s %10llu %10.0f %10llu %10llu %10llu\n", getPhaseName(static_cast<ProfilePhase>(i)),
+                static_cast<unsigned long long>(histogram.getCount()), histogram.getMean(),
+                static_cast<unsigned long long>(histogram.getPercentile(50)),
+                static_cast<unsigned long long>(histogram.getPercentile(99)),
+                static_cast<unsigned long long>(histogram.getMax()));
+    }
+}
+
+/**
+ * @brief Writes the per-tick rows as CSV, one column per phase in nanoseconds.
+ *
+ * @param path File to write.
+ * @return True if the file was written.
+ */
+bool Profiler::writeCSV(const string& path) const {
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+
+    fprintf(file, "tick");
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        fprintf(file, ",%s_ns", getPhaseName(static_cast<ProfilePhase>(i)));
+    }
+    fprintf(file, "\n");
+
+    for (const TickRow& row : rows) {
+        fprintf(file, "%llu", static_cast<unsigned long long>(row.tick));
+        for (uint32_t value : row.phases) {
+            fprintf(file, ",%u", value);
+        }
+        fprintf(file, "\n");
+    }
+    return fclose(file) == 0;
+}
+
+/**
+ * @brief Writes the per-phase summary and the per-tick rows as JSON.
+ *
+ * @param path File to write.
+ * @return True if the file was written.
+ */
+bool Profiler::writeJSON(const string& path) const {
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+
+    fprintf(file, "{\n  \"phases\": {");
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        const LatencyHistogram& histogram = histograms[i];
+        fprintf(file, "%s\n    \"%s\": {\"count\": %llu, \"mean_ns\": %.1f, \"p50_ns\": %llu, \"p99_ns\": %llu, \"max_ns\": %llu}",
+                i > 0 ? "," : "", getPhaseName(static_cast<ProfilePhase>(i)),
+                static_cast<unsigned long long>(histogram.getCount()), histogram.getMean(),
+                static_cast<unsigned long long>(histogram.getPercentile(50)),
+                static_cast<unsigned long long>(histogram.getPercentile(99)),
+                static_cast<unsigned long long>(histogram.getMax()));
+    }
+    fprintf(file, "\n  },\n  \"sample_interval\": %llu,\n  \"columns\": [\"tick\"",
+            static_cast<unsigned long long>(sampleInterval));
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        fprintf(file, ", \"%s_ns\"", getPhaseName(static_cast<ProfilePhase>(i)));
+    }
+    fprintf(file, "],\n  \"ticks\": [");
+    for (size_t i = 0; i < rows.size(); i++) {
+        fprintf(file, "%s\n    [%llu", i > 0 ? "," : "", static_cast<unsigned long long>(rows[i].tick));
+        for (uint32_t value : rows[i].phases) {
+            fprintf(file, ", %u", value);
+        }
+        fprintf(file, "]");
+    }
+    fprintf(file, "\n  ]\n}\n");
+    return fclose(file) == 0;
+}
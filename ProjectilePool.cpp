@@ -0,0 +1,136 @@
+/**
+ * @file ProjectilePool.cpp
+ * @brief Implementation of the ProjectilePool class.
+ */
+
+#include "ProjectilePool.h"
+#include <algorithm>
+#include <cstdlib>
+
+/**
+ * @brief Constructs a pool that can hold up to capacity projectiles.
+ *
+ * @param capacity Maximum number of projectiles in flight.
+ * @param memory Memory resource the columns are allocated from.
+ */
+ProjectilePool::ProjectilePool(size_t capacity, pmr::memory_resource* memory)
+        : capacity(capacity), count(0), overflowCount(0),
+          targetIds(memory), damage(memory), originX(memory), originY(memory),
+          ticksLeft(memory), travelTicks(memory) {
+}
+
+/**
+ * @brief Makes room for one more projectile, doubling the columns when they are full.
+ *
+ * @return True if there is room, false if the pool is at capacity.
+ */
+bool ProjectilePool::reserveOne() {
+    if (count < targetIds.size()) {
+        return true;
+    }
+    if (count == capacity) {
+        return false;
+    }
+
+    size_t grown = min(capacity, max<size_t>(16, targetIds.size() * 2));
+    targetIds.resize(grown);
+    damage.resize(grown);
+    originX.resize(grown);
+    originY.resize(grown);
+    ticksLeft.resize(grown);
+    travelTicks.resize(grown);
+    return true;
+}
+
+/**
+ * @brief Advances every projectile by one tick and records the ones that land.
+ *
+ * Surviving projectiles are compacted towards the front of the columns in a single pass,
+ * keeping them in firing order.
+ *
+ * @param group Critter group used to resolve target identifiers to slots.
+ * @param hits Damage buffer of the current tick.
+ * @return Number of projectiles that landed on a live target.
+ */
+size_t ProjectilePool::advance(const CritterGroup& group, DamageBuffer& hits) {
+    size_t landed = 0;
+    size_t kept = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (--ticksLeft[i] == 0) {
+            int slot = group.findCritter(targetIds[i]);
+            if (slot >= 0 && static_cast<size_t>(slot) < hits.size()) {
+                hits.addHit(static_cast<size_t>(slot), damage[i]);
+                landed++;
+            }
+            continue;
+        }
+
+        if (kept != i) {
+            targetIds[kept] = targetIds[i];
+            damage[kept] = damage[i];
+            originX[kept] = originX[i];
+            originY[kept] = originY[i];
+            ticksLeft[kept] = ticksLeft[i];
+            travelTicks[kept] = travelTicks[i];
+        }
+        kept++;
+    }
+
+    count = kept;
+    return landed;
+}
+
+/**
+ * @brief Launches the shots recorded in a damage buffer during the attack phase.
+ *
+ * @param hits Damage buffer holding this tick's shots; also receives overflowing shots.
+ * @param critters Active critters the shot slots refer to.
+ */
+void ProjectilePool::launch(DamageBuffer& hits, ConstCritterSpan critters) {
+    for (const DamageBuffer::Shot& shot : hits.getShots()) {
+        if (!reserveOne()) {
+            hits.addHit(shot.slot, shot.damage);
+            overflowCount++;
+            continue;
+        }
+
+        const Critter& target = critters[shot.slot];
+        int distance = abs(target.getPosition().first - shot.originX) + abs(target.getPosition().second - shot.originY);
+        int flight = max(1, (distance + shot.speed - 1) / shot.speed);
+
+        targetIds[count] = target.getId();
+        damage[count] = shot.damage;
+        originX[count] = static_cast<int16_t>(shot.originX);
+        originY[count] = static_cast<int16_t>(shot.originY);
+        ticksLeft[count] = static_cast<uint16_t>(min(flight, 65535));
+        travelTicks[count] = ticksLeft[count];
+        count++;
+    }
+}
+
+/**
+ * @brief Adds a projectile that is already in flight.
+ *
+ * @param targetId Identifier of the targeted critter.
+ * @param amount Damage dealt on landing.
+ * @param fromX X-coordinate the shot was fired from.
+ * @param fromY Y-coordinate the shot was fired from.
+ * @param remaining Ticks until the shot lands.
+ * @param total Total flight time of the shot.
+ * @return True if the projectile was added, false if the pool is full.
+ */
+bool ProjectilePool::add(uint32_t targetId, int amount, int fromX, int fromY, int remaining, int total) {
+    if (!reserveOne()) {
+        return false;
+    }
+
+    targetIds[count] = targetId;
+    damage[count] = amount;
+    originX[count] = static_cast<int16_t>(fromX);
+    originY[count] = static_cast<int16_t>(fromY);
+    ticksLeft[count] = static_cast<uint16_t>(max(1, min(remaining, 65535)));
+    travelTicks[count] = static_cast<uint16_t>(max(static_cast<int>(ticksLeft[count]), min(total, 65535)));
+    count++;
+    return true;
+}
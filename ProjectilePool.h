@@ -0,0 +1,122 @@
+/**
+ * @file ProjectilePool.h
+ * @brief Declaration of the ProjectilePool class that tracks tower shots in flight.
+ */
+
+#ifndef PROJECTILE_POOL_H
+#define PROJECTILE_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+#include "critter.h"
+#include "CritterGroup.h"
+#include "DamageBuffer.h"
+
+using namespace std;
+
+/**
+ * @class ProjectilePool
+ * @brief Fixed-capacity, structure-of-arrays store for projectiles in flight.
+ *
+ * Columns grow geometrically up to the capacity and are never shrunk, so firing thousands of
+ * shots per second keeps memory flat while a game that fires little stays small.
+ * Projectiles target a critter by identifier rather than by slot, since slots shift as
+ * critters die or escape while the shot is travelling; a shot whose target is gone when it
+ * lands simply fizzles. All projectiles are advanced together once per tick.
+ */
+class ProjectilePool {
+private:
+    size_t capacity;             ///< Maximum number of projectiles in flight
+    size_t count;                ///< Number of projectiles currently in flight
+    size_t overflowCount;        ///< Shots resolved instantly because the pool was full
+    pmr::vector<uint32_t> targetIds;  ///< Identifier of the targeted critter
+    pmr::vector<int> damage;          ///< Damage dealt on landing
+    pmr::vector<int16_t> originX;     ///< X-coordinate the shot was fired from
+    pmr::vector<int16_t> originY;     ///< Y-coordinate the shot was fired from
+    pmr::vector<uint16_t> ticksLeft;  ///< Ticks until the shot lands
+    pmr::vector<uint16_t> travelTicks; ///< Total flight time of the shot
+
+    /**
+     * @brief Makes room for one more projectile.
+     * @return True if there is room, false if the pool is at capacity.
+     */
+    bool reserveOne();
+
+public:
+    /**
+     * @brief Constructs a pool that can hold up to capacity projectiles.
+     * @param capacity Maximum number of projectiles in flight.
+     * @param memory Memory resource the columns are allocated from.
+     */
+    explicit ProjectilePool(size_t capacity = 16384, pmr::memory_resource* memory = pmr::get_default_resource());
+
+    /**
+     * @brief Advances every projectile by one tick and records the ones that land.
+     *
+     * Landed projectiles are removed and their damage is added to the hits of the critter
+     * they were aimed at, if it is still active.
+     * @param group Critter group used to resolve target identifiers to slots.
+     * @param hits Damage buffer of the current tick.
+     * @return Number of projectiles that landed on a live target.
+     */
+    size_t advance(const CritterGroup& group, DamageBuffer& hits);
+
+    /**
+     * @brief Launches the shots recorded in a damage buffer during the attack phase.
+     *
+     * Travel time is the Manhattan distance to the target divided by the shot speed, and at
+     * least one tick. When the pool is full the shot is applied as an instant hit instead.
+     * @param hits Damage buffer holding this tick's shots; also receives overflowing shots.
+     * @param critters Active critters the shot slots refer to.
+     */
+    void launch(DamageBuffer& hits, ConstCritterSpan critters);
+
+    /**
+     * @brief Adds a projectile that is already in flight, e.g. when restoring a snapshot.
+     * @param targetId Identifier of the targeted critter.
+     * @param amount Damage dealt on landing.
+     * @param fromX X-coordinate the shot was fired from.
+     * @param fromY Y-coordinate the shot was fired from.
+     * @param remaining Ticks until the shot lands (at least 1).
+     * @param total Total flight time of the shot.
+     * @return True if the projectile was added, false if the pool is full.
+     */
+    bool add(uint32_t targetId, int amount, int fromX, int fromY, int remaining, int total);
+
+    /** @brief Removes every projectile in flight. */
+    void clear() { count = 0; }
+
+    /** @brief Gets the number of projectiles in flight. */
+    size_t size() const { return count; }
+
+    /** @brief Gets the maximum number of projectiles in flight. */
+    size_t getCapacity() const { return capacity; }
+
+    /** @brief Gets the number of shots that were applied instantly because the pool was full. */
+    size_t getOverflowCount() const { return overflowCount; }
+
+    /** @brief Gets the identifier of the critter targeted by projectile i. */
+    uint32_t getTargetId(size_t i) const { return targetIds[i]; }
+
+    /** @brief Gets the damage projectile i deals on landing. */
+    int getDamage(size_t i) const { return damage[i]; }
+
+    /** @brief Gets the ticks left before projectile i lands. */
+    int getTicksLeft(size_t i) const { return ticksLeft[i]; }
+
+    /** @brief Gets the total flight time of projectile i. */
+    int getTravelTicks(size_t i) const { return travelTicks[i]; }
+
+    /** @brief Gets the cell projectile i was fired from. */
+    pair<int, int> getOrigin(size_t i) const { return {originX[i], originY[i]}; }
+
+    /**
+     * @brief Gets how far projectile i has travelled.
+     * @return Fraction of the flight completed, from 0 (just fired) to 1 (landing).
+     */
+    float getProgress(size_t i) const { return 1.0f - static_cast<float>(ticksLeft[i]) / travelTicks[i]; }
+};
+
+#endif // PROJECTILE_POOL_H
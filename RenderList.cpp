@@ -0,0 +1,147 @@
+/**
+ * @file RenderList.cpp
+ * @brief Implementation of the RenderList class.
+ */
+
+#include "RenderList.h"
+
+/**
+ * @brief Builds the quad of a map tile.
+ */
+static inline RenderQuad tileQuad(int x, int y, float tile, bool path) {
+    RenderColor color = path ? RenderColor{150, 75, 0} : RenderColor{50, 205, 50};
+    return RenderQuad{x * tile, y * tile, tile, color, QUAD_SQUARE};
+}
+
+/**
+ * @brief Builds the quad of a tower standing on a cell.
+ */
+static inline RenderQuad towerQuad(int x, int y, float tile) {
+    return RenderQuad{x * tile + 5, y * tile + 5, tile - 10, RenderColor{0, 0, 255}, QUAD_DISC};
+}
+
+/**
+ * @brief Builds the quad of a critter standing on a cell.
+ */
+static inline RenderQuad critterQuad(int x, int y, float tile) {
+    return RenderQuad{x * tile + 8, y * tile + 8, tile - 16, RenderColor{255, 0, 0}, QUAD_DISC};
+}
+
+/**
+ * @brief Builds the quad of a projectile at a position given in cells.
+ */
+static inline RenderQuad projectileQuad(float x, float y, float tile) {
+    return RenderQuad{x * tile + tile / 2 - 4, y * tile + tile / 2 - 4, 8, RenderColor{255, 255, 0}, QUAD_DISC};
+}
+
+/**
+ * @brief Constructs an empty list.
+ *
+ * @param tileSize Size of a map tile in pixels.
+ */
+RenderList::RenderList(int tileSize)
+        : tileSize(tileSize), mapRevision(0), mapLayerValid(false), pixelWidth(0), pixelHeight(0) {
+}
+
+/**
+ * @brief Rebuilds the list from the game state.
+ *
+ * Colors and sizes match the original per-shape renderer: brown path, green scenery,
+ * blue towers, red critters and small yellow projectiles.
+ *
+ * @param map Game map; the map layer is only rebuilt if its revision changed.
+ * @param towers Placed towers.
+ * @param group Critter group whose active critters are drawn.
+ * @param projectiles Projectiles in flight.
+ * @return True if the map layer was rebuilt.
+ */
+bool RenderList::build(const Map& map, const TowerRegistry& towers, const CritterGroup& group,
+                       const ProjectilePool& projectiles) {
+    float tile = static_cast<float>(tileSize);
+    bool rebuilt = false;
+
+    if (!mapLayerValid || mapRevision != map.getRevision()) {
+        pixelWidth = map.getWidth() * tileSize;
+        pixelHeight = map.getHeight() * tileSize;
+        mapLayer.clear();
+        mapLayer.reserve(static_cast<size_t>(map.getWidth()) * map.getHeight());
+
+        for (int y = 0; y < map.getHeight(); y++) {
+            for (int x = 0; x < map.getWidth(); x++) {
+                mapLayer.push_back(tileQuad(x, y, tile, map.isPath(x, y)));
+            }
+        }
+
+        mapRevision = map.getRevision();
+        mapLayerValid = true;
+        rebuilt = true;
+    }
+
+    entities.clear();
+
+    for (Tower* tower : towers.getTowers()) {
+        entities.push_back(towerQuad(tower->getX(), tower->getY(), tile));
+    }
+
+    ConstCritterSpan critters = group.view();
+    for (const Critter& critter : critters) {
+        entities.push_back(critterQuad(critter.getPosition().first, critter.getPosition().second, tile));
+    }
+
+    // Projectiles sit between their tower and the current position of their target
+    for (size_t i = 0; i < projectiles.size(); i++) {
+        int target = group.findCritter(projectiles.getTargetId(i));
+        if (target < 0) continue;
+
+        pair<int, int> from = projectiles.getOrigin(i);
+        pair<int, int> to = critters[target].getPosition();
+        float t = projectiles.getProgress(i);
+        entities.push_back(projectileQuad(from.first + (to.first - from.first) * t,
+                                          from.second + (to.second - from.second) * t, tile));
+    }
+
+    return rebuilt;
+}
+
+/**
+ * @brief Rebuilds the list from a snapshot taken by the simulation thread.
+ *
+ * Produces the same quads as the live-state overload, so both backends draw identical frames.
+ *
+ * @param snapshot Drawable state; the map layer is only rebuilt if its map revision changed.
+ * @return True if the map layer was rebuilt.
+ */
+bool RenderList::build(const RenderSnapshot& snapshot) {
+    float tile = static_cast<float>(tileSize);
+    bool rebuilt = false;
+
+    if (!mapLayerValid || mapRevision != snapshot.getMapRevision()
+        || pixelWidth != snapshot.getWidth() * tileSize || pixelHeight != snapshot.getHeight() * tileSize) {
+        pixelWidth = snapshot.getWidth() * tileSize;
+        pixelHeight = snapshot.getHeight() * tileSize;
+        mapLayer.clear();
+        mapLayer.reserve(static_cast<size_t>(snapshot.getWidth()) * snapshot.getHeight());
+
+        for (int y = 0; y < snapshot.getHeight(); y++) {
+            for (int x = 0; x < snapshot.getWidth(); x++) {
+                mapLayer.push_back(tileQuad(x, y, tile, snapshot.getCell(x, y).path));
+            }
+        }
+
+        mapRevision = snapshot.getMapRevision();
+        mapLayerValid = true;
+        rebuilt = true;
+    }
+
+    entities.clear();
+    for (const SnapshotTower& tower : snapshot.getTowers()) {
+        entities.push_back(towerQuad(tower.x, tower.y, tile));
+    }
+    for (const SnapshotCritter& critter : snapshot.getCritters()) {
+        entities.push_back(critterQuad(critter.x, critter.y, tile));
+    }
+    for (const SnapshotProjectile& projectile : snapshot.getProjectiles()) {
+        entities.push_back(projectileQuad(projectile.x, projectile.y, tile));
+    }
+    return rebuilt;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file RenderList.h
+ * @brief Declaration of the RenderList class, the backend-independent description of a frame.
+ */
+
+#ifndef RENDER_LIST_H
+#define RENDER_LIST_H
+
+#include <cstdint>
+#include <vector>
+#include "mapgen.h"
+#include "CritterGroup.h"
+#include "TowerRegistry.h"
+#include "ProjectilePool.h"
+#include "RenderSnapshot.h"
+
+using namespace std;
+
+/**
+ * @struct RenderColor
+ * @brief 8-bit RGB color.
+ */
+struct RenderColor {
+    uint8_t r, g, b;
+};
+
+/**
+ * @enum QuadShape
+ * @brief How a quad is filled.
+ */
+enum QuadShape : uint8_t { QUAD_SQUARE, QUAD_DISC };
+
+/**
+ * @struct RenderQuad
+ * @brief One axis-aligned quad in pixel coordinates; discs are inscribed in their quad.
+ */
+struct RenderQuad {
+    float x, y;          ///< Top-left corner in pixels
+    float size;          ///< Side length in pixels
+    RenderColor color;   ///< Fill color
+    QuadShape shape;     ///< Square or disc
+};
+
+/**
+ * @class RenderList
+ * @brief Compact command list describing a frame, consumed by the SFML or software backends.
+ *
+ * The frame is split in two layers. The static map layer (one square per tile) only changes
+ * when the map does, so it is rebuilt only when the map's revision moves, i.e. after
+ * placeTower, removeTower or setPath. The entity layer (towers, critters, projectiles) is
+ * rebuilt every frame into a reused array of quads, without any per-object allocation.
+ */
+class RenderList {
+private:
+    int tileSize;                     ///< Size of a map tile in pixels
+    vector<RenderQuad> mapLayer;      ///< One quad per tile
+    vector<RenderQuad> entities;      ///< Towers, critters and projectiles
+    unsigned long long mapRevision;   ///< Map revision mapLayer was built from
+    bool mapLayerValid;               ///< False until mapLayer is built once
+    int pixelWidth, pixelHeight;      ///< Size of the frame in pixels
+
+public:
+    /**
+     * @brief Constructs an empty list.
+     * @param tileSize Size of a map tile in pixels.
+     */
+    explicit RenderList(int tileSize = 40);
+
+    /**
+     * @brief Rebuilds the list from the game state.
+     * @param map Game map; the map layer is only rebuilt if its revision changed.
+     * @param towers Placed towers.
+     * @param group Critter group whose active critters are drawn.
+     * @param projectiles Projectiles in flight.
+     * @return True if the map layer was rebuilt.
+     */
+    bool build(const Map& map, const TowerRegistry& towers, const CritterGroup& group, const ProjectilePool& projectiles);
+
+    /**
+     * @brief Rebuilds the list from a snapshot, e.g. on a render thread.
+     * @param snapshot Drawable state; the map layer is only rebuilt if its map revision changed.
+     * @return True if the map layer was rebuilt.
+     */
+    bool build(const RenderSnapshot& snapshot);
+
+    /** @brief Gets the static map layer. */
+    const vector<RenderQuad>& getMapLayer() const { return mapLayer; }
+
+    /** @brief Gets the entity layer. */
+    const vector<RenderQuad>& getEntities() const { return entities; }
+
+    /** @brief Gets the map revision the map layer was built from. */
+    unsigned long long getMapRevision() const { return mapRevision; }
+
+    /** @brief Gets the frame width in pixels. */
+    int getPixelWidth() const { return pixelWidth; }
+
+    /** @brief Gets the frame height in pixels. */
+    int getPixelHeight() const { return pixelHeight; }
+
+    /** @brief Gets the size of a tile in pixels. */
+    int getTileSize() const { return tileSize; }
+};
+
+#endif // RENDER_LIST_H
@@ -0,0 +1,75 @@
+/**
+ * @file RenderSnapshot.cpp
+ * @brief Implementation of the RenderSnapshot class.
+ */
+
+#include "RenderSnapshot.h"
+
+/**
+ * @brief Constructs an empty snapshot of a 0x0 map.
+ */
+RenderSnapshot::RenderSnapshot()
+        : width(0), height(0), mapRevision(0), cellsValid(false), tick(0), gold(0), health(0), wave(0),
+          gameOver(false) {
+}
+
+/**
+ * @brief Copies the drawable state of a game.
+ *
+ * Projectiles are resolved to positions here, while their targets can still be looked up,
+ * so the renderer needs no access to the critter group.
+ *
+ * @param sim Game to copy.
+ */
+void RenderSnapshot::capture(Simulation& sim) {
+    Map& map = sim.getMap();
+    if (!cellsValid || mapRevision != map.getRevision() || width != map.getWidth() || height != map.getHeight()) {
+        width = map.getWidth();
+        height = map.getHeight();
+        cells.clear();
+        cells.reserve(static_cast<size_t>(width) * height);
+        int basicRange = TowerCatalog::instance().get(BASIC_TOWER, 1).range;
+        int aoeRange = TowerCatalog::instance().get(AOE_TOWER, 1).range;
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                cells.push_back(SnapshotCell{map.isPath(x, y), static_cast<uint16_t>(map.getCoverage(x, y, basicRange)),
+                                             static_cast<uint16_t>(map.getCoverage(x, y, aoeRange))});
+            }
+        }
+        mapRevision = map.getRevision();
+        cellsValid = true;
+    }
+
+    towers.clear();
+    for (Tower* tower : sim.getTowers().getTowers()) {
+        towers.push_back(SnapshotTower{tower->getX(), tower->getY(), tower->getType(), tower->getLevel()});
+    }
+
+    ConstCritterSpan active = sim.getCritterView();
+    critters.clear();
+    for (const Critter& critter : active) {
+        pair<int, int> position = critter.getPosition();
+        critters.push_back(SnapshotCritter{position.first, position.second, critter.getHitPoints()});
+    }
+
+    // Projectiles sit between their tower and the current position of their target
+    const ProjectilePool& pool = sim.getProjectiles();
+    const CritterGroup& group = sim.getCritters();
+    projectiles.clear();
+    for (size_t i = 0; i < pool.size(); i++) {
+        int target = group.findCritter(pool.getTargetId(i));
+        if (target < 0) continue;
+
+        pair<int, int> from = pool.getOrigin(i);
+        pair<int, int> to = active[target].getPosition();
+        float t = pool.getProgress(i);
+        projectiles.push_back(SnapshotProjectile{from.first + (to.first - from.first) * t,
+                                                 from.second + (to.second - from.second) * t});
+    }
+
+    tick = sim.getTick();
+    gold = sim.getGold();
+    health = sim.getHealth();
+    wave = sim.getWave();
+    gameOver = sim.isGameOver();
+}
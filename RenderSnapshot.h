@@ -0,0 +1,134 @@
+/**
+ * @file RenderSnapshot.h
+ * @brief Declaration of the RenderSnapshot class, the part of the game state a renderer needs.
+ */
+
+#ifndef RENDER_SNAPSHOT_H
+#define RENDER_SNAPSHOT_H
+
+#include <cstdint>
+#include <vector>
+#include "Simulation.h"
+
+using namespace std;
+
+/**
+ * @struct SnapshotCell
+ * @brief Terrain of one map cell and how much path a tower there would cover.
+ */
+struct SnapshotCell {
+    bool path;                 ///< True if the cell is part of the critter path
+    uint16_t basicCoverage;    ///< Path cells within reach of a basic tower on this cell
+    uint16_t aoeCoverage;      ///< Path cells within reach of an AoE tower on this cell
+};
+
+/**
+ * @struct SnapshotTower
+ * @brief Position and kind of a placed tower.
+ */
+struct SnapshotTower {
+    int x, y;          ///< Cell of the tower
+    TowerType type;    ///< Basic or AoE
+    int level;         ///< Upgrade level, starting at 1
+};
+
+/**
+ * @struct SnapshotCritter
+ * @brief Position and health of an active critter.
+ */
+struct SnapshotCritter {
+    int x, y;          ///< Cell of the critter
+    int hitPoints;     ///< Remaining hit points
+};
+
+/**
+ * @struct SnapshotProjectile
+ * @brief Interpolated position of a projectile in flight, in cells.
+ */
+struct SnapshotProjectile {
+    float x, y;        ///< Position between the tower and its target
+};
+
+/**
+ * @class RenderSnapshot
+ * @brief Plain copy of what is drawn, taken by the simulation thread after its ticks.
+ *
+ * A renderer on another thread reads the snapshot instead of the live Simulation, so it never
+ * races with a tick. Only towers, critters and projectiles are copied every time; the map
+ * cells are recopied only when the map's revision moves. Vectors are cleared rather than
+ * freed, so snapshots that are captured into again (as in a TripleBuffer) stop allocating.
+ */
+class RenderSnapshot {
+private:
+    int width, height;                        ///< Map size in cells
+    unsigned long long mapRevision;           ///< Map revision the cells were copied from
+    bool cellsValid;                          ///< False until the cells are copied once
+    vector<SnapshotCell> cells;               ///< Row-major map cells
+    vector<SnapshotTower> towers;             ///< Placed towers
+    vector<SnapshotCritter> critters;         ///< Active critters
+    vector<SnapshotProjectile> projectiles;   ///< Projectiles whose target is still alive
+    uint64_t tick;                            ///< Tick the snapshot was taken after
+    int gold, health, wave;                   ///< Player resources and current wave
+    bool gameOver;                            ///< True if the player has lost
+
+public:
+    /** @brief Constructs an empty snapshot of a 0x0 map. */
+    RenderSnapshot();
+
+    /**
+     * @brief Copies the drawable state of a game.
+     * @param sim Game to copy; must not be stepped by another thread during the call.
+     */
+    void capture(Simulation& sim);
+
+    /** @brief Gets the map width in cells. */
+    int getWidth() const { return width; }
+
+    /** @brief Gets the map height in cells. */
+    int getHeight() const { return height; }
+
+    /** @brief Gets the map revision the cells were copied from. */
+    unsigned long long getMapRevision() const { return mapRevision; }
+
+    /**
+     * @brief Gets a map cell.
+     * @param x X-coordinate, which must be on the map.
+     * @param y Y-coordinate, which must be on the map.
+     * @return The cell.
+     */
+    const SnapshotCell& getCell(int x, int y) const { return cells[static_cast<size_t>(y) * width + x]; }
+
+    /**
+     * @brief Checks if a coordinate is on the map.
+     * @param x X-coordinate.
+     * @param y Y-coordinate.
+     * @return True if (x, y) is a cell of the map.
+     */
+    bool contains(int x, int y) const { return x >= 0 && y >= 0 && x < width && y < height; }
+
+    /** @brief Gets the placed towers. */
+    const vector<SnapshotTower>& getTowers() const { return towers; }
+
+    /** @brief Gets the active critters. */
+    const vector<SnapshotCritter>& getCritters() const { return critters; }
+
+    /** @brief Gets the projectiles in flight. */
+    const vector<SnapshotProjectile>& getProjectiles() const { return projectiles; }
+
+    /** @brief Gets the tick the snapshot was taken after. */
+    uint64_t getTick() const { return tick; }
+
+    /** @brief Gets the player's gold. */
+    int getGold() const { return gold; }
+
+    /** @brief Gets the player's health. */
+    int getHealth() const { return health; }
+
+    /** @brief Gets the current wave. */
+    int getWave() const { return wave; }
+
+    /** @brief Checks if the player has lost. */
+    bool isGameOver() const { return gameOver; }
+};
+
+#endif // RENDER_SNAPSHOT_H
@@ -0,0 +1,275 @@
+/**
+ * @file Replay.cpp
+ * @brief Implementation of replay recording, serialization and playback.
+ */
+
+#include "Replay.h"
+#include <chrono>
+#include <cstdio>
+#include "Snapshot.h"
+
+/// Identifies replay files and their layout version ("TDR" + version 6: tower catalog hash in the header).
+static const uint32_t REPLAY_MAGIC = 0x06524454;
+
+/**
+ * @brief Constructs an empty recording of a game played with the loaded tower catalog.
+ *
+ * @param config Configuration of the recorded game.
+ */
+Replay::Replay(const SimulationConfig& config)
+        : config(config), ticks(0), chain(CHAIN_SEED), catalogHash(TowerCatalog::instance().hash()) {
+}
+
+/**
+ * @brief Folds the state checksum of one tick into a checksum chain.
+ *
+ * @param chain Chain after the previous tick.
+ * @param stateChecksum Checksum of the state after this tick.
+ * @return Chain after this tick.
+ */
+uint64_t Replay::chainChecksum(uint64_t chain, uint64_t stateChecksum) {
+    // splitmix64 finalizer over the combined value
+    uint64_t z = chain ^ (stateChecksum + 0x9e3779b97f4a7c15ULL + (chain << 6) + (chain >> 2));
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief Records a command.
+ *
+ * @param command Command stamped with the tick it was applied before.
+ */
+void Replay::addCommand(const PlayerCommand& command) {
+    commands.push_back(command);
+}
+
+/**
+ * @brief Records the end of a tick.
+ *
+ * @param stateChecksum Checksum of the state after the tick.
+ */
+void Replay::recordTick(uint64_t stateChecksum) {
+    chain = chainChecksum(chain, stateChecksum);
+    ticks++;
+    if (ticks % CHECKSUM_INTERVAL == 0) {
+        checksums.push_back(static_cast<uint32_t>(chain));
+    }
+}
+
+/**
+ * @brief Serializes the recording.
+ *
+ * Layout: magic, the catalog hash as a raw little-endian word, varint configuration and tick count, the commands with varint tick deltas,
+ * then the stored checksums and the final chain as raw little-endian words.
+ *
+ * @param out Receives the encoded replay; cleared first.
+ */
+void Replay::encode(vector<uint8_t>& out) const {
+    out.clear();
+    SnapshotWriter writer(out);
+    writer.put<uint32_t>(REPLAY_MAGIC);
+    writer.put<uint64_t>(catalogHash);
+
+    putVarint(out, static_cast<uint32_t>(config.width));
+    putVarint(out, static_cast<uint32_t>(config.height));
+    putVarint(out, config.seed);
+    putVarint(out, static_cast<uint32_t>(config.startingGold));
+    putVarint(out, static_cast<uint32_t>(config.startingHealth));
+    putVarint(out, static_cast<uint32_t>(config.spawnInterval));
+    putVarint(out, static_cast<uint32_t>(config.spawnBatch));
+    putVarint(out, static_cast<uint32_t>(config.waveBase));
+    putVarint(out, static_cast<uint32_t>(config.waveGrowth));
+    putVarint(out, static_cast<uint32_t>(config.critterHitPoints));
+    putVarint(out, config.openField ? 1 : 0);
+    putVarint(out, config.windingPath ? 1 : 0);
+    putVarint(out, ticks);
+
+    putVarint(out, commands.size());
+    uint64_t previousTick = 0;
+    for (const PlayerCommand& command : commands) {
+        putVarint(out, command.tick - previousTick);
+        putVarint(out, command.type);
+        putVarint(out, command.towerType);
+        putVarint(out, static_cast<uint32_t>(command.x));
+        putVarint(out, static_cast<uint32_t>(command.y));
+        previousTick = command.tick;
+    }
+
+    putVarint(out, checksums.size());
+    writer.putColumn<uint32_t>(checksums.size(), [this](size_t i) { return checksums[i]; });
+    writer.put<uint64_t>(chain);
+}
+
+/**
+ * @brief Parses a serialized recording.
+ *
+ * @param in Encoded replay.
+ * @return True on success; on failure the replay is left unchanged.
+ */
+bool Replay::decode(const vector<uint8_t>& in) {
+    SnapshotReader header(in);
+    uint32_t magic = header.get<uint32_t>();
+    uint64_t catalogHash = header.get<uint64_t>();
+    if (!header.ok() || magic != REPLAY_MAGIC) {
+        return false;
+    }
+
+    size_t offset = sizeof(uint32_t) + sizeof(uint64_t);
+    bool ok = true;
+    auto next = [&]() {
+        uint64_t value = 0;
+        ok = ok && getVarint(in, offset, value);
+        return value;
+    };
+
+    Replay parsed;
+    parsed.catalogHash = catalogHash;
+    parsed.config.width = static_cast<int>(next());
+    parsed.config.height = static_cast<int>(next());
+    parsed.config.seed = static_cast<unsigned int>(next());
+    parsed.config.startingGold = static_cast<int>(next());
+    parsed.config.startingHealth = static_cast<int>(next());
+    parsed.config.spawnInterval = static_cast<int>(next());
+    parsed.config.spawnBatch = static_cast<int>(next());
+    parsed.config.waveBase = static_cast<int>(next());
+    parsed.config.waveGrowth = static_cast<int>(next());
+    parsed.config.critterHitPoints = static_cast<int>(next());
+    parsed.config.openField = next() != 0;
+    parsed.config.windingPath = next() != 0;
+    parsed.ticks = next();
+
+    uint64_t commandCount = next();
+    if (!ok || commandCount > in.size()) {
+        return false;
+    }
+    uint64_t tick = 0;
+    parsed.commands.resize(commandCount);
+    for (PlayerCommand& command : parsed.commands) {
+        tick += next();
+        command.tick = tick;
+        command.type = static_cast<CommandType>(next());
+        command.towerType = static_cast<TowerType>(next());
+        command.x = static_cast<int>(static_cast<uint32_t>(next()));
+        command.y = static_cast<int>(static_cast<uint32_t>(next()));
+    }
+
+    uint64_t checksumCount = next();
+    if (!ok || checksumCount != parsed.ticks / CHECKSUM_INTERVAL) {
+        return false;
+    }
+    vector<uint8_t> tail(in.begin() + offset, in.end());
+    SnapshotReader reader(tail);
+    parsed.checksums = reader.getColumn<uint32_t>(checksumCount);
+    parsed.chain = reader.get<uint64_t>();
+    if (!reader.ok()) {
+        return false;
+    }
+
+    *this = std::move(parsed);
+    return true;
+}
+
+/**
+ * @brief Writes the recording to a file.
+ *
+ * @param path File to write.
+ * @return True if the file was written.
+ */
+bool Replay::save(const string& path) const {
+    vector<uint8_t> bytes;
+    encode(bytes);
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    bool ok = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    return fclose(file) == 0 && ok;
+}
+
+/**
+ * @brief Reads a recording from a file.
+ *
+ * @param path File to read.
+ * @return True if the file was read and parsed.
+ */
+bool Replay::load(const string& path) {
+    vector<uint8_t> bytes;
+    return readSnapshotFile(path, bytes) && decode(bytes);
+}
+
+/**
+ * @brief Re-simulates a recording as fast as possible and checks it against its checksums.
+ *
+ * Every recorded command must apply successfully at its tick, including commands issued after
+ * the last recorded tick, and the chain must match at every stored checksum and at the end;
+ * the first failure stops the playback. At every stored checksum the incremental state hash
+ * is also compared with a full recomputation, which catches a missed hash update even when
+ * the recording has the same blind spot. A replay recorded with another tower catalog is not
+ * simulated at all.
+ *
+ * @param replay Recording to play.
+ * @param threads Threads of the attack phase.
+ * @return Outcome of the playback.
+ */
+ReplayResult playReplay(const Replay& replay, size_t threads) {
+    SimulationConfig config = replay.getConfig();
+    config.threads = threads;
+
+    ReplayResult result;
+    if (replay.getCatalogHash() != TowerCatalog::instance().hash()) {
+        result.matched = false;
+        result.catalogMatched = false;
+        return result;
+    }
+
+    auto start = chrono::steady_clock::now();
+    Simulation sim(config);
+    const vector<PlayerCommand>& commands = replay.getCommands();
+    const vector<uint32_t>& checksums = replay.getChecksums();
+    size_t nextCommand = 0;
+    uint64_t chain = Replay::CHAIN_SEED;
+
+    while (result.ticks < replay.getTickCount()) {
+        while (nextCommand < commands.size() && commands[nextCommand].tick == result.ticks) {
+            if (!sim.apply(commands[nextCommand++])) {
+                result.matched = false;
+            }
+        }
+        if (!result.matched || sim.isGameOver()) {
+            result.matched = false;
+            break;
+        }
+
+        sim.step();
+        chain = Replay::chainChecksum(chain, sim.stateHash());
+        result.ticks++;
+
+        if (result.ticks % Replay::CHECKSUM_INTERVAL == 0) {
+            if (sim.stateHash() != sim.recomputeStateHash()) {
+                result.hashConsistent = false;
+                result.matched = false;
+                break;
+            }
+            if (static_cast<uint32_t>(chain) != checksums[result.ticks / Replay::CHECKSUM_INTERVAL - 1]) {
+                result.matched = false;
+                break;
+            }
+            result.divergedAfter = result.ticks;
+        }
+    }
+
+    // Commands issued after the last tick, e.g. a tower bought just before quitting
+    while (result.matched && nextCommand < commands.size() && commands[nextCommand].tick == result.ticks) {
+        if (!sim.apply(commands[nextCommand++])) {
+            result.matched = false;
+        }
+    }
+    if (result.matched && (nextCommand != commands.size() || chain != replay.getFinalChain())) {
+        result.matched = false;
+    }
+    auto end = chrono::steady_clock::now();
+    result.elapsedMs = chrono::duration<double, milli>(end - start).count();
+    return result;
+}
@@ -0,0 +1,137 @@
+/**
+ * @file Replay.h
+ * @brief Declaration of the Replay class: input-only recordings of a game and their playback.
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Simulation.h"
+
+using namespace std;
+
+/**
+ * @class Replay
+ * @brief Recording of a game as its configuration plus the player's commands.
+ *
+ * The simulation is deterministic, so the seed and the commands are enough to rebuild every
+ * tick. To catch divergence, the Zobrist state hash of every tick is folded into a running chain
+ * and the chain is stored every CHECKSUM_INTERVAL ticks; a mismatch is thus pinned down to a
+ * window of that many ticks while an hour of play still fits in a few kilobytes. The hash of
+ * the tower catalog the game was played with is stored too, since the same commands play out
+ * differently with other tower stats.
+ */
+class Replay {
+private:
+    SimulationConfig config;         ///< Configuration the game was started with
+    vector<PlayerCommand> commands;  ///< Commands in the order they were applied
+    vector<uint32_t> checksums;      ///< Low 32 bits of the chain after every CHECKSUM_INTERVAL-th tick
+    uint64_t ticks;                  ///< Number of ticks recorded
+    uint64_t chain;                  ///< Running checksum chain
+    uint64_t catalogHash;            ///< TowerCatalog::hash() of the catalog the game was played with
+
+public:
+    /// Number of ticks between two stored checksums.
+    static const uint64_t CHECKSUM_INTERVAL = 64;
+
+    /// Initial value of the checksum chain.
+    static const uint64_t CHAIN_SEED = 0x9e3779b97f4a7c15ULL;
+
+    /**
+     * @brief Constructs an empty recording of a game played with the loaded tower catalog.
+     * @param config Configuration of the recorded game.
+     */
+    explicit Replay(const SimulationConfig& config = SimulationConfig());
+
+    /**
+     * @brief Folds the state checksum of one tick into a checksum chain.
+     * @param chain Chain after the previous tick.
+     * @param stateChecksum Simulation::stateHash() after this tick.
+     * @return Chain after this tick.
+     */
+    static uint64_t chainChecksum(uint64_t chain, uint64_t stateChecksum);
+
+    /**
+     * @brief Records a command; called by Simulation::apply.
+     * @param command Command stamped with the tick it was applied before.
+     */
+    void addCommand(const PlayerCommand& command);
+
+    /**
+     * @brief Records the end of a tick; called by Simulation::step.
+     * @param stateChecksum Checksum of the state after the tick.
+     */
+    void recordTick(uint64_t stateChecksum);
+
+    /**
+     * @brief Serializes the recording.
+     * @param out Receives the encoded replay; cleared first.
+     */
+    void encode(vector<uint8_t>& out) const;
+
+    /**
+     * @brief Parses a serialized recording.
+     * @param in Encoded replay.
+     * @return True on success; on failure the replay is left unchanged.
+     */
+    bool decode(const vector<uint8_t>& in);
+
+    /**
+     * @brief Writes the recording to a file.
+     * @param path File to write.
+     * @return True if the file was written.
+     */
+    bool save(const string& path) const;
+
+    /**
+     * @brief Reads a recording from a file.
+     * @param path File to read.
+     * @return True if the file was read and parsed.
+     */
+    bool load(const string& path);
+
+    /** @brief Gets the configuration of the recorded game. */
+    const SimulationConfig& getConfig() const { return config; }
+
+    /** @brief Gets the recorded commands. */
+    const vector<PlayerCommand>& getCommands() const { return commands; }
+
+    /** @brief Gets the stored checksums. */
+    const vector<uint32_t>& getChecksums() const { return checksums; }
+
+    /** @brief Gets the number of recorded ticks. */
+    uint64_t getTickCount() const { return ticks; }
+
+    /** @brief Gets the checksum chain after the last recorded tick. */
+    uint64_t getFinalChain() const { return chain; }
+
+    /** @brief Gets the hash of the tower catalog the game was played with. */
+    uint64_t getCatalogHash() const { return catalogHash; }
+};
+
+/**
+ * @struct ReplayResult
+ * @brief Outcome of replaying a recording.
+ */
+struct ReplayResult {
+    bool matched = true;         ///< True if the replay reproduced every stored checksum
+    bool catalogMatched = true;  ///< False if the loaded tower catalog is not the recorded one; nothing is simulated then
+    bool hashConsistent = true;  ///< False if the incremental state hash disagreed with Simulation::recomputeStateHash()
+    uint64_t ticks = 0;          ///< Ticks re-simulated
+    uint64_t divergedAfter = 0;  ///< If not matched: last tick known to match; divergence is within the next window
+    double elapsedMs = 0.0;      ///< Wall time spent re-simulating
+};
+
+/**
+ * @brief Re-simulates a recording as fast as possible and checks it against its checksums.
+ * @param replay Recording to play.
+ * @param threads Threads of the attack phase; the result does not depend on it.
+ * @return Outcome of the playback.
+ */
+ReplayResult playReplay(const Replay& replay, size_t threads = 1);
+
+#endif // REPLAY_H
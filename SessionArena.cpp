@@ -0,0 +1,116 @@
+/**
+ * @file SessionArena.cpp
+ * @brief Implementation of the SessionArena class.
+ */
+
+#include "SessionArena.h"
+#include <algorithm>
+
+/// Alignment of every small allocation; enough for any type the game's containers hold.
+static constexpr size_t ARENA_ALIGNMENT = alignof(max_align_t);
+
+/**
+ * @brief Constructs an empty arena.
+ *
+ * @param upstream Resource the blocks and large allocations come from.
+ */
+SessionArena::SessionArena(pmr::memory_resource* upstream)
+        : upstream(upstream), blocks(nullptr), cursor(nullptr), limit(nullptr), nextBlockSize(MIN_BLOCK_SIZE),
+          reserved(0) {
+    fill(begin(freeLists), end(freeLists), nullptr);
+}
+
+/**
+ * @brief Returns every block to the upstream resource.
+ */
+SessionArena::~SessionArena() {
+    while (blocks != nullptr) {
+        Block* next = blocks->next;
+        upstream->deallocate(blocks, blocks->size, ARENA_ALIGNMENT);
+        blocks = next;
+    }
+}
+
+/**
+ * @brief Gets the size class of a small request.
+ *
+ * @param bytes Requested size.
+ * @return Index of the smallest class that holds bytes.
+ */
+size_t SessionArena::sizeClass(size_t bytes) {
+    size_t index = 0;
+    while ((size_t(1) << (MIN_CLASS_SHIFT + index)) < bytes) {
+        index++;
+    }
+    return index;
+}
+
+/**
+ * @brief Allocates a new block, doubling the block size up to MAX_BLOCK_SIZE.
+ *
+ * The unused tail of the previous block is abandoned; it is at most one allocation's worth.
+ *
+ * @param classSize Size of the allocation that did not fit.
+ */
+void SessionArena::grow(size_t classSize) {
+    size_t header = (sizeof(Block) + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+    size_t size = max(nextBlockSize, header + classSize);
+    nextBlockSize = min(nextBlockSize * 2, MAX_BLOCK_SIZE);
+
+    Block* block = static_cast<Block*>(upstream->allocate(size, ARENA_ALIGNMENT));
+    block->next = blocks;
+    block->size = size;
+    blocks = block;
+    reserved += size;
+
+    cursor = reinterpret_cast<char*>(block) + header;
+    limit = reinterpret_cast<char*>(block) + size;
+}
+
+/**
+ * @brief Allocates memory from the free list of its class, the current block, or upstream.
+ *
+ * @param bytes Requested size.
+ * @param alignment Requested alignment.
+ * @return Pointer to the allocation.
+ */
+void* SessionArena::do_allocate(size_t bytes, size_t alignment) {
+    if (bytes > MAX_CLASS_SIZE || alignment > ARENA_ALIGNMENT) {
+        return upstream->allocate(bytes, alignment);
+    }
+
+    size_t index = sizeClass(bytes);
+    if (freeLists[index] != nullptr) {
+        FreeNode* node = freeLists[index];
+        freeLists[index] = node->next;
+        return node;
+    }
+
+    // Class sizes from 16 bytes up are multiples of the alignment, so the cursor stays aligned
+    size_t classSize = max(size_t(1) << (MIN_CLASS_SHIFT + index), ARENA_ALIGNMENT);
+    if (static_cast<size_t>(limit - cursor) < classSize) {
+        grow(classSize);
+    }
+    void* p = cursor;
+    cursor += classSize;
+    return p;
+}
+
+/**
+ * @brief Puts a small allocation on its class's free list, or returns a large one upstream.
+ *
+ * @param p Allocation to release.
+ * @param bytes Size it was allocated with.
+ * @param alignment Alignment it was allocated with.
+ */
+void SessionArena::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    if (bytes > MAX_CLASS_SIZE || alignment > ARENA_ALIGNMENT) {
+        upstream->deallocate(p, bytes, alignment);
+        return;
+    }
+
+    size_t index = sizeClass(bytes);
+    FreeNode* node = static_cast<FreeNode*>(p);
+    node->next = freeLists[index];
+    freeLists[index] = node;
+}
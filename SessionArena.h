@@ -0,0 +1,96 @@
+/**
+ * @file SessionArena.h
+ * @brief Declaration of the SessionArena class, the per-game memory resource of hosted games.
+ */
+
+#ifndef SESSION_ARENA_H
+#define SESSION_ARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+
+using namespace std;
+
+/**
+ * @class SessionArena
+ * @brief Single-threaded arena with size-class free lists, sized for one small game.
+ *
+ * Small requests (up to MAX_CLASS_SIZE bytes) are rounded up to a power of two and carved
+ * from blocks that start at MIN_BLOCK_SIZE and double up to MAX_BLOCK_SIZE, so an idle game
+ * costs one small block. Freed memory goes onto the free list of its size class and is
+ * reused in O(1) by the next request of that class; it is only returned to the upstream
+ * resource, all at once, when the arena is destroyed. Larger requests go straight upstream.
+ *
+ * Unlike pmr::unsynchronized_pool_resource there is no per-class chunk bookkeeping, which
+ * keeps both the footprint and the cost of a deallocation down for games whose containers
+ * hold a few dozen critters and towers.
+ */
+class SessionArena : public pmr::memory_resource {
+private:
+    static constexpr size_t MIN_CLASS_SHIFT = 4;       ///< Smallest size class: 16 bytes
+    static constexpr size_t CLASS_COUNT = 7;           ///< Size classes 16, 32, ..., 1024 bytes
+    static constexpr size_t MAX_CLASS_SIZE = size_t(1) << (MIN_CLASS_SHIFT + CLASS_COUNT - 1);
+    static constexpr size_t MIN_BLOCK_SIZE = 2048;     ///< Size of the first block
+    static constexpr size_t MAX_BLOCK_SIZE = 8192;     ///< Blocks stop doubling at this size
+
+    /**
+     * @struct Block
+     * @brief Header at the start of every block obtained from upstream.
+     */
+    struct Block {
+        Block* next;  ///< Previously allocated block
+        size_t size;  ///< Size of the block, header included
+    };
+
+    /**
+     * @struct FreeNode
+     * @brief Link stored inside a freed small allocation.
+     */
+    struct FreeNode {
+        FreeNode* next;  ///< Next free allocation of the same size class
+    };
+
+    pmr::memory_resource* upstream;    ///< Source of blocks and large allocations
+    Block* blocks;                     ///< Most recent block; earlier ones are chained behind it
+    char* cursor;                      ///< Next unused byte of the current block
+    char* limit;                       ///< End of the current block
+    size_t nextBlockSize;              ///< Size of the next block to allocate
+    size_t reserved;                   ///< Bytes held in blocks
+    FreeNode* freeLists[CLASS_COUNT];  ///< Freed allocations, per size class
+
+    /**
+     * @brief Gets the size class of a small request.
+     * @param bytes Requested size, at most MAX_CLASS_SIZE.
+     * @return Index into freeLists.
+     */
+    static size_t sizeClass(size_t bytes);
+
+    /**
+     * @brief Allocates a new block large enough for one allocation of a size class.
+     * @param classSize Size of the allocation that did not fit.
+     */
+    void grow(size_t classSize);
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+public:
+    /**
+     * @brief Constructs an empty arena; no memory is taken until the first allocation.
+     * @param upstream Resource the blocks and large allocations come from.
+     */
+    explicit SessionArena(pmr::memory_resource* upstream = pmr::new_delete_resource());
+
+    /** @brief Returns every block to the upstream resource. */
+    ~SessionArena() override;
+
+    SessionArena(const SessionArena&) = delete;
+    SessionArena& operator=(const SessionArena&) = delete;
+
+    /** @brief Gets the number of bytes held in blocks, used or free. */
+    size_t getReservedBytes() const { return reserved; }
+};
+
+#endif // SESSION_ARENA_H
@@ -0,0 +1,140 @@
+/**
+ * @file SessionHost.cpp
+ * @brief Implementation of the SessionHost class.
+ */
+
+#include "SessionHost.h"
+
+/**
+ * @brief Constructs an empty host.
+ *
+ * @param threads Worker threads stepping the games; 0 uses one per hardware thread.
+ */
+SessionHost::SessionHost(size_t threads)
+        : pool(threads), liveCount(0) {
+}
+
+/**
+ * @brief Gets the shared map of a level, generating it on first use.
+ *
+ * The level is laid out like a standalone game's, so a seed plays the same hosted or not.
+ * The heatmap is built before the map is handed out, so the games only ever read the
+ * shared terrain.
+ *
+ * @param config Configuration naming the level.
+ * @return Level map.
+ */
+const Map& SessionHost::getLevel(const SimulationConfig& config) {
+    unique_ptr<Map>& level = levels[LevelKey(config.seed, config.width, config.height, config.windingPath)];
+    if (!level) {
+        level = make_unique<Map>(config.width, config.height);
+        Simulation::generateLevel(config, *level, &pool);
+        level->setCoverageRanges(TowerCatalog::instance().getRanges());
+        level->prepareForSharing();
+    }
+    return *level;
+}
+
+/**
+ * @brief Starts a new game, reusing a free slot if there is one.
+ *
+ * @param config Parameters of the game.
+ * @return Handle to the game.
+ */
+SessionHandle SessionHost::open(const SimulationConfig& config) {
+    SimulationConfig sessionConfig = config;
+    sessionConfig.threads = 1;  // Parallelism comes from running many games at once
+
+    uint32_t index;
+    if (!freeSlots.empty()) {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        index = static_cast<uint32_t>(sessions.size());
+        sessions.emplace_back();
+        generations.push_back(0);
+    }
+
+    sessions[index] = make_unique<Session>(sessionConfig, getLevel(sessionConfig));
+    liveCount++;
+    return SessionHandle{index, generations[index]};
+}
+
+/**
+ * @brief Ends a game and releases its memory.
+ *
+ * @param handle Handle of the game.
+ * @return True if a game was closed, false if the handle is stale.
+ */
+bool SessionHost::close(SessionHandle handle) {
+    if (get(handle) == nullptr) {
+        return false;
+    }
+
+    sessions[handle.index].reset();
+    generations[handle.index]++;
+    freeSlots.push_back(handle.index);
+    liveCount--;
+    return true;
+}
+
+/**
+ * @brief Looks up the game behind a handle.
+ *
+ * @param handle Handle issued by open().
+ * @return Pointer to the game, or nullptr if it has been closed.
+ */
+Simulation* SessionHost::get(SessionHandle handle) {
+    if (handle.index >= sessions.size() || !sessions[handle.index] || generations[handle.index] != handle.generation) {
+        return nullptr;
+    }
+    return &sessions[handle.index]->sim;
+}
+
+/**
+ * @brief Applies a player command to a game.
+ *
+ * @param handle Handle of the game.
+ * @param command Command to apply.
+ * @return True if the command changed the game.
+ */
+bool SessionHost::apply(SessionHandle handle, const PlayerCommand& command) {
+    Simulation* sim = get(handle);
+    return sim != nullptr && sim->apply(command);
+}
+
+/**
+ * @brief Advances every open game that is not lost, in parallel.
+ *
+ * Games share nothing mutable, so each one is simply stepped by whichever thread picks it up.
+ *
+ * @param ticks Number of ticks to simulate per game.
+ * @return Number of games that were stepped.
+ */
+size_t SessionHost::stepAll(int ticks) {
+    vector<Simulation*> running;
+    running.reserve(liveCount);
+    for (const unique_ptr<Session>& session : sessions) {
+        if (session && !session->sim.isGameOver()) {
+            running.push_back(&session->sim);
+        }
+    }
+
+    pool.run(running.size(), [&running, ticks](size_t i) { running[i]->step(ticks); });
+    return running.size();
+}
+
+/**
+ * @brief Gets the bytes reserved by the arenas of all open games.
+ *
+ * @return Sum of SessionArena::getReservedBytes() over the open games.
+ */
+size_t SessionHost::getArenaBytes() const {
+    size_t total = 0;
+    for (const unique_ptr<Session>& session : sessions) {
+        if (session) {
+            total += session->arena.getReservedBytes();
+        }
+    }
+    return total;
+}
@@ -0,0 +1,146 @@
+/**
+ * @file SessionHost.h
+ * @brief Declaration of the SessionHost class that runs many independent games in one process.
+ */
+
+#ifndef SESSION_HOST_H
+#define SESSION_HOST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+#include "Simulation.h"
+#include "SessionArena.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+/**
+ * @struct SessionHandle
+ * @brief Generational reference to a game hosted by a SessionHost.
+ *
+ * Works like TowerHandle: once the session is closed its slot's generation changes and old
+ * handles stop resolving, even after the slot is reused by a new game.
+ */
+struct SessionHandle {
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    uint32_t index = INVALID_INDEX; ///< Slot index inside the host
+    uint32_t generation = 0;        ///< Generation of the slot when the handle was issued
+
+    /** @brief Checks if the handle was ever issued by a host. */
+    bool isValid() const { return index != INVALID_INDEX; }
+
+    bool operator==(const SessionHandle& other) const {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const SessionHandle& other) const { return !(*this == other); }
+};
+
+/**
+ * @class SessionHost
+ * @brief Hosts thousands of concurrent games and steps them over a worker pool.
+ *
+ * Games on the same level (seed and map size) start from one shared level map: its terrain
+ * and coverage heatmap are built once and shared copy-on-write, while each game only owns
+ * its tower overlay, critters and projectiles. Those per-game containers allocate from the
+ * game's own SessionArena, which is released in one piece when the game is closed, so
+ * games neither contend on the global heap nor fragment it for each other.
+ *
+ * Every game runs its ticks on a single thread; stepAll() hands the games out to the pool's
+ * threads one at a time. Creating, closing and commanding games is done between steps, from
+ * the thread that owns the host.
+ */
+class SessionHost {
+private:
+    /**
+     * @struct Session
+     * @brief One hosted game and the arena it allocates from.
+     */
+    struct Session {
+        SessionArena arena;  ///< Per-game allocator; declared first so it outlives the game
+        Simulation sim;      ///< The game
+
+        Session(const SimulationConfig& config, const Map& level) : sim(config, level, &arena) {}
+    };
+
+    /// Identifies a level: seed, width, height and whether the path winds.
+    typedef tuple<unsigned int, int, int, bool> LevelKey;
+
+    ThreadPool pool;                              ///< Workers stepping the games
+    map<LevelKey, unique_ptr<Map>> levels;        ///< Shared level maps, generated on first use
+    vector<unique_ptr<Session>> sessions;         ///< Session slots; nullptr while free
+    vector<uint32_t> generations;                 ///< Generation of each slot, bumped on close
+    vector<uint32_t> freeSlots;                   ///< Indices of free slots
+    size_t liveCount;                             ///< Number of open sessions
+
+    /**
+     * @brief Gets the shared map of a level, generating it on first use.
+     * @param config Configuration naming the level.
+     * @return Level map, ready to be shared between threads.
+     */
+    const Map& getLevel(const SimulationConfig& config);
+
+public:
+    /**
+     * @brief Constructs an empty host.
+     * @param threads Worker threads stepping the games; 0 uses one per hardware thread.
+     */
+    explicit SessionHost(size_t threads = 0);
+
+    SessionHost(const SessionHost&) = delete;
+    SessionHost& operator=(const SessionHost&) = delete;
+
+    /**
+     * @brief Starts a new game.
+     * @param config Parameters of the game; its threads field is ignored, each game uses one thread.
+     * @return Handle to the game.
+     */
+    SessionHandle open(const SimulationConfig& config);
+
+    /**
+     * @brief Ends a game and releases its memory.
+     * @param handle Handle of the game.
+     * @return True if a game was closed, false if the handle is stale.
+     */
+    bool close(SessionHandle handle);
+
+    /**
+     * @brief Looks up the game behind a handle.
+     * @param handle Handle issued by open().
+     * @return Pointer to the game, or nullptr if it has been closed.
+     */
+    Simulation* get(SessionHandle handle);
+
+    /**
+     * @brief Applies a player command to a game.
+     * @param handle Handle of the game.
+     * @param command Command to apply.
+     * @return True if the command changed the game, false if it was rejected or the handle is stale.
+     */
+    bool apply(SessionHandle handle, const PlayerCommand& command);
+
+    /**
+     * @brief Advances every open game that is not lost, in parallel.
+     * @param ticks Number of ticks to simulate per game.
+     * @return Number of games that were stepped.
+     */
+    size_t stepAll(int ticks = 1);
+
+    /** @brief Gets the number of open games. */
+    size_t size() const { return liveCount; }
+
+    /** @brief Gets the number of distinct levels generated so far. */
+    size_t getLevelCount() const { return levels.size(); }
+
+    /** @brief Gets the bytes reserved by the arenas of all open games. */
+    size_t getArenaBytes() const;
+
+    /** @brief Gets the number of threads stepping the games. */
+    size_t getThreadCount() const { return pool.size(); }
+};
+
+#endif // SESSION_HOST_H
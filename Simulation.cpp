@@ -0,0 +1,544 @@
+/**
+ * @file Simulation.cpp
+ * @brief Implementation of the Simulation class.
+ */
+
+#include "Simulation.h"
+#include "MapGenerator.h"
+#include "Replay.h"
+#include "Logger.h"
+#include "Zobrist.h"
+
+/**
+ * @brief Starts a new game: generates the map from the seed and queues the first wave.
+ *
+ * @param config Parameters of the game.
+ */
+Simulation::Simulation(const SimulationConfig& config)
+        : config(config), map(config.width, config.height), critters(&map), towers(&map), recorder(nullptr), profiler(nullptr),
+          tick(0), ticksUntilSpawn(0), gold(config.startingGold), health(config.startingHealth), kills(0), leaks(0) {
+    // Winding candidates are scored on the game's worker pool, which start() would create anyway
+    if (config.windingPath && config.threads > 1) {
+        pool = make_unique<ThreadPool>(config.threads);
+    }
+    generateLevel(config, map, pool.get());
+    start();
+}
+
+/**
+ * @brief Lays out the level of a game from its seed and size.
+ *
+ * Standalone games and SessionHost levels both come from here, so a seed gives the same
+ * game whoever hosts it.
+ *
+ * @param config Parameters of the game.
+ * @param map Map to lay the level out on.
+ * @param pool Worker pool to score winding candidates on, or nullptr.
+ */
+void Simulation::generateLevel(const SimulationConfig& config, Map& map, ThreadPool* pool) {
+    if (!config.windingPath) {
+        map.generateRandomMap(config.seed);
+        return;
+    }
+    int range = TowerCatalog::instance().get(BASIC_TOWER, 1).range;
+    MapGenerator generator(config.width, config.height, MapGenerator::defaultConstraints(config.width, config.height, range));
+    if (!generator.generate(map, config.seed, MapGenerator::DEFAULT_CANDIDATES, pool)) {
+        TD_LOG_WARN("No winding map for seed %u meets every constraint; using the closest one", config.seed);
+    }
+}
+
+/**
+ * @brief Starts a new game on an already generated level.
+ *
+ * @param config Parameters of the game.
+ * @param level Map to start from; its terrain is shared, not copied.
+ * @param memory Memory resource of the game's containers.
+ */
+Simulation::Simulation(const SimulationConfig& config, const Map& level, pmr::memory_resource* memory)
+        : config(config), map(level), critters(&map, memory), towers(&map, memory), hits(memory),
+          projectiles(16384, memory), recorder(nullptr), profiler(nullptr), tick(0), ticksUntilSpawn(0),
+          gold(config.startingGold), health(config.startingHealth), kills(0), leaks(0) {
+    start();
+}
+
+/**
+ * @brief Creates the attack worker pool, if any, and queues the first wave.
+ *
+ * The coverage heatmap follows the ranges of the loaded catalog; for a level prepared with
+ * the same catalog this changes nothing, so its terrain stays shared.
+ */
+void Simulation::start() {
+    if (config.threads > 1 && !pool) {
+        pool = make_unique<ThreadPool>(config.threads);
+    }
+    map.setCoverageRanges(TowerCatalog::instance().getRanges());
+    if (config.openField) {
+        map.setOpenField(true);
+    }
+    if (config.openField || config.windingPath) {
+        // Critters on a winding path double back, which the straight-ahead walk cannot follow
+        distances.build(map);
+        critters.setDistanceField(&distances);
+    }
+    critters.setWaveShape(config.waveBase, config.waveGrowth, config.critterHitPoints);
+    critters.generateWave();
+}
+
+/**
+ * @brief Closes a cell of an open-field map for a new tower, unless that walls critters in.
+ *
+ * Only the distances that depend on the cell are repaired, and undoing a rejected placement
+ * repairs them back, so the check costs two small repairs and a pass over the critters.
+ *
+ * @param x X-coordinate of the cell.
+ * @param y Y-coordinate of the cell.
+ * @return True if the cell stays closed.
+ */
+bool Simulation::closeRouteCell(int x, int y) {
+    for (const Critter& critter : critters.view()) {
+        if (critter.getPosition() == make_pair(x, y)) {
+            TD_LOG_WARN("Cannot place a tower on a critter!");
+            return false;
+        }
+    }
+
+    distances.setBlocked(x, y, true);
+    bool open = distances.getDistance(map.getEntry().first, map.getEntry().second) >= 0;
+    for (const Critter& critter : critters.view()) {
+        if (!open) {
+            break;
+        }
+        open = distances.getDistance(critter.getPosition().first, critter.getPosition().second) >= 0;
+    }
+    if (!open) {
+        distances.setBlocked(x, y, false);
+        TD_LOG_WARN("Cannot block the critters' only route!");
+    }
+    return open;
+}
+
+/**
+ * @brief Advances the game.
+ *
+ * @param ticks Number of ticks to simulate; stops early if the game is lost.
+ */
+void Simulation::step(int ticks) {
+    for (int i = 0; i < ticks && !isGameOver(); i++) {
+        stepOnce();
+        if (recorder != nullptr) {
+            recorder->recordTick(stateHash());
+        }
+    }
+}
+
+/**
+ * @brief Runs a single tick: spawn, attack, projectiles, damage, movement, wave progression.
+ */
+void Simulation::stepOnce() {
+#ifdef TD_ENABLE_PROFILING
+    Profiler* sampled = profiler != nullptr && profiler->beginTick(tick) ? profiler : nullptr;
+#endif
+    TD_PROFILE_SCOPE(sampled, PHASE_TICK);
+    int killsBefore = kills;
+    int leaksBefore = leaks;
+
+    {
+        TD_PROFILE_SCOPE(sampled, PHASE_SPAWN);
+        if (--ticksUntilSpawn <= 0) {
+            bool spawned = false;
+            for (int i = 0; i < config.spawnBatch && critters.spawnNextCritter(); i++) {
+                spawned = true;
+            }
+            if (spawned) {
+                ticksUntilSpawn = config.spawnInterval;
+            }
+        }
+    }
+
+    // Towers choose targets against a frozen view of the critters, then damage is resolved
+    {
+        TD_PROFILE_SCOPE(sampled, PHASE_ATTACK);
+        towers.attackAll(critters.view(), hits, pool.get());
+    }
+    {
+        TD_PROFILE_SCOPE(sampled, PHASE_PROJECTILES);
+        projectiles.advance(critters, hits);
+        projectiles.launch(hits, critters.view());
+    }
+    {
+        TD_PROFILE_SCOPE(sampled, PHASE_DAMAGE);
+        critters.applyDamage(hits, [this](int reward) {
+            gold += reward;
+            kills++;
+        });
+    }
+    {
+        TD_PROFILE_SCOPE(sampled, PHASE_MOVE);
+        critters.moveAllCritters([this](int strength) {
+            health -= strength;
+            leaks++;
+        });
+    }
+
+    TD_LOG_DEBUG("Tick %llu: %zu hits, %d kills, %d leaks, %zu critters, %zu projectiles in flight",
+                 static_cast<unsigned long long>(tick), hits.getHitCount(), kills - killsBefore, leaks - leaksBefore,
+                 critters.view().size(), projectiles.size());
+
+    {
+        TD_PROFILE_SCOPE(sampled, PHASE_CLEANUP);
+        if (critters.isWaveComplete()) {
+            projectiles.clear();
+            critters.generateWave();
+        }
+    }
+
+    tick++;
+}
+
+/**
+ * @brief Buys a tower and places it on the map.
+ *
+ * @param type Type of tower to buy.
+ * @param x X-coordinate of the tower.
+ * @param y Y-coordinate of the tower.
+ * @return Handle to the new tower, or an invalid handle if the placement or purchase failed.
+ */
+TowerHandle Simulation::buyTower(TowerType type, int x, int y) {
+    TowerHandle handle = towers.place(type, x, y);
+    Tower* tower = towers.get(handle);
+    if (tower == nullptr) {
+        return TowerHandle();
+    }
+
+    if (tower->getBuyCost() > gold || (config.openField && !closeRouteCell(x, y))) {
+        towers.remove(handle);
+        return TowerHandle();
+    }
+
+    gold -= tower->getBuyCost();
+    return handle;
+}
+
+/**
+ * @brief Sells a tower and refunds its value.
+ *
+ * @param handle Handle of the tower.
+ * @return Gold refunded, or 0 if the handle is stale.
+ */
+int Simulation::sellTower(TowerHandle handle) {
+    Tower* tower = towers.get(handle);
+    if (tower == nullptr) {
+        return 0;
+    }
+
+    int x = tower->getX(), y = tower->getY();
+    int refund = towers.sell(handle);
+    if (config.openField) {
+        distances.setBlocked(x, y, false);
+    }
+    gold += refund;
+    return refund;
+}
+
+/**
+ * @brief Pays for a tower upgrade.
+ *
+ * @param handle Handle of the tower.
+ * @return True if the tower was upgraded, false otherwise.
+ */
+bool Simulation::upgradeTower(TowerHandle handle) {
+    Tower* tower = towers.get(handle);
+    if (tower == nullptr || tower->getUpgradeCost() > gold) {
+        return false;
+    }
+
+    int cost = tower->getUpgradeCost();
+    if (!towers.upgrade(handle)) {
+        return false;
+    }
+    gold -= cost;
+    return true;
+}
+
+/**
+ * @brief Applies a player command at the current tick.
+ *
+ * @param command Command to apply; its tick field is ignored.
+ * @return True if the command changed the game.
+ */
+bool Simulation::apply(const PlayerCommand& command) {
+    bool applied = false;
+    switch (command.type) {
+        case COMMAND_PLACE:
+            applied = buyTower(command.towerType, command.x, command.y).isValid();
+            break;
+        case COMMAND_SELL:
+            applied = sellTower(towers.findAt(command.x, command.y)) > 0;
+            break;
+        case COMMAND_UPGRADE:
+            applied = upgradeTower(towers.findAt(command.x, command.y));
+            break;
+    }
+
+    if (applied && recorder != nullptr) {
+        PlayerCommand stamped = command;
+        stamped.tick = tick;
+        recorder->addCommand(stamped);
+    }
+    return applied;
+}
+
+/**
+ * @brief Gets the Zobrist hash of the game state.
+ *
+ * @return 64-bit Zobrist hash of the state.
+ */
+uint64_t Simulation::stateHash() const {
+    return map.getZobrist() ^ towers.getZobrist() ^ critters.getZobrist() ^ counterHash();
+}
+
+/**
+ * @brief Recomputes the Zobrist hash of the game state from scratch.
+ *
+ * Uses the same keys as stateHash(), but derives every one from the current objects.
+ *
+ * @return 64-bit Zobrist hash of the state.
+ */
+uint64_t Simulation::recomputeStateHash() const {
+    uint64_t hash = map.computeZobrist() ^ critters.computeZobrist() ^ counterHash();
+    for (Tower* tower : towers.getTowers()) {
+        hash ^= tower->zobristKey();
+    }
+    return hash;
+}
+
+/**
+ * @brief Gets the Zobrist keys of the counters and the projectiles.
+ *
+ * @return XOR of their keys.
+ */
+uint64_t Simulation::counterHash() const {
+    uint64_t hash = zobristKey(ZOBRIST_SCALAR, 0, tick);
+    hash ^= zobristKey(ZOBRIST_SCALAR, 1, static_cast<uint32_t>(ticksUntilSpawn));
+    hash ^= zobristKey(ZOBRIST_SCALAR, 2, static_cast<uint32_t>(gold));
+    hash ^= zobristKey(ZOBRIST_SCALAR, 3, static_cast<uint32_t>(health));
+    hash ^= zobristKey(ZOBRIST_SCALAR, 4, static_cast<uint32_t>(kills));
+    hash ^= zobristKey(ZOBRIST_SCALAR, 5, static_cast<uint32_t>(leaks));
+    hash ^= zobristKey(ZOBRIST_SCALAR, 6, static_cast<uint32_t>(critters.getCurrentWave()));
+    hash ^= zobristKey(ZOBRIST_SCALAR, 7, critters.getRemainingSpawns());
+
+    for (size_t i = 0; i < projectiles.size(); i++) {
+        hash ^= zobristKey(ZOBRIST_PROJECTILE, i,
+                           (static_cast<uint64_t>(projectiles.getTargetId(i)) << 32) | projectiles.getTicksLeft(i));
+    }
+    return hash;
+}
+
+/// Identifies snapshot files and their layout version ("TDS" + version 1).
+static const uint32_t SNAPSHOT_MAGIC = 0x01534454;
+
+/**
+ * @brief Serializes the complete game state into a compact binary snapshot.
+ *
+ * Every per-object field is written as a column, which keeps consecutive snapshots similar
+ * and makes them cheap to delta-encode.
+ *
+ * @param out Receives the snapshot; cleared first.
+ */
+void Simulation::saveSnapshot(vector<uint8_t>& out) const {
+    const pmr::deque<Critter>& spawns = critters.getSpawnQueue();
+    ConstCritterSpan active = critters.view();
+    const pmr::vector<Tower*>& placed = towers.getTowers();
+    int cells = map.getWidth() * map.getHeight();
+
+    out.clear();
+    out.reserve(64 + cells + placed.size() * 10 + active.size() * 32 + spawns.size() * 28 + projectiles.size() * 14);
+    SnapshotWriter writer(out);
+
+    writer.put<uint32_t>(SNAPSHOT_MAGIC);
+    writer.put<int32_t>(map.getWidth());
+    writer.put<int32_t>(map.getHeight());
+    writer.put<uint32_t>(config.seed);
+    writer.put<uint64_t>(tick);
+    writer.put<int32_t>(ticksUntilSpawn);
+    writer.put<int32_t>(gold);
+    writer.put<int32_t>(health);
+    writer.put<int32_t>(kills);
+    writer.put<int32_t>(leaks);
+
+    // Map
+    writer.put<int32_t>(map.getEntry().first);
+    writer.put<int32_t>(map.getEntry().second);
+    writer.put<int32_t>(map.getExit().first);
+    writer.put<int32_t>(map.getExit().second);
+    int width = map.getWidth();
+    writer.putColumn<uint8_t>(cells, [&](size_t i) { return map.isPath(i % width, i / width) ? PATH : SCENERY; });
+
+    // Towers
+    writer.put<uint32_t>(static_cast<uint32_t>(placed.size()));
+    writer.putColumn<uint8_t>(placed.size(), [&](size_t i) { return placed[i]->getType(); });
+    writer.putColumn<int16_t>(placed.size(), [&](size_t i) { return placed[i]->getX(); });
+    writer.putColumn<int16_t>(placed.size(), [&](size_t i) { return placed[i]->getY(); });
+    writer.putColumn<uint8_t>(placed.size(), [&](size_t i) { return placed[i]->getLevel(); });
+
+    // Critters
+    writer.put<int32_t>(critters.getCurrentWave());
+    writer.put<uint32_t>(critters.getNextCritterId());
+    writer.put<uint32_t>(static_cast<uint32_t>(active.size()));
+    writer.putColumn<uint32_t>(active.size(), [&](size_t i) { return active[i].getId(); });
+    writer.putColumn<int32_t>(active.size(), [&](size_t i) { return active[i].getHitPoints(); });
+    writer.putColumn<int32_t>(active.size(), [&](size_t i) { return active[i].getStrength(); });
+    writer.putColumn<int32_t>(active.size(), [&](size_t i) { return active[i].getSpeed(); });
+    writer.putColumn<int32_t>(active.size(), [&](size_t i) { return active[i].getLevel(); });
+    writer.putColumn<int32_t>(active.size(), [&](size_t i) { return active[i].getReward(); });
+    writer.putColumn<int16_t>(active.size(), [&](size_t i) { return active[i].getPosition().first; });
+    writer.putColumn<int16_t>(active.size(), [&](size_t i) { return active[i].getPosition().second; });
+
+    writer.put<uint32_t>(static_cast<uint32_t>(spawns.size()));
+    writer.putColumn<int32_t>(spawns.size(), [&](size_t i) { return spawns[i].getHitPoints(); });
+    writer.putColumn<int32_t>(spawns.size(), [&](size_t i) { return spawns[i].getStrength(); });
+    writer.putColumn<int32_t>(spawns.size(), [&](size_t i) { return spawns[i].getSpeed(); });
+    writer.putColumn<int32_t>(spawns.size(), [&](size_t i) { return spawns[i].getLevel(); });
+    writer.putColumn<int32_t>(spawns.size(), [&](size_t i) { return spawns[i].getReward(); });
+    writer.putColumn<int16_t>(spawns.size(), [&](size_t i) { return spawns[i].getPosition().first; });
+    writer.putColumn<int16_t>(spawns.size(), [&](size_t i) { return spawns[i].getPosition().second; });
+
+    // Projectiles
+    writer.put<uint32_t>(static_cast<uint32_t>(projectiles.size()));
+    writer.putColumn<uint32_t>(projectiles.size(), [&](size_t i) { return projectiles.getTargetId(i); });
+    writer.putColumn<int32_t>(projectiles.size(), [&](size_t i) { return projectiles.getDamage(i); });
+    writer.putColumn<int16_t>(projectiles.size(), [&](size_t i) { return projectiles.getOrigin(i).first; });
+    writer.putColumn<int16_t>(projectiles.size(), [&](size_t i) { return projectiles.getOrigin(i).second; });
+    writer.putColumn<uint16_t>(projectiles.size(), [&](size_t i) { return projectiles.getTicksLeft(i); });
+    writer.putColumn<uint16_t>(projectiles.size(), [&](size_t i) { return projectiles.getTravelTicks(i); });
+}
+
+/**
+ * @brief Restores a state saved by saveSnapshot.
+ *
+ * The snapshot is fully parsed, and its cell types, tower types, levels and positions are
+ * checked, before anything is modified, so a malformed snapshot leaves the game untouched.
+ *
+ * @param snapshot Snapshot bytes.
+ * @return True on success, false if the snapshot is malformed or does not fit this map.
+ */
+bool Simulation::loadSnapshot(const vector<uint8_t>& snapshot) {
+    SnapshotReader reader(snapshot);
+
+    if (reader.get<uint32_t>() != SNAPSHOT_MAGIC || reader.get<int32_t>() != map.getWidth()
+        || reader.get<int32_t>() != map.getHeight()) {
+        return false;
+    }
+    unsigned int seed = reader.get<uint32_t>();
+    uint64_t savedTick = reader.get<uint64_t>();
+    int savedTicksUntilSpawn = reader.get<int32_t>();
+    int savedGold = reader.get<int32_t>();
+    int savedHealth = reader.get<int32_t>();
+    int savedKills = reader.get<int32_t>();
+    int savedLeaks = reader.get<int32_t>();
+
+    int entryX = reader.get<int32_t>(), entryY = reader.get<int32_t>();
+    int exitX = reader.get<int32_t>(), exitY = reader.get<int32_t>();
+    vector<uint8_t> cells = reader.getColumn<uint8_t>(static_cast<size_t>(map.getWidth()) * map.getHeight());
+
+    uint32_t towerCount = reader.get<uint32_t>();
+    vector<uint8_t> towerTypes = reader.getColumn<uint8_t>(towerCount);
+    vector<int16_t> towerX = reader.getColumn<int16_t>(towerCount);
+    vector<int16_t> towerY = reader.getColumn<int16_t>(towerCount);
+    vector<uint8_t> towerLevels = reader.getColumn<uint8_t>(towerCount);
+
+    int wave = reader.get<int32_t>();
+    uint32_t nextId = reader.get<uint32_t>();
+    uint32_t activeCount = reader.get<uint32_t>();
+    vector<uint32_t> ids = reader.getColumn<uint32_t>(activeCount);
+    vector<int32_t> hp = reader.getColumn<int32_t>(activeCount);
+    vector<int32_t> strength = reader.getColumn<int32_t>(activeCount);
+    vector<int32_t> speed = reader.getColumn<int32_t>(activeCount);
+    vector<int32_t> level = reader.getColumn<int32_t>(activeCount);
+    vector<int32_t> reward = reader.getColumn<int32_t>(activeCount);
+    vector<int16_t> posX = reader.getColumn<int16_t>(activeCount);
+    vector<int16_t> posY = reader.getColumn<int16_t>(activeCount);
+
+    uint32_t spawnCount = reader.get<uint32_t>();
+    vector<int32_t> spawnHp = reader.getColumn<int32_t>(spawnCount);
+    vector<int32_t> spawnStrength = reader.getColumn<int32_t>(spawnCount);
+    vector<int32_t> spawnSpeed = reader.getColumn<int32_t>(spawnCount);
+    vector<int32_t> spawnLevel = reader.getColumn<int32_t>(spawnCount);
+    vector<int32_t> spawnReward = reader.getColumn<int32_t>(spawnCount);
+    vector<int16_t> spawnX = reader.getColumn<int16_t>(spawnCount);
+    vector<int16_t> spawnY = reader.getColumn<int16_t>(spawnCount);
+
+    uint32_t projectileCount = reader.get<uint32_t>();
+    vector<uint32_t> targets = reader.getColumn<uint32_t>(projectileCount);
+    vector<int32_t> damage = reader.getColumn<int32_t>(projectileCount);
+    vector<int16_t> originX = reader.getColumn<int16_t>(projectileCount);
+    vector<int16_t> originY = reader.getColumn<int16_t>(projectileCount);
+    vector<uint16_t> ticksLeft = reader.getColumn<uint16_t>(projectileCount);
+    vector<uint16_t> travelTicks = reader.getColumn<uint16_t>(projectileCount);
+
+    if (!reader.ok()) {
+        return false;
+    }
+
+    // Values the game would index with are checked before anything changes
+    for (uint8_t cell : cells) {
+        if (cell > TOWER) {
+            return false;
+        }
+    }
+    const TowerCatalog& catalog = TowerCatalog::instance();
+    for (uint32_t i = 0; i < towerCount; i++) {
+        if (towerTypes[i] < BASIC_TOWER || towerTypes[i] >= TOWER_TYPE_SLOTS || towerLevels[i] < 1
+            || towerLevels[i] > catalog.getMaxLevel(static_cast<TowerType>(towerTypes[i]))
+            || !map.isValidCoordinate(towerX[i], towerY[i])) {
+            return false;
+        }
+    }
+
+    // Map: terrain only (older snapshots store tower cells as TOWER); towers are re-placed below
+    towers.clear();
+    int width = map.getWidth();
+    for (size_t i = 0; i < cells.size(); i++) {
+        CellType type = static_cast<CellType>(cells[i]);
+        map.setCell(static_cast<int>(i % width), static_cast<int>(i / width), type == TOWER ? SCENERY : type);
+    }
+    map.setEntry(entryX, entryY);
+    map.setExit(exitX, exitY);
+
+    for (uint32_t i = 0; i < towerCount; i++) {
+        TowerHandle handle = towers.place(static_cast<TowerType>(towerTypes[i]), towerX[i], towerY[i]);
+        for (int lvl = 1; lvl < towerLevels[i]; lvl++) {
+            towers.upgrade(handle);
+        }
+    }
+
+    vector<Critter> active;
+    active.reserve(activeCount);
+    for (uint32_t i = 0; i < activeCount; i++) {
+        active.emplace_back(hp[i], strength[i], speed[i], level[i], reward[i], make_pair<int, int>(posX[i], posY[i]), &map);
+        active.back().setId(ids[i]);
+    }
+    deque<Critter> spawns;
+    for (uint32_t i = 0; i < spawnCount; i++) {
+        spawns.emplace_back(spawnHp[i], spawnStrength[i], spawnSpeed[i], spawnLevel[i], spawnReward[i],
+                            make_pair<int, int>(spawnX[i], spawnY[i]), &map);
+    }
+    critters.restoreState(wave, nextId, std::move(active), std::move(spawns));
+    if (config.openField || config.windingPath) {
+        distances.build(map);
+    }
+
+    projectiles.clear();
+    for (uint32_t i = 0; i < projectileCount; i++) {
+        projectiles.add(targets[i], damage[i], originX[i], originY[i], ticksLeft[i], travelTicks[i]);
+    }
+
+    config.seed = seed;
+    tick = savedTick;
+    ticksUntilSpawn = savedTicksUntilSpawn;
+    gold = savedGold;
+    health = savedHealth;
+    kills = savedKills;
+    leaks = savedLeaks;
+    return true;
+}
@@ -0,0 +1,292 @@
+/**
+ * @file Simulation.h
+ * @brief Declaration of the Simulation class, the headless game engine.
+ */
+
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include "mapgen.h"
+#include "critter.h"
+#include "CritterGroup.h"
+#include "tower.h"
+#include "TowerRegistry.h"
+#include "DamageBuffer.h"
+#include "ProjectilePool.h"
+#include "ThreadPool.h"
+#include "Snapshot.h"
+#include "Profiler.h"
+#include "DistanceField.h"
+
+using namespace std;
+
+class Replay;
+
+/**
+ * @enum CommandType
+ * @brief Kinds of player input that change the game state.
+ */
+enum CommandType {
+    COMMAND_PLACE = 1,   ///< Buy a tower on a cell
+    COMMAND_SELL = 2,    ///< Sell the tower on a cell
+    COMMAND_UPGRADE = 3  ///< Upgrade the tower on a cell
+};
+
+/**
+ * @struct PlayerCommand
+ * @brief One player input, applied before the tick it is stamped with.
+ *
+ * Commands address towers by cell rather than by handle, so they mean the same thing when a
+ * recorded game is replayed.
+ */
+struct PlayerCommand {
+    uint64_t tick = 0;                  ///< Tick the command was applied before
+    CommandType type = COMMAND_PLACE;   ///< What the player did
+    TowerType towerType = BASIC_TOWER;  ///< Tower bought, for COMMAND_PLACE
+    int x = 0;                          ///< X-coordinate of the cell
+    int y = 0;                          ///< Y-coordinate of the cell
+};
+
+/**
+ * @struct SimulationConfig
+ * @brief Parameters of a simulated game.
+ */
+struct SimulationConfig {
+    int width = 10;            ///< Map width in cells
+    int height = 10;           ///< Map height in cells
+    unsigned int seed = 1;     ///< Seed of the random map layout
+    int startingGold = 500;    ///< Gold available before the first wave
+    int startingHealth = 100;  ///< Player health; the game is lost when it reaches 0
+    int spawnInterval = 1;     ///< Ticks between two critter spawns
+    int spawnBatch = 1;        ///< Critters spawned together every spawnInterval ticks
+    int waveBase = 5;          ///< Wave n holds waveBase + n * waveGrowth critters (the first wave is 1)
+    int waveGrowth = 2;        ///< Critters added with every wave
+    int critterHitPoints = 100; ///< Critter hit points, in percent of the standard wave
+    bool openField = false;    ///< Critters walk every free cell and towers may go on the path, but never wall it off
+    bool windingPath = false;  ///< Generate a winding, maze-like path with MapGenerator instead of a staircase
+    size_t threads = 1;        ///< Threads used by the attack phase (1 = no worker pool)
+};
+
+/**
+ * @class Simulation
+ * @brief Owns a complete game and advances it tick by tick without any rendering.
+ *
+ * A tick runs the same phases the SFML driver used to run per frame: spawn, tower attack,
+ * projectile flight, damage resolution and critter movement, followed by the next wave once
+ * the current one is cleared. Given the same configuration and the same player actions, two
+ * simulations always reach the same state, whatever the thread count. Rendering front ends
+ * such as the SFML driver are just clients that read the state between steps.
+ */
+class Simulation {
+private:
+    SimulationConfig config;          ///< Configuration the game was started with
+    Map map;                          ///< Game map
+    CritterGroup critters;            ///< Critter waves
+    TowerRegistry towers;             ///< Placed towers
+    DamageBuffer hits;                ///< Per-tick damage buffer
+    ProjectilePool projectiles;       ///< Shots in flight
+    DistanceField distances;          ///< Critter route on open-field and winding maps, repaired as towers come and go
+    unique_ptr<ThreadPool> pool;      ///< Worker pool of the attack phase, if threads > 1
+    Replay* recorder;                 ///< Replay receiving the commands and tick checksums, if recording
+    Profiler* profiler;               ///< Profiler timing the tick phases, if profiling
+
+    uint64_t tick;                    ///< Number of ticks simulated so far
+    int ticksUntilSpawn;              ///< Ticks left before the next critter spawns
+    int gold;                         ///< Player gold
+    int health;                       ///< Player health
+    int kills;                        ///< Critters killed so far
+    int leaks;                        ///< Critters that reached the exit so far
+
+    /** @brief Runs a single tick. */
+    void stepOnce();
+
+    /** @brief Creates the attack worker pool, if any, and queues the first wave. */
+    void start();
+
+    /**
+     * @brief Closes a cell of an open-field map for a new tower, unless that walls critters in.
+     *
+     * The distance field is repaired for the closed cell; if the entry or a live critter can
+     * no longer reach the exit, or a critter stands on the cell, the cell is reopened.
+     * @param x X-coordinate of the cell.
+     * @param y Y-coordinate of the cell.
+     * @return True if the cell stays closed.
+     */
+    bool closeRouteCell(int x, int y);
+
+    /** @brief Gets the Zobrist keys of the counters and the projectiles, which are hashed on demand. */
+    uint64_t counterHash() const;
+
+public:
+    /**
+     * @brief Starts a new game: generates the map from the seed and queues the first wave.
+     * @param config Parameters of the game.
+     */
+    explicit Simulation(const SimulationConfig& config = SimulationConfig());
+
+    /**
+     * @brief Starts a new game on an already generated level.
+     *
+     * The map is a copy-on-write copy of the level, so games on the same level share its
+     * terrain; the level must have been made by generateLevel() from the same config and should
+     * be prepared with Map::prepareForSharing() if games run on several threads.
+     * @param config Parameters of the game.
+     * @param level Map to start from.
+     * @param memory Memory resource the critters, towers and projectiles allocate from; must outlive the game.
+     */
+    Simulation(const SimulationConfig& config, const Map& level, pmr::memory_resource* memory = pmr::get_default_resource());
+
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    /**
+     * @brief Lays out the level of a game: the staircase path of generateRandomMap(), or a
+     * MapGenerator maze if config.windingPath is set.
+     * @param config Parameters of the game; its seed, size and windingPath pick the level.
+     * @param map Map to lay the level out on; must have config's size.
+     * @param pool Worker pool to score winding candidates on, or nullptr; the level is the same either way.
+     */
+    static void generateLevel(const SimulationConfig& config, Map& map, ThreadPool* pool = nullptr);
+
+    /**
+     * @brief Advances the game.
+     * @param ticks Number of ticks to simulate; stops early if the game is lost.
+     */
+    void step(int ticks = 1);
+
+    /**
+     * @brief Buys a tower and places it on the map.
+     * @param type Type of tower to buy.
+     * @param x X-coordinate of the tower.
+     * @param y Y-coordinate of the tower.
+     * @return Handle to the new tower, or an invalid handle if the cell is not buildable, gold is short or,
+     *         on open-field maps, the tower would cut the critters off from the exit.
+     */
+    TowerHandle buyTower(TowerType type, int x, int y);
+
+    /**
+     * @brief Sells a tower and refunds its value.
+     * @param handle Handle of the tower.
+     * @return Gold refunded, or 0 if the handle is stale.
+     */
+    int sellTower(TowerHandle handle);
+
+    /**
+     * @brief Pays for a tower upgrade.
+     * @param handle Handle of the tower.
+     * @return True if the tower was upgraded, false if the handle is stale, the tower is maxed out or gold is short.
+     */
+    bool upgradeTower(TowerHandle handle);
+
+    /**
+     * @brief Applies a player command at the current tick.
+     *
+     * This is the entry point for every state-changing input: while a recorder is attached,
+     * successful commands are stamped with the current tick and recorded.
+     * @param command Command to apply; its tick field is ignored.
+     * @return True if the command changed the game.
+     */
+    bool apply(const PlayerCommand& command);
+
+    /**
+     * @brief Starts or stops recording the game.
+     * @param replay Replay receiving the commands and per-tick checksums, or nullptr to stop.
+     */
+    void setRecorder(Replay* replay) { recorder = replay; }
+
+    /**
+     * @brief Starts or stops timing the tick phases; only effective in builds with TD_ENABLE_PROFILING.
+     * @param profiler Profiler receiving the timings, or nullptr to stop.
+     */
+    void setProfiler(Profiler* profiler) { this->profiler = profiler; }
+
+    /**
+     * @brief Recomputes the Zobrist hash of the game state from scratch.
+     *
+     * Walks every cell, tower and critter instead of reading the incrementally kept hashes,
+     * so it costs O(map + objects). It is an independent check of stateHash(): the two are
+     * equal unless an incremental update was missed.
+     * @return 64-bit Zobrist hash of the state.
+     */
+    uint64_t recomputeStateHash() const;
+
+    /**
+     * @brief Gets the Zobrist hash of the game state.
+     *
+     * Combines the hashes that the map, tower registry and critter group keep up to date
+     * incrementally with keys for the counters and the few projectiles in flight, so it costs
+     * O(projectiles) instead of a walk over the whole state. The hash only depends on the
+     * state, so it can be compared across runs, threads and snapshot restores.
+     * @return 64-bit Zobrist hash of the state.
+     */
+    uint64_t stateHash() const;
+
+    /**
+     * @brief Serializes the complete game state into a compact binary snapshot.
+     *
+     * Covers the map cells, towers, critter columns, projectiles, wave and tick counters,
+     * player state and the layout seed.
+     * @param out Receives the snapshot; cleared first.
+     */
+    void saveSnapshot(vector<uint8_t>& out) const;
+
+    /**
+     * @brief Restores a state saved by saveSnapshot.
+     *
+     * Towers are re-created, so handles issued before the restore no longer resolve.
+     * @param snapshot Snapshot bytes.
+     * @return True on success; false if the snapshot is malformed or was taken on a map of another size.
+     */
+    bool loadSnapshot(const vector<uint8_t>& snapshot);
+
+    /** @brief Checks if the player has run out of health. */
+    bool isGameOver() const { return health <= 0; }
+
+    /** @brief Gets the configuration the game was started with. */
+    const SimulationConfig& getConfig() const { return config; }
+
+    /** @brief Gets the game map. */
+    Map& getMap() { return map; }
+
+    /** @brief Gets the critter waves. */
+    CritterGroup& getCritters() { return critters; }
+
+    /** @brief Gets a read-only view of the active critters, without copying them. */
+    ConstCritterSpan getCritterView() const { return critters.view(); }
+
+    /**
+     * @brief Gets the critters' distances to the exit on open-field and winding maps.
+     * @return Distance field; only maintained when the game was started with openField or windingPath.
+     */
+    const DistanceField& getDistanceField() const { return distances; }
+
+    /** @brief Gets the placed towers. */
+    TowerRegistry& getTowers() { return towers; }
+
+    /** @brief Gets the projectiles in flight. */
+    const ProjectilePool& getProjectiles() const { return projectiles; }
+
+    /** @brief Gets the number of ticks simulated so far. */
+    uint64_t getTick() const { return tick; }
+
+    /** @brief Gets the player's gold. */
+    int getGold() const { return gold; }
+
+    /** @brief Gets the player's health. */
+    int getHealth() const { return health; }
+
+    /** @brief Gets the number of critters killed so far. */
+    int getKills() const { return kills; }
+
+    /** @brief Gets the number of critters that reached the exit so far. */
+    int getLeaks() const { return leaks; }
+
+    /** @brief Gets the current wave number. */
+    int getWave() const { return critters.getCurrentWave(); }
+};
+
+#endif // SIMULATION_H
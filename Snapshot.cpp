@@ -0,0 +1,360 @@
+/**
+ * @file Snapshot.cpp
+ * @brief Implementation of snapshot delta encoding, the rewind ring and disk checkpoints.
+ */
+
+#include "Snapshot.h"
+#include <algorithm>
+#include <cstdio>
+
+/**
+ * @brief Appends an unsigned LEB128 varint.
+ *
+ * @param out Buffer to append to.
+ * @param value Value to encode.
+ */
+void putVarint(vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+/**
+ * @brief Reads an unsigned LEB128 varint.
+ *
+ * @param in Buffer to read from.
+ * @param offset Read position; advanced past the varint.
+ * @param value Receives the decoded value.
+ * @return True if a complete varint was read.
+ */
+bool getVarint(const vector<uint8_t>& in, size_t& offset, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && offset < in.size(); shift += 7) {
+        uint8_t byte = in[offset++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Gets byte i of a snapshot, or 0 past its end.
+ */
+static inline uint8_t byteAt(const vector<uint8_t>& data, size_t i) {
+    return i < data.size() ? data[i] : 0;
+}
+
+/**
+ * @brief Encodes a snapshot as a delta against a previous one.
+ *
+ * Format: varint(next size), then repeated varint(unchanged run), varint(changed run) and
+ * the changed run's XORed bytes. Short unchanged gaps inside a changed run are kept in it
+ * to avoid paying two varints for a handful of bytes.
+ *
+ * @param base Previous snapshot.
+ * @param next Snapshot to encode.
+ * @param out Receives the delta; cleared first.
+ */
+void encodeSnapshotDelta(const vector<uint8_t>& base, const vector<uint8_t>& next, vector<uint8_t>& out) {
+    const size_t MIN_GAP = 4;
+    size_t n = next.size();
+    size_t common = min(base.size(), n);
+
+    out.clear();
+    putVarint(out, n);
+
+    size_t i = 0;
+    while (i < n) {
+        // Unchanged run, compared a word at a time where both snapshots overlap
+        size_t runStart = i;
+        while (i + 8 <= common && memcmp(&base[i], &next[i], 8) == 0) {
+            i += 8;
+        }
+        while (i < n && (next[i] ^ byteAt(base, i)) == 0) {
+            i++;
+        }
+        size_t same = i - runStart;
+        if (i == n) {
+            break;
+        }
+
+        // Changed run, ending at the first gap of at least MIN_GAP unchanged bytes
+        size_t changedStart = i;
+        size_t gap = 0;
+        while (i < n && gap < MIN_GAP) {
+            gap = (next[i] ^ byteAt(base, i)) == 0 ? gap + 1 : 0;
+            i++;
+        }
+        size_t changedEnd = gap >= MIN_GAP ? i - gap : i;
+        i = changedEnd;
+
+        putVarint(out, same);
+        putVarint(out, changedEnd - changedStart);
+        for (size_t k = changedStart; k < changedEnd; k++) {
+            out.push_back(next[k] ^ byteAt(base, k));
+        }
+    }
+}
+
+/**
+ * @brief Rebuilds a snapshot from its base and a delta.
+ *
+ * @param base Snapshot the delta was encoded against.
+ * @param delta Output of encodeSnapshotDelta.
+ * @param out Receives the rebuilt snapshot.
+ * @return True if the delta was well formed.
+ */
+bool applySnapshotDelta(const vector<uint8_t>& base, const vector<uint8_t>& delta, vector<uint8_t>& out) {
+    size_t offset = 0;
+    uint64_t n = 0;
+    if (!getVarint(delta, offset, n)) {
+        return false;
+    }
+
+    out.resize(n);
+    size_t common = min(base.size(), static_cast<size_t>(n));
+    if (common > 0) {
+        memcpy(out.data(), base.data(), common);
+    }
+    if (n > common) {
+        memset(out.data() + common, 0, n - common);
+    }
+
+    size_t i = 0;
+    while (offset < delta.size()) {
+        uint64_t same = 0, changed = 0;
+        if (!getVarint(delta, offset, same) || !getVarint(delta, offset, changed)) {
+            return false;
+        }
+        i += same;
+        if (i + changed > n || offset + changed > delta.size()) {
+            return false;
+        }
+        for (uint64_t k = 0; k < changed; k++) {
+            out[i++] ^= delta[offset++];
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Constructs an empty ring.
+ *
+ * @param capacity Maximum number of snapshots kept.
+ * @param keyframeInterval Number of entries between two full snapshots.
+ */
+SnapshotRing::SnapshotRing(size_t capacity, size_t keyframeInterval)
+        : capacity(max<size_t>(capacity, 1)), keyframeInterval(max<size_t>(keyframeInterval, 1)),
+          sinceKeyframe(0), storedBytes(0) {
+}
+
+/**
+ * @brief Stores a snapshot as the newest entry.
+ *
+ * @param snapshot Full snapshot.
+ */
+void SnapshotRing::push(const vector<uint8_t>& snapshot) {
+    Entry entry;
+    if (entries.empty() || sinceKeyframe + 1 >= keyframeInterval) {
+        entry.keyframe = true;
+        entry.data = snapshot;
+        sinceKeyframe = 0;
+    } else {
+        entry.keyframe = false;
+        encodeSnapshotDelta(latest, snapshot, entry.data);
+        sinceKeyframe++;
+    }
+
+    storedBytes += entry.data.size();
+    entries.push_back(std::move(entry));
+    latest = snapshot;
+
+    if (entries.size() > capacity) {
+        // Promote the second-oldest entry to a keyframe before its base disappears
+        if (!entries[1].keyframe) {
+            vector<uint8_t> full;
+            applySnapshotDelta(entries[0].data, entries[1].data, full);
+            storedBytes += full.size() - entries[1].data.size();
+            entries[1].data = std::move(full);
+            entries[1].keyframe = true;
+        }
+        storedBytes -= entries.front().data.size();
+        entries.pop_front();
+    }
+}
+
+/**
+ * @brief Rebuilds a stored snapshot.
+ *
+ * @param stepsBack 0 for the newest entry, 1 for the one before, and so on.
+ * @param out Receives the full snapshot.
+ * @return True if the entry exists.
+ */
+bool SnapshotRing::get(size_t stepsBack, vector<uint8_t>& out) const {
+    if (stepsBack >= entries.size()) {
+        return false;
+    }
+    if (stepsBack == 0) {
+        out = latest;
+        return true;
+    }
+
+    size_t target = entries.size() - 1 - stepsBack;
+    size_t key = target;
+    while (!entries[key].keyframe) {
+        key--;
+    }
+
+    out = entries[key].data;
+    vector<uint8_t> next;
+    for (size_t i = key + 1; i <= target; i++) {
+        if (!applySnapshotDelta(out, entries[i].data, next)) {
+            return false;
+        }
+        out.swap(next);
+    }
+    return true;
+}
+
+/**
+ * @brief Drops the newest entries.
+ *
+ * @param count Number of entries to drop.
+ */
+void SnapshotRing::discardNewest(size_t count) {
+    if (count == 0) {
+        return;
+    }
+    if (count >= entries.size()) {
+        entries.clear();
+        latest.clear();
+        storedBytes = 0;
+        sinceKeyframe = 0;
+        return;
+    }
+
+    vector<uint8_t> newLatest;
+    get(count, newLatest);
+    for (size_t i = 0; i < count; i++) {
+        storedBytes -= entries.back().data.size();
+        entries.pop_back();
+    }
+    latest.swap(newLatest);
+
+    sinceKeyframe = 0;
+    for (size_t i = entries.size() - 1; !entries[i].keyframe; i--) {
+        sinceKeyframe++;
+    }
+}
+
+/**
+ * @brief Starts the writer thread.
+ */
+CheckpointWriter::CheckpointWriter()
+        : writing(false), stopping(false), failures(0), worker(&CheckpointWriter::run, this) {
+}
+
+/**
+ * @brief Writes the remaining checkpoints and stops the thread.
+ */
+CheckpointWriter::~CheckpointWriter() {
+    {
+        lock_guard<mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueChanged.notify_all();
+    worker.join();
+}
+
+/**
+ * @brief Queues a snapshot to be written to a file.
+ *
+ * @param path File to write.
+ * @param snapshot Snapshot bytes; moved into the queue.
+ */
+void CheckpointWriter::write(const string& path, vector<uint8_t> snapshot) {
+    {
+        lock_guard<mutex> lock(queueMutex);
+        pending.emplace_back(path, std::move(snapshot));
+    }
+    queueChanged.notify_all();
+}
+
+/**
+ * @brief Blocks until every queued checkpoint has been written.
+ */
+void CheckpointWriter::flush() {
+    unique_lock<mutex> lock(queueMutex);
+    queueChanged.wait(lock, [this] { return pending.empty() && !writing; });
+}
+
+/**
+ * @brief Gets the number of checkpoints that could not be written.
+ */
+size_t CheckpointWriter::getFailures() {
+    lock_guard<mutex> lock(queueMutex);
+    return failures;
+}
+
+/**
+ * @brief Main loop of the writer thread: writes queued checkpoints until shut down.
+ */
+void CheckpointWriter::run() {
+    unique_lock<mutex> lock(queueMutex);
+    while (true) {
+        queueChanged.wait(lock, [this] { return stopping || !pending.empty(); });
+        if (pending.empty()) {
+            return;  // Stopping and nothing left to flush
+        }
+
+        pair<string, vector<uint8_t>> job = std::move(pending.front());
+        pending.pop_front();
+        writing = true;
+        lock.unlock();
+
+        // Write to a temporary file first so a crash never leaves a truncated checkpoint
+        string temporary = job.first + ".tmp";
+        bool ok = false;
+        FILE* file = fopen(temporary.c_str(), "wb");
+        if (file != nullptr) {
+            ok = fwrite(job.second.data(), 1, job.second.size(), file) == job.second.size();
+            ok = fclose(file) == 0 && ok;
+            ok = ok && rename(temporary.c_str(), job.first.c_str()) == 0;
+        }
+
+        lock.lock();
+        writing = false;
+        if (!ok) {
+            failures++;
+        }
+        queueChanged.notify_all();
+    }
+}
+
+/**
+ * @brief Reads a snapshot file written by CheckpointWriter.
+ *
+ * @param path File to read.
+ * @param out Receives the snapshot bytes.
+ * @return True if the file was read.
+ */
+bool readSnapshotFile(const string& path, vector<uint8_t>& out) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    out.clear();
+    uint8_t buffer[1 << 16];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        out.insert(out.end(), buffer, buffer + read);
+    }
+    bool ok = ferror(file) == 0;
+    fclose(file);
+    return ok;
+}
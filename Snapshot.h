@@ -0,0 +1,274 @@
+/**
+ * @file Snapshot.h
+ * @brief Binary game-state snapshots: serialization helpers, delta encoding, rewind ring and disk checkpoints.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @class SnapshotWriter
+ * @brief Appends raw little-endian values and columns to a byte buffer.
+ */
+class SnapshotWriter {
+private:
+    vector<uint8_t>& out; ///< Buffer receiving the snapshot
+
+public:
+    /**
+     * @brief Constructs a writer appending to a buffer.
+     * @param out Buffer receiving the snapshot.
+     */
+    explicit SnapshotWriter(vector<uint8_t>& out) : out(out) {}
+
+    /**
+     * @brief Appends one trivially copyable value.
+     * @param value Value to append.
+     */
+    template <class T>
+    void put(T value) {
+        size_t at = out.size();
+        out.resize(at + sizeof(T));
+        memcpy(&out[at], &value, sizeof(T));
+    }
+
+    /**
+     * @brief Appends a column of count values produced by get(i).
+     *
+     * Values of one field are stored together, which keeps successive snapshots similar byte
+     * for byte and lets the delta encoder skip long unchanged runs.
+     * @param count Number of values.
+     * @param get Function returning the i-th value.
+     */
+    template <class T, class Getter>
+    void putColumn(size_t count, Getter get) {
+        size_t at = out.size();
+        out.resize(at + count * sizeof(T));
+        uint8_t* dest = &out[at];
+        for (size_t i = 0; i < count; i++) {
+            T value = static_cast<T>(get(i));
+            memcpy(dest + i * sizeof(T), &value, sizeof(T));
+        }
+    }
+};
+
+/**
+ * @class SnapshotReader
+ * @brief Reads back values written by SnapshotWriter, with bounds checking.
+ */
+class SnapshotReader {
+private:
+    const vector<uint8_t>& in; ///< Snapshot being read
+    size_t offset;             ///< Read position
+    bool failed;               ///< Set once a read runs past the end
+
+public:
+    /**
+     * @brief Constructs a reader at the start of a snapshot.
+     * @param in Snapshot to read.
+     */
+    explicit SnapshotReader(const vector<uint8_t>& in) : in(in), offset(0), failed(false) {}
+
+    /**
+     * @brief Reads one value.
+     * @return The value, or T() if the snapshot is truncated.
+     */
+    template <class T>
+    T get() {
+        T value = T();
+        if (failed || offset + sizeof(T) > in.size()) {
+            failed = true;
+            return value;
+        }
+        memcpy(&value, &in[offset], sizeof(T));
+        offset += sizeof(T);
+        return value;
+    }
+
+    /**
+     * @brief Reads a column of count values.
+     * @param count Number of values.
+     * @return The values, or an empty vector if the snapshot is truncated.
+     */
+    template <class T>
+    vector<T> getColumn(size_t count) {
+        if (failed || count > (in.size() - offset) / sizeof(T)) {
+            failed = true;
+            return vector<T>();
+        }
+        vector<T> values(count);
+        if (count > 0) {
+            memcpy(values.data(), &in[offset], count * sizeof(T));
+        }
+        offset += count * sizeof(T);
+        return values;
+    }
+
+    /** @brief Checks that every read so far stayed inside the snapshot. */
+    bool ok() const { return !failed; }
+};
+
+/**
+ * @brief Appends an unsigned LEB128 varint: 7 bits per byte, small values take one byte.
+ * @param out Buffer to append to.
+ * @param value Value to encode.
+ */
+void putVarint(vector<uint8_t>& out, uint64_t value);
+
+/**
+ * @brief Reads an unsigned LEB128 varint.
+ * @param in Buffer to read from.
+ * @param offset Read position; advanced past the varint.
+ * @param value Receives the decoded value.
+ * @return True if a complete varint was read.
+ */
+bool getVarint(const vector<uint8_t>& in, size_t& offset, uint64_t& value);
+
+/**
+ * @brief Encodes a snapshot as a delta against a previous one.
+ *
+ * The two snapshots are XORed byte by byte and the result is stored as alternating runs of
+ * unchanged bytes (only their length) and changed bytes (verbatim). Bytes past the end of
+ * the base are compared against zero.
+ * @param base Previous snapshot.
+ * @param next Snapshot to encode.
+ * @param out Receives the delta; cleared first.
+ */
+void encodeSnapshotDelta(const vector<uint8_t>& base, const vector<uint8_t>& next, vector<uint8_t>& out);
+
+/**
+ * @brief Rebuilds a snapshot from its base and a delta.
+ * @param base Snapshot the delta was encoded against.
+ * @param delta Output of encodeSnapshotDelta.
+ * @param out Receives the rebuilt snapshot.
+ * @return True if the delta was well formed.
+ */
+bool applySnapshotDelta(const vector<uint8_t>& base, const vector<uint8_t>& delta, vector<uint8_t>& out);
+
+/**
+ * @class SnapshotRing
+ * @brief Bounded in-memory history of snapshots for instant rewind.
+ *
+ * Every keyframeInterval-th entry is stored in full and the others as deltas against the
+ * entry before them. When the ring is full the oldest entry is dropped; if the entry after
+ * it was a delta, it is rebuilt and promoted to a keyframe first.
+ */
+class SnapshotRing {
+private:
+    /**
+     * @struct Entry
+     * @brief One stored snapshot.
+     */
+    struct Entry {
+        bool keyframe;          ///< True if data is a full snapshot, false if it is a delta
+        vector<uint8_t> data;   ///< Full snapshot or delta against the previous entry
+    };
+
+    size_t capacity;          ///< Maximum number of entries
+    size_t keyframeInterval;  ///< Entries between two keyframes
+    size_t sinceKeyframe;     ///< Entries pushed since the last keyframe
+    deque<Entry> entries;     ///< Oldest entry first
+    vector<uint8_t> latest;   ///< Full copy of the newest entry, base of the next delta
+    size_t storedBytes;       ///< Bytes held by all entries
+
+public:
+    /**
+     * @brief Constructs an empty ring.
+     * @param capacity Maximum number of snapshots kept.
+     * @param keyframeInterval Number of entries between two full snapshots.
+     */
+    explicit SnapshotRing(size_t capacity = 256, size_t keyframeInterval = 32);
+
+    /**
+     * @brief Stores a snapshot as the newest entry.
+     * @param snapshot Full snapshot.
+     */
+    void push(const vector<uint8_t>& snapshot);
+
+    /**
+     * @brief Rebuilds a stored snapshot.
+     * @param stepsBack 0 for the newest entry, 1 for the one before, and so on.
+     * @param out Receives the full snapshot.
+     * @return True if the entry exists.
+     */
+    bool get(size_t stepsBack, vector<uint8_t>& out) const;
+
+    /**
+     * @brief Drops the newest entries, e.g. after rewinding to an older one.
+     * @param count Number of entries to drop.
+     */
+    void discardNewest(size_t count);
+
+    /** @brief Gets the number of stored snapshots. */
+    size_t size() const { return entries.size(); }
+
+    /** @brief Gets the memory held by the stored entries, in bytes. */
+    size_t getStoredBytes() const { return storedBytes; }
+};
+
+/**
+ * @class CheckpointWriter
+ * @brief Writes snapshots to disk on a background thread.
+ *
+ * The game thread hands over the snapshot bytes and carries on; the writer thread does the
+ * file I/O. Pending checkpoints are flushed when the writer is destroyed.
+ */
+class CheckpointWriter {
+private:
+    mutex queueMutex;                            ///< Guards pending, writing, stopping and failures
+    condition_variable queueChanged;             ///< Signalled when work arrives, finishes, or on shutdown
+    deque<pair<string, vector<uint8_t>>> pending; ///< Checkpoints waiting to be written
+    bool writing;                                ///< True while the worker is writing a checkpoint
+    bool stopping;                               ///< Set by the destructor
+    size_t failures;                             ///< Number of checkpoints that could not be written
+    thread worker;                               ///< Background writer
+
+    /** @brief Main loop of the writer thread. */
+    void run();
+
+public:
+    /** @brief Starts the writer thread. */
+    CheckpointWriter();
+
+    /** @brief Writes the remaining checkpoints and stops the thread. */
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    /**
+     * @brief Queues a snapshot to be written to a file.
+     * @param path File to write.
+     * @param snapshot Snapshot bytes; moved into the queue.
+     */
+    void write(const string& path, vector<uint8_t> snapshot);
+
+    /** @brief Blocks until every queued checkpoint has been written. */
+    void flush();
+
+    /** @brief Gets the number of checkpoints that could not be written. */
+    size_t getFailures();
+};
+
+/**
+ * @brief Reads a snapshot file written by CheckpointWriter.
+ * @param path File to read.
+ * @param out Receives the snapshot bytes.
+ * @return True if the file was read.
+ */
+bool readSnapshotFile(const string& path, vector<uint8_t>& out);
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,131 @@
+/**
+ * @file SoftwareRasterizer.cpp
+ * @brief Implementation of the SoftwareRasterizer class.
+ */
+
+#include "SoftwareRasterizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+/**
+ * @brief Constructs a rasterizer with an empty framebuffer.
+ */
+SoftwareRasterizer::SoftwareRasterizer()
+        : width(0), height(0), mapLayerRevision(0), mapLayerValid(false) {
+}
+
+/**
+ * @brief Runs body(rowBegin, rowEnd) for each band of rows.
+ *
+ * @param pool Optional worker pool; bands run on the calling thread without one.
+ * @param body Function drawing one band.
+ */
+void SoftwareRasterizer::forEachBand(ThreadPool* pool, const function<void(int, int)>& body) {
+    int bands = pool ? static_cast<int>(pool->size()) * 4 : 1;  // Extra bands even out uneven rows
+    bands = max(1, min(bands, height));
+
+    if (pool == nullptr || bands == 1) {
+        body(0, height);
+        return;
+    }
+
+    pool->run(static_cast<size_t>(bands), [&](size_t band) {
+        int rowBegin = static_cast<int>(height * band / bands);
+        int rowEnd = static_cast<int>(height * (band + 1) / bands);
+        body(rowBegin, rowEnd);
+    });
+}
+
+/**
+ * @brief Draws quads into a buffer, restricted to rows [rowBegin, rowEnd).
+ *
+ * Squares are filled; discs cover the pixels whose centers lie inside the inscribed circle.
+ *
+ * @param target RGB buffer of width x height pixels.
+ * @param quads Quads to draw, in order.
+ * @param rowBegin First row to draw.
+ * @param rowEnd Row after the last one to draw.
+ */
+void SoftwareRasterizer::drawQuads(vector<uint8_t>& target, const vector<RenderQuad>& quads, int rowBegin, int rowEnd) {
+    for (const RenderQuad& quad : quads) {
+        int y0 = max(rowBegin, static_cast<int>(floor(quad.y)));
+        int y1 = min(rowEnd, static_cast<int>(ceil(quad.y + quad.size)));
+        int x0 = max(0, static_cast<int>(floor(quad.x)));
+        int x1 = min(width, static_cast<int>(ceil(quad.x + quad.size)));
+        if (y0 >= y1 || x0 >= x1) continue;
+
+        float radius = quad.size / 2;
+        float cx = quad.x + radius;
+        float cy = quad.y + radius;
+
+        for (int py = y0; py < y1; py++) {
+            uint8_t* row = &target[(static_cast<size_t>(py) * width) * 3];
+            int spanBegin = x0, spanEnd = x1;
+
+            if (quad.shape == QUAD_DISC) {
+                // Horizontal extent of the circle at this row's pixel centers
+                float dy = py + 0.5f - cy;
+                float reach2 = radius * radius - dy * dy;
+                if (reach2 < 0) continue;
+                float reach = sqrt(reach2);
+                spanBegin = max(x0, static_cast<int>(ceil(cx - reach - 0.5f)));
+                spanEnd = min(x1, static_cast<int>(floor(cx + reach - 0.5f)) + 1);
+            }
+
+            for (int px = spanBegin; px < spanEnd; px++) {
+                row[px * 3 + 0] = quad.color.r;
+                row[px * 3 + 1] = quad.color.g;
+                row[px * 3 + 2] = quad.color.b;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Rasterizes a render list.
+ *
+ * @param list Render list to draw; the framebuffer is resized to its pixel size.
+ * @param pool Optional worker pool used to draw bands in parallel.
+ */
+void SoftwareRasterizer::render(const RenderList& list, ThreadPool* pool) {
+    if (list.getPixelWidth() != width || list.getPixelHeight() != height) {
+        width = list.getPixelWidth();
+        height = list.getPixelHeight();
+        frame.assign(static_cast<size_t>(width) * height * 3, 0);
+        mapLayer.assign(frame.size(), 0);
+        mapLayerValid = false;
+    }
+
+    bool redrawMap = !mapLayerValid || mapLayerRevision != list.getMapRevision();
+    size_t rowBytes = static_cast<size_t>(width) * 3;
+
+    forEachBand(pool, [&](int rowBegin, int rowEnd) {
+        if (redrawMap) {
+            drawQuads(mapLayer, list.getMapLayer(), rowBegin, rowEnd);
+        }
+        memcpy(&frame[rowBegin * rowBytes], &mapLayer[rowBegin * rowBytes], (rowEnd - rowBegin) * rowBytes);
+        drawQuads(frame, list.getEntities(), rowBegin, rowEnd);
+    });
+
+    mapLayerRevision = list.getMapRevision();
+    mapLayerValid = true;
+}
+
+/**
+ * @brief Writes the framebuffer as a binary PPM (P6) image.
+ *
+ * @param path File to write.
+ * @return True if the file was written.
+ */
+bool SoftwareRasterizer::savePPM(const string& path) const {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    bool ok = fwrite(frame.data(), 1, frame.size(), file) == frame.size();
+    return fclose(file) == 0 && ok;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file SoftwareRasterizer.h
+ * @brief Declaration of the SoftwareRasterizer class, a CPU backend for RenderList.
+ */
+
+#ifndef SOFTWARE_RASTERIZER_H
+#define SOFTWARE_RASTERIZER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "RenderList.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+/**
+ * @class SoftwareRasterizer
+ * @brief Rasterizes render lists into an RGB framebuffer on the CPU and saves PPM frames.
+ *
+ * The frame is split into horizontal bands, one per pool task, and every band draws all
+ * quads clipped to its rows, so bands never touch the same pixels. The map layer is
+ * rasterized into its own cached buffer and only redrawn when the list's map revision
+ * changes; every frame starts with a copy of it.
+ */
+class SoftwareRasterizer {
+private:
+    int width, height;                     ///< Framebuffer size in pixels
+    vector<uint8_t> frame;                 ///< RGB framebuffer
+    vector<uint8_t> mapLayer;              ///< Cached rasterization of the map layer
+    unsigned long long mapLayerRevision;   ///< Map revision mapLayer was drawn from
+    bool mapLayerValid;                    ///< False until mapLayer is drawn once
+
+    /**
+     * @brief Draws quads into a buffer, restricted to rows [rowBegin, rowEnd).
+     */
+    void drawQuads(vector<uint8_t>& target, const vector<RenderQuad>& quads, int rowBegin, int rowEnd);
+
+    /**
+     * @brief Runs body(rowBegin, rowEnd) for each band of rows, in parallel if a pool is given.
+     */
+    void forEachBand(ThreadPool* pool, const function<void(int, int)>& body);
+
+public:
+    /** @brief Constructs a rasterizer with an empty framebuffer. */
+    SoftwareRasterizer();
+
+    /**
+     * @brief Rasterizes a render list.
+     * @param list Render list to draw; the framebuffer is resized to its pixel size.
+     * @param pool Optional worker pool used to draw bands in parallel.
+     */
+    void render(const RenderList& list, ThreadPool* pool = nullptr);
+
+    /**
+     * @brief Writes the framebuffer as a binary PPM (P6) image.
+     * @param path File to write.
+     * @return True if the file was written.
+     */
+    bool savePPM(const string& path) const;
+
+    /** @brief Gets the RGB framebuffer, row by row. */
+    const vector<uint8_t>& getFrame() const { return frame; }
+
+    /** @brief Gets the framebuffer width in pixels. */
+    int getWidth() const { return width; }
+
+    /** @brief Gets the framebuffer height in pixels. */
+    int getHeight() const { return height; }
+};
+
+#endif // SOFTWARE_RASTERIZER_H
@@ -0,0 +1,128 @@
+/**
+ * @file StressScenario.cpp
+ * @brief Implementation of the stress scenario presets and generator.
+ */
+
+#include "StressScenario.h"
+#include <algorithm>
+#include <random>
+#include "TowerLayout.h"
+
+/// Built-in scenarios, smallest first: name, width, height, towers, critters per wave, ticks.
+static const struct {
+    const char* name;
+    int width, height, towers, critters, ticks;
+} STRESS_PRESETS[] = {
+    {"small", 64, 64, 100, 1000, 2000},
+    {"medium", 512, 512, 1000, 10000, 1000},
+    {"large", 2048, 2048, 5000, 50000, 500},
+    {"huge", 4096, 4096, 10000, 100000, 300},
+};
+
+/**
+ * @brief Gets a built-in scenario.
+ *
+ * @param name Preset name.
+ * @param scenario Receives the preset; its other fields keep their defaults.
+ * @return True if the preset exists.
+ */
+bool findStressPreset(const string& name, StressScenario& scenario) {
+    for (const auto& preset : STRESS_PRESETS) {
+        if (name == preset.name) {
+            scenario = StressScenario();
+            scenario.name = preset.name;
+            scenario.width = preset.width;
+            scenario.height = preset.height;
+            scenario.towers = preset.towers;
+            scenario.critters = preset.critters;
+            scenario.ticks = preset.ticks;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Gets the names of the built-in scenarios, smallest first.
+ *
+ * @return Preset names.
+ */
+vector<string> getStressPresetNames() {
+    vector<string> names;
+    for (const auto& preset : STRESS_PRESETS) {
+        names.push_back(preset.name);
+    }
+    return names;
+}
+
+/**
+ * @brief Builds the game configuration of a scenario.
+ *
+ * @param scenario Scenario to run.
+ * @param threads Threads of the attack phase.
+ * @return Configuration for a Simulation.
+ */
+SimulationConfig makeStressConfig(const StressScenario& scenario, size_t threads) {
+    SimulationConfig config;
+    config.width = scenario.width;
+    config.height = scenario.height;
+    config.seed = scenario.seed;
+    config.startingGold = 1000000000;
+    config.startingHealth = 1000000000;
+    config.waveBase = scenario.critters;
+    config.waveGrowth = 0;
+    config.critterHitPoints = scenario.hitPoints;
+    config.spawnInterval = 1;
+    config.spawnBatch = max(1, (scenario.critters + max(scenario.spawnTicks, 1) - 1) / max(scenario.spawnTicks, 1));
+    config.threads = threads;
+    return config;
+}
+
+/**
+ * @brief Places the scenario's towers on free cells close to the path.
+ *
+ * The path cells are collected once; every tower then picks a path cell and a cell within
+ * its range of it, and retries if that cell is path or already taken.
+ *
+ * @param sim Game started from makeStressConfig(scenario).
+ * @param scenario Scenario whose tower count, AoE share and seed are used.
+ * @return Number of towers placed.
+ */
+int placeStressTowers(Simulation& sim, const StressScenario& scenario) {
+    Map& map = sim.getMap();
+    vector<pair<int, int>> path;
+    for (int y = 0; y < map.getHeight(); y++) {
+        for (int x = 0; x < map.getWidth(); x++) {
+            if (map.isPath(x, y)) {
+                path.emplace_back(x, y);
+            }
+        }
+    }
+    if (path.empty()) {
+        return 0;
+    }
+
+    mt19937 rng(scenario.seed ^ 0x5eed7043u);  // Separate stream from the map generator
+    uniform_real_distribution<double> share(0.0, 1.0);
+    PlayerCommand command;
+    command.type = COMMAND_PLACE;
+
+    int placed = 0;
+    long long attempts = 0;
+    long long maxAttempts = 50LL * scenario.towers + 1000;
+    while (placed < scenario.towers && attempts++ < maxAttempts) {
+        command.towerType = share(rng) < scenario.aoeShare ? AOE_TOWER : BASIC_TOWER;
+        int range = getTowerRange(command.towerType);
+        pair<int, int> anchor = path[rng() % path.size()];
+        int dx = static_cast<int>(rng() % (2 * range + 1)) - range;
+        int reach = range - abs(dx);
+        int dy = static_cast<int>(rng() % (2 * reach + 1)) - reach;
+
+        command.x = anchor.first + dx;
+        command.y = anchor.second + dy;
+        if (map.isValidCoordinate(command.x, command.y) && !map.isPath(command.x, command.y) && sim.apply(command)) {
+            placed++;
+        }
+    }
+    return placed;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file StressScenario.h
+ * @brief Seeded large-scale scenarios for driving the engine at production scale.
+ */
+
+#ifndef STRESS_SCENARIO_H
+#define STRESS_SCENARIO_H
+
+#include <string>
+#include <vector>
+#include "Simulation.h"
+
+using namespace std;
+
+/**
+ * @struct StressScenario
+ * @brief Size of a generated game: map, tower layout and wave.
+ *
+ * Everything about the game follows from these fields, so a scenario and its seed reproduce
+ * the same run on every machine.
+ */
+struct StressScenario {
+    string name = "custom";    ///< Preset name, for reports
+    unsigned int seed = 1;     ///< Seed of the map and of the tower layout
+    int width = 64;            ///< Map width in cells (up to 4096)
+    int height = 64;           ///< Map height in cells (up to 4096)
+    int towers = 100;          ///< Towers placed along the path
+    double aoeShare = 0.25;    ///< Fraction of the towers that are AoE towers
+    int critters = 1000;       ///< Critters in every wave
+    int hitPoints = 1000;      ///< Critter hit points, in percent of the standard wave; high enough to keep most of a wave alive
+    int spawnTicks = 100;      ///< Ticks over which a wave spawns, in equal batches
+    int ticks = 2000;          ///< Ticks to simulate
+};
+
+/**
+ * @brief Gets a built-in scenario.
+ *
+ * The presets form a scaling ladder: small (64x64, 100 towers, 1k critters), medium
+ * (512x512, 1k towers, 10k critters), large (2048x2048, 5k towers, 50k critters) and
+ * huge (4096x4096, 10k towers, 100k critters).
+ * @param name Preset name.
+ * @param scenario Receives the preset.
+ * @return True if the preset exists.
+ */
+bool findStressPreset(const string& name, StressScenario& scenario);
+
+/**
+ * @brief Gets the names of the built-in scenarios, smallest first.
+ * @return Preset names.
+ */
+vector<string> getStressPresetNames();
+
+/**
+ * @brief Builds the game configuration of a scenario.
+ *
+ * Gold and health are effectively unlimited, so the whole layout can be bought and the game
+ * runs for every requested tick; every wave holds the same number of critters.
+ * @param scenario Scenario to run.
+ * @param threads Threads of the attack phase.
+ * @return Configuration for a Simulation.
+ */
+SimulationConfig makeStressConfig(const StressScenario& scenario, size_t threads = 1);
+
+/**
+ * @brief Places the scenario's towers on free cells close to the path.
+ *
+ * Each tower goes on a random scenery cell within reach of a random path cell; placement
+ * goes through Simulation::apply, so it is recorded like player input.
+ * @param sim Game started from makeStressConfig(scenario).
+ * @param scenario Scenario whose tower count, AoE share and seed are used.
+ * @return Number of towers placed; lower than requested only if the path runs out of free neighbours.
+ */
+int placeStressTowers(Simulation& sim, const StressScenario& scenario);
+
+#endif // STRESS_SCENARIO_H
@@ -0,0 +1,109 @@
+/**
+ * @file ThreadPool.cpp
+ * @brief Implementation of the ThreadPool class.
+ */
+
+#include "ThreadPool.h"
+#include <algorithm>
+
+/**
+ * @brief Starts a pool.
+ *
+ * @param threadCount Total number of threads, including the caller of run(); 0 picks one per core.
+ */
+ThreadPool::ThreadPool(size_t threadCount)
+        : task(nullptr), taskCount(0), nextTask(0), batchId(0), busyWorkers(0), stopping(false) {
+    if (threadCount == 0) {
+        threadCount = max(1u, thread::hardware_concurrency());
+    }
+
+    for (size_t i = 1; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+/**
+ * @brief Stops and joins every worker.
+ */
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(batchMutex);
+        stopping = true;
+    }
+    batchStarted.notify_all();
+
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+/**
+ * @brief Main loop of a background worker: waits for a batch, helps drain it, repeats.
+ */
+void ThreadPool::workerLoop() {
+    size_t seenBatch = 0;
+
+    while (true) {
+        {
+            unique_lock<mutex> lock(batchMutex);
+            batchStarted.wait(lock, [&] { return stopping || batchId != seenBatch; });
+            if (stopping) {
+                return;
+            }
+            seenBatch = batchId;
+        }
+
+        drainTasks();
+
+        {
+            lock_guard<mutex> lock(batchMutex);
+            busyWorkers--;
+        }
+        batchFinished.notify_one();
+    }
+}
+
+/**
+ * @brief Runs tasks of the current batch until none are left.
+ */
+void ThreadPool::drainTasks() {
+    while (true) {
+        size_t index = nextTask.fetch_add(1, memory_order_relaxed);
+        if (index >= taskCount) {
+            return;
+        }
+        (*task)(index);
+    }
+}
+
+/**
+ * @brief Runs task(0) .. task(count - 1) across the pool and waits for them to finish.
+ *
+ * @param count Number of tasks in the batch.
+ * @param task Function called once with each task index.
+ */
+void ThreadPool::run(size_t count, const function<void(size_t)>& task) {
+    if (workers.empty() || count <= 1) {
+        for (size_t i = 0; i < count; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(batchMutex);
+        this->task = &task;
+        taskCount = count;
+        nextTask.store(0, memory_order_relaxed);
+        busyWorkers = workers.size();
+        batchId++;
+    }
+    batchStarted.notify_all();
+
+    drainTasks();
+
+    // Every worker has to leave the batch before the task reference goes out of scope
+    unique_lock<mutex> lock(batchMutex);
+    batchFinished.wait(lock, [&] { return busyWorkers == 0; });
+    this->task = nullptr;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file ThreadPool.h
+ * @brief Declaration of the ThreadPool class used to spread game work across cores.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @class ThreadPool
+ * @brief Fixed set of worker threads that run batches of indexed tasks.
+ *
+ * A batch is started with run() and handed out to the workers one index at a time; the
+ * calling thread takes part as well, so a pool of size N uses N-1 background threads.
+ * run() returns once every task of the batch has finished.
+ */
+class ThreadPool {
+private:
+    vector<thread> workers;              ///< Background threads (size() - 1 of them)
+    mutex batchMutex;                    ///< Guards the batch state below
+    condition_variable batchStarted;     ///< Signalled when a new batch is published
+    condition_variable batchFinished;    ///< Signalled when a worker leaves a batch
+    const function<void(size_t)>* task;  ///< Task of the current batch
+    size_t taskCount;                    ///< Number of tasks in the current batch
+    atomic<size_t> nextTask;             ///< Next task index to hand out
+    size_t batchId;                      ///< Incremented for every batch
+    size_t busyWorkers;                  ///< Workers still running the current batch
+    bool stopping;                       ///< Set when the pool shuts down
+
+    /** @brief Main loop of a background worker. */
+    void workerLoop();
+
+    /** @brief Runs tasks of the current batch until none are left. */
+    void drainTasks();
+
+public:
+    /**
+     * @brief Starts a pool.
+     * @param threadCount Total number of threads, including the caller of run(); 0 picks one per core.
+     */
+    explicit ThreadPool(size_t threadCount = 0);
+
+    /** @brief Stops and joins every worker. */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /** @brief Gets the number of threads that run a batch, including the caller. */
+    size_t size() const { return workers.size() + 1; }
+
+    /**
+     * @brief Runs task(0) .. task(count - 1) across the pool and waits for them to finish.
+     * @param count Number of tasks in the batch.
+     * @param task Function called once with each task index.
+     */
+    void run(size_t count, const function<void(size_t)>& task);
+};
+
+#endif // THREAD_POOL_H
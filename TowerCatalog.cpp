@@ -0,0 +1,191 @@
+/**
+ * @file TowerCatalog.cpp
+ * @brief Implementation of the TowerCatalog class and its file format.
+ */
+
+#include "TowerCatalog.h"
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include "Zobrist.h"
+
+/// Built-in catalog, in the file format; the standard stats of every tower type.
+static const char* DEFAULT_CATALOG =
+    "basic 1 100  50 3 10 1 2\n"
+    "basic 2  50  75 3 15 1 2\n"
+    "basic 3  50 100 3 20 1 2\n"
+    "aoe   1 200 100 2  7 1 0\n"
+    "aoe   2  75 125 2 12 1 0\n"
+    "aoe   3  75 150 2 17 1 0\n";
+
+/**
+ * @brief Constructs the catalog with the built-in stats.
+ */
+TowerCatalog::TowerCatalog() : levels(), levelCount() {
+    string error;
+    parse(DEFAULT_CATALOG, error);
+}
+
+/**
+ * @brief Gets the process-wide catalog read by the towers.
+ */
+TowerCatalog& TowerCatalog::instance() {
+    static TowerCatalog catalog;
+    return catalog;
+}
+
+/**
+ * @brief Looks up a tower type by its catalog name.
+ *
+ * @param name Type name, as in the interactive commands.
+ * @param type Receives the type.
+ * @return True if the name is known.
+ */
+static bool parseTowerTypeName(const char* name, TowerType& type) {
+    if (strcmp(name, "basic") == 0) {
+        type = BASIC_TOWER;
+    } else if (strcmp(name, "aoe") == 0) {
+        type = AOE_TOWER;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Parses catalog text and replaces the rows of the types it lists.
+ *
+ * The rows are parsed into a copy of the table, which replaces the catalog only once the
+ * whole text has been checked.
+ *
+ * @param text Catalog text.
+ * @param error Receives a description of the first problem, with its line number.
+ * @return True if the text was valid.
+ */
+bool TowerCatalog::parse(const string& text, string& error) {
+    TowerLevelStats parsed[TOWER_TYPE_SLOTS][MAX_TOWER_LEVEL] = {};
+    int parsedCount[TOWER_TYPE_SLOTS] = {};
+    char message[160];
+
+    size_t start = 0;
+    int lineNumber = 0;
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == string::npos) {
+            end = text.size();
+        }
+        string line = text.substr(start, end - start);
+        start = end + 1;
+        lineNumber++;
+
+        size_t comment = line.find('#');
+        if (comment != string::npos) {
+            line.resize(comment);
+        }
+        if (line.find_first_not_of(" \t\r") == string::npos) {
+            continue;
+        }
+
+        char name[16];
+        int level, consumed = 0;
+        TowerLevelStats stats;
+        int fields = sscanf(line.c_str(), " %15s %d %d %d %d %d %d %d %n", name, &level, &stats.cost, &stats.refund,
+                            &stats.range, &stats.power, &stats.fireRate, &stats.projectileSpeed, &consumed);
+        TowerType type;
+        if (fields < 8 || line[consumed] != '\0') {
+            snprintf(message, sizeof(message), "line %d: expected type level cost refund range power fire-rate projectile-speed",
+                     lineNumber);
+        } else if (!parseTowerTypeName(name, type)) {
+            snprintf(message, sizeof(message), "line %d: unknown tower type '%s' (expected basic or aoe)", lineNumber, name);
+        } else if (level != parsedCount[type] + 1 || level > MAX_TOWER_LEVEL) {
+            snprintf(message, sizeof(message), "line %d: expected %s level %d (levels go from 1 to %d, in order)", lineNumber,
+                     name, parsedCount[type] + 1, MAX_TOWER_LEVEL);
+        } else if (stats.cost < 0 || stats.refund < 0 || stats.range < 0 || stats.power < 0 || stats.fireRate < 0
+                   || stats.projectileSpeed < 0) {
+            snprintf(message, sizeof(message), "line %d: stats cannot be negative", lineNumber);
+        } else {
+            parsed[type][level - 1] = stats;
+            parsedCount[type] = level;
+            continue;
+        }
+        error = message;
+        return false;
+    }
+
+    for (int type = 0; type < TOWER_TYPE_SLOTS; type++) {
+        if (parsedCount[type] > 0) {
+            memcpy(levels[type], parsed[type], sizeof(levels[type]));
+            levelCount[type] = parsedCount[type];
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Reads a catalog file and replaces the rows of the types it lists.
+ *
+ * @param path File to read.
+ * @param error Receives a description of the problem if loading fails.
+ * @return True if the file was read and valid.
+ */
+bool TowerCatalog::load(const string& path, string& error) {
+    FILE* file = fopen(path.c_str(), "r");
+    if (file == nullptr) {
+        error = "cannot open file";
+        return false;
+    }
+
+    string text;
+    char buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        text.append(buffer, read);
+    }
+    bool ok = ferror(file) == 0;
+    fclose(file);
+    if (!ok) {
+        error = "read error";
+        return false;
+    }
+    return parse(text, error);
+}
+
+/**
+ * @brief Gets every range a tower can have, over all types and levels.
+ *
+ * @return Distinct ranges in ascending order.
+ */
+vector<int> TowerCatalog::getRanges() const {
+    vector<int> ranges;
+    for (int type = BASIC_TOWER; type < TOWER_TYPE_SLOTS; type++) {
+        for (int level = 0; level < levelCount[type]; level++) {
+            ranges.push_back(levels[type][level].range);
+        }
+    }
+    sort(ranges.begin(), ranges.end());
+    ranges.erase(unique(ranges.begin(), ranges.end()), ranges.end());
+    return ranges;
+}
+
+/**
+ * @brief Gets a hash of every stat of every defined level.
+ *
+ * Folds the level counts and stats, in table order, through splitmix64, so the hash is the
+ * same on every platform and only depends on the defined levels.
+ *
+ * @return Hash of the catalog.
+ */
+uint64_t TowerCatalog::hash() const {
+    uint64_t hash = 0;
+    for (int type = BASIC_TOWER; type < TOWER_TYPE_SLOTS; type++) {
+        hash = splitmix64(hash ^ static_cast<uint64_t>(levelCount[type]));
+        for (int level = 0; level < levelCount[type]; level++) {
+            const TowerLevelStats& stats = levels[type][level];
+            int values[] = {stats.cost, stats.refund, stats.range, stats.power, stats.fireRate, stats.projectileSpeed};
+            for (int value : values) {
+                hash = splitmix64(hash ^ static_cast<uint32_t>(value));
+            }
+        }
+    }
+    return hash;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file TowerCatalog.h
+ * @brief Declaration of the TowerCatalog class, the stats of every tower type and level.
+ */
+
+#ifndef TOWER_CATALOG_H
+#define TOWER_CATALOG_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @enum TowerType
+ * @brief Identifies the concrete tower classes; values match the interactive menu choices.
+ */
+enum TowerType { BASIC_TOWER = 1, AOE_TOWER = 2 };
+
+/// Number of rows of the catalog; TowerType values index it directly, row 0 is unused.
+static const int TOWER_TYPE_SLOTS = 3;
+
+/// Highest level a catalog may define for a tower type.
+static const int MAX_TOWER_LEVEL = 8;
+
+/**
+ * @struct TowerLevelStats
+ * @brief Stats of a tower type at one level.
+ */
+struct TowerLevelStats {
+    int cost;            ///< Gold to reach this level: the purchase price at level 1, the upgrade price above
+    int refund;          ///< Gold refunded when selling a tower of this level
+    int range;           ///< Attack range (Manhattan radius in cells)
+    int power;           ///< Damage per hit
+    int fireRate;        ///< Attack speed (shots per second)
+    int projectileSpeed; ///< Projectile speed in cells per tick (0 = instant hit)
+};
+
+/**
+ * @class TowerCatalog
+ * @brief Dense table of tower stats indexed by type and level.
+ *
+ * Towers only store their position and level and look their stats up here, so balance changes
+ * go into a catalog file instead of the code. The table is a fixed-size array, one row of
+ * levels per type, so a lookup is two index operations. The built-in rows hold the standard
+ * stats; load() replaces the rows of the types a file lists. The catalog is meant to be loaded
+ * once at startup and only read afterwards, when games may run on several threads.
+ */
+class TowerCatalog {
+private:
+    TowerLevelStats levels[TOWER_TYPE_SLOTS][MAX_TOWER_LEVEL]; ///< Stats by type, then by level - 1
+    int levelCount[TOWER_TYPE_SLOTS];                          ///< Number of levels defined per type
+
+public:
+    /** @brief Constructs the catalog with the built-in stats. */
+    TowerCatalog();
+
+    /** @brief Gets the process-wide catalog read by the towers. */
+    static TowerCatalog& instance();
+
+    /**
+     * @brief Parses catalog text and replaces the rows of the types it lists.
+     *
+     * Every non-empty line that is not a # comment reads
+     * "type level cost refund range power fire-rate projectile-speed", with type basic or aoe.
+     * The levels of a type must be listed in order starting at 1. Nothing changes on error.
+     * @param text Catalog text.
+     * @param error Receives a description of the first problem, with its line number.
+     * @return True if the text was valid.
+     */
+    bool parse(const string& text, string& error);
+
+    /**
+     * @brief Reads a catalog file and replaces the rows of the types it lists.
+     * @param path File to read.
+     * @param error Receives a description of the problem if loading fails.
+     * @return True if the file was read and valid.
+     */
+    bool load(const string& path, string& error);
+
+    /**
+     * @brief Gets the stats of a tower type at a level.
+     * @param type Tower type.
+     * @param level Level, from 1 to getMaxLevel(type).
+     * @return Stats of that level.
+     */
+    const TowerLevelStats& get(TowerType type, int level) const { return levels[type][level - 1]; }
+
+    /**
+     * @brief Gets the highest level of a tower type.
+     * @param type Tower type.
+     * @return Number of levels defined for the type.
+     */
+    int getMaxLevel(TowerType type) const { return levelCount[type]; }
+
+    /**
+     * @brief Gets every range a tower can have, over all types and levels.
+     * @return Distinct ranges in ascending order; the ranges maps keep coverage heatmaps for.
+     */
+    vector<int> getRanges() const;
+
+    /**
+     * @brief Gets a hash of every stat of every defined level, e.g. to tell catalogs apart in a replay.
+     * @return Hash that differs between catalogs with any different stat or level count.
+     */
+    uint64_t hash() const;
+};
+
+#endif // TOWER_CATALOG_H
@@ -0,0 +1,144 @@
+/**
+ * @file TowerLayout.cpp
+ * @brief Implementation of tower layout parsing and greedy placement.
+ */
+
+#include "TowerLayout.h"
+#include <cctype>
+
+/**
+ * @brief Gets the attack range of a tower type.
+ *
+ * @param type Tower type.
+ * @return Manhattan range of a level-1 tower of that type.
+ */
+int getTowerRange(TowerType type) {
+    return TowerCatalog::instance().get(type, 1).range;
+}
+
+/**
+ * @brief Gets the purchase cost of a tower type.
+ *
+ * @param type Tower type.
+ * @return Gold needed to buy a tower of that type.
+ */
+int getTowerCost(TowerType type) {
+    return TowerCatalog::instance().get(type, 1).cost;
+}
+
+/**
+ * @brief Gets the damage per hit of a tower type.
+ *
+ * @param type Tower type.
+ * @return Power of a level-1 tower of that type.
+ */
+int getTowerPower(TowerType type) {
+    return TowerCatalog::instance().get(type, 1).power;
+}
+
+/**
+ * @brief Parses a layout such as "3b2a".
+ *
+ * @param text Layout text.
+ * @param types Receives the tower types in buying order.
+ * @return True if the text is a valid, non-empty layout.
+ */
+bool parseLayout(const string& text, vector<TowerType>& types) {
+    vector<TowerType> parsed;
+    size_t i = 0;
+    while (i < text.size()) {
+        int count = 0;
+        bool hasCount = false;
+        while (i < text.size() && isdigit(static_cast<unsigned char>(text[i]))) {
+            count = count * 10 + (text[i++] - '0');
+            hasCount = true;
+            if (count > 10000) {
+                return false;
+            }
+        }
+        if (i == text.size()) {
+            return false;
+        }
+
+        char kind = static_cast<char>(tolower(static_cast<unsigned char>(text[i++])));
+        if (kind != 'b' && kind != 'a') {
+            return false;
+        }
+        parsed.insert(parsed.end(), hasCount ? count : 1, kind == 'a' ? AOE_TOWER : BASIC_TOWER);
+    }
+
+    if (parsed.empty()) {
+        return false;
+    }
+    types = parsed;
+    return true;
+}
+
+/**
+ * @brief Formats tower types in the notation accepted by parseLayout.
+ *
+ * @param types Tower types in buying order.
+ * @return Layout text.
+ */
+string formatLayout(const vector<TowerType>& types) {
+    string text;
+    for (size_t i = 0; i < types.size();) {
+        size_t run = i;
+        while (run < types.size() && types[run] == types[i]) {
+            run++;
+        }
+        text += to_string(run - i) + (types[i] == AOE_TOWER ? "a" : "b");
+        i = run;
+    }
+    return text;
+}
+
+/**
+ * @brief Buys towers in order, each on the free cell that covers the most path for its range.
+ *
+ * Ties go to the first cell in row-major order, so the layout only depends on the map.
+ *
+ * @param sim Game to place the towers in.
+ * @param types Tower types in buying order.
+ * @return Number of towers placed.
+ */
+int placeGreedyLayout(Simulation& sim, const vector<TowerType>& types) {
+    Map& map = sim.getMap();
+    TowerRegistry& towers = sim.getTowers();
+    int placed = 0;
+
+    for (TowerType type : types) {
+        if (getTowerCost(type) > sim.getGold()) {
+            continue;
+        }
+
+        int range = getTowerRange(type);
+        int bestCell = -1;
+        int bestCoverage = -1;
+        for (int y = 0; y < map.getHeight(); y++) {
+            for (int x = 0; x < map.getWidth(); x++) {
+                if (map.isPath(x, y) || towers.findAt(x, y).isValid()) {
+                    continue;
+                }
+                int coverage = map.getCoverage(x, y, range);
+                if (coverage > bestCoverage) {
+                    bestCoverage = coverage;
+                    bestCell = y * map.getWidth() + x;
+                }
+            }
+        }
+        if (bestCell < 0) {
+            break;  // No free cell left
+        }
+
+        PlayerCommand command;
+        command.type = COMMAND_PLACE;
+        command.towerType = type;
+        command.x = bestCell % map.getWidth();
+        command.y = bestCell / map.getWidth();
+        if (sim.apply(command)) {
+            placed++;
+        }
+    }
+    return placed;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file TowerLayout.h
+ * @brief Tower layouts: which towers to buy, and where to put them on a map.
+ */
+
+#ifndef TOWER_LAYOUT_H
+#define TOWER_LAYOUT_H
+
+#include <string>
+#include <vector>
+#include "mapgen.h"
+#include "tower.h"
+#include "Simulation.h"
+
+using namespace std;
+
+/**
+ * @brief Gets the attack range of a tower type.
+ * @param type Tower type.
+ * @return Manhattan range of a level-1 tower of that type.
+ */
+int getTowerRange(TowerType type);
+
+/**
+ * @brief Gets the purchase cost of a tower type.
+ * @param type Tower type.
+ * @return Gold needed to buy a tower of that type.
+ */
+int getTowerCost(TowerType type);
+
+/**
+ * @brief Gets the damage per hit of a tower type.
+ * @param type Tower type.
+ * @return Power of a level-1 tower of that type.
+ */
+int getTowerPower(TowerType type);
+
+/**
+ * @brief Parses a layout such as "3b2a" (three basic towers, then two AoE towers).
+ * @param text Layout text: repeated [count] b|a groups; a missing count means 1.
+ * @param types Receives the tower types in buying order.
+ * @return True if the text is a valid, non-empty layout.
+ */
+bool parseLayout(const string& text, vector<TowerType>& types);
+
+/**
+ * @brief Formats tower types in the notation accepted by parseLayout.
+ * @param types Tower types in buying order.
+ * @return Layout text, e.g. "3b2a".
+ */
+string formatLayout(const vector<TowerType>& types);
+
+/**
+ * @brief Buys towers in order, each on the free cell that covers the most path for its range.
+ *
+ * Towers the player cannot afford are skipped. Placement goes through Simulation::apply, so
+ * it is recorded like player input.
+ * @param sim Game to place the towers in.
+ * @param types Tower types in buying order.
+ * @return Number of towers placed.
+ */
+int placeGreedyLayout(Simulation& sim, const vector<TowerType>& types);
+
+#endif // TOWER_LAYOUT_H
@@ -0,0 +1,272 @@
+/**
+ * @file TowerRegistry.cpp
+ * @brief Implementation of the TowerRegistry class.
+ */
+
+#include "TowerRegistry.h"
+#include <algorithm>
+
+/**
+ * @brief Constructs an empty registry bound to a map.
+ *
+ * @param map Map that receives TOWER cells for placed towers.
+ * @param memory Memory resource the tower slots and indices allocate from.
+ */
+TowerRegistry::TowerRegistry(Map* map, pmr::memory_resource* memory)
+        : map(map), slots(memory), freeSlots(memory), liveTowers(memory), liveSlots(memory), cellToSlot(memory), zobrist(0) {
+}
+
+/**
+ * @brief Destroys every tower still held by the registry.
+ */
+TowerRegistry::~TowerRegistry() {
+    for (uint32_t slotIndex : liveSlots) {
+        slots[slotIndex].tower->~Tower();
+    }
+}
+
+/**
+ * @brief Reserves a free slot, reusing freed slots before growing the pool.
+ *
+ * @return Index of the reserved slot.
+ */
+uint32_t TowerRegistry::acquireSlot() {
+    if (!freeSlots.empty()) {
+        uint32_t slotIndex = freeSlots.back();
+        freeSlots.pop_back();
+        return slotIndex;
+    }
+
+    slots.emplace_back();
+    return static_cast<uint32_t>(slots.size() - 1);
+}
+
+/**
+ * @brief Registers a freshly constructed tower and issues its handle.
+ *
+ * @param slotIndex Slot the tower was constructed in.
+ * @param tower Tower constructed in the slot's storage.
+ * @return Handle to the tower.
+ */
+TowerHandle TowerRegistry::commitSlot(uint32_t slotIndex, Tower* tower) {
+    Slot& slot = slots[slotIndex];
+
+    slot.tower = tower;
+    slot.denseIndex = static_cast<uint32_t>(liveTowers.size());
+    liveTowers.push_back(tower);
+    liveSlots.push_back(slotIndex);
+    cellToSlot[cellKey(tower->getX(), tower->getY())] = slotIndex;
+    tower->attachStateHash(&zobrist);
+
+    return TowerHandle{slotIndex, slot.generation};
+}
+
+/**
+ * @brief Resolves a handle to its slot.
+ *
+ * @param handle Handle to resolve.
+ * @return Pointer to the slot, or nullptr if the handle is stale.
+ */
+TowerRegistry::Slot* TowerRegistry::resolve(TowerHandle handle) {
+    if (handle.index >= slots.size()) {
+        return nullptr;
+    }
+
+    Slot& slot = slots[handle.index];
+    if (slot.tower == nullptr || slot.generation != handle.generation) {
+        return nullptr;
+    }
+    return &slot;
+}
+
+/**
+ * @brief Places a new tower of the given type on the map.
+ *
+ * @param type Type of tower to construct.
+ * @param x X-coordinate of the tower.
+ * @param y Y-coordinate of the tower.
+ * @return Handle to the new tower, or an invalid handle if the placement failed.
+ */
+TowerHandle TowerRegistry::place(TowerType type, int x, int y) {
+    switch (type) {
+        case BASIC_TOWER:
+            return place<BasicTower>(x, y);
+        case AOE_TOWER:
+            return place<AoETower>(x, y);
+    }
+    return TowerHandle();
+}
+
+/**
+ * @brief Looks up the tower behind a handle.
+ *
+ * @param handle Handle issued by place().
+ * @return Pointer to the tower, or nullptr if it has been sold or removed.
+ */
+Tower* TowerRegistry::get(TowerHandle handle) {
+    Slot* slot = resolve(handle);
+    return slot ? slot->tower : nullptr;
+}
+
+/**
+ * @brief Finds the tower standing on a cell.
+ *
+ * @param x X-coordinate of the cell.
+ * @param y Y-coordinate of the cell.
+ * @return Handle to the tower, or an invalid handle if the cell is empty.
+ */
+TowerHandle TowerRegistry::findAt(int x, int y) const {
+    if (!map->isValidCoordinate(x, y)) {
+        return TowerHandle();
+    }
+
+    auto it = cellToSlot.find(cellKey(x, y));
+    if (it == cellToSlot.end()) {
+        return TowerHandle();
+    }
+    return TowerHandle{it->second, slots[it->second].generation};
+}
+
+/**
+ * @brief Upgrades the tower behind a handle.
+ *
+ * @param handle Handle of the tower.
+ * @return True if the tower was upgraded, false otherwise.
+ */
+bool TowerRegistry::upgrade(TowerHandle handle) {
+    Tower* tower = get(handle);
+    return tower != nullptr && tower->upgrade();
+}
+
+/**
+ * @brief Sells a tower, removing it from the map.
+ *
+ * @param handle Handle of the tower.
+ * @return Gold refunded for the tower, or 0 if the handle is stale.
+ */
+int TowerRegistry::sell(TowerHandle handle) {
+    Tower* tower = get(handle);
+    if (tower == nullptr) {
+        return 0;
+    }
+
+    int refund = tower->getRefundValue();
+    remove(handle);
+    return refund;
+}
+
+/**
+ * @brief Removes a tower without refunding it.
+ *
+ * The last live tower is swapped into the removed tower's dense position, so removal is O(1).
+ *
+ * @param handle Handle of the tower.
+ * @return True if a tower was removed, false if the handle is stale.
+ */
+bool TowerRegistry::remove(TowerHandle handle) {
+    Slot* slot = resolve(handle);
+    if (slot == nullptr) {
+        return false;
+    }
+
+    Tower* tower = slot->tower;
+    map->removeTower(tower->getX(), tower->getY());
+    cellToSlot.erase(cellKey(tower->getX(), tower->getY()));
+
+    // Swap-remove from the dense arrays
+    uint32_t hole = slot->denseIndex;
+    uint32_t last = static_cast<uint32_t>(liveTowers.size() - 1);
+    if (hole != last) {
+        liveTowers[hole] = liveTowers[last];
+        liveSlots[hole] = liveSlots[last];
+        slots[liveSlots[hole]].denseIndex = hole;
+    }
+    liveTowers.pop_back();
+    liveSlots.pop_back();
+
+    tower->attachStateHash(nullptr);
+    tower->~Tower();
+    slot->tower = nullptr;
+    slot->generation++;
+    freeSlots.push_back(handle.index);
+    return true;
+}
+
+/**
+ * @brief Removes every tower from the registry and the map.
+ */
+void TowerRegistry::clear() {
+    while (!liveSlots.empty()) {
+        uint32_t slotIndex = liveSlots.back();
+        remove(TowerHandle{slotIndex, slots[slotIndex].generation});
+    }
+}
+
+/// Critter count from which the attack phase goes through a CritterIndex instead of a linear scan.
+static const size_t INDEX_MIN_CRITTERS = 64;
+
+/**
+ * @brief Runs the attack phase of every live tower.
+ *
+ * Once there are enough critters, a spatial index is built first and every tower only
+ * queries the buckets around it; targets are the same as with the linear scan.
+ *
+ * @param critters Active critters, read-only during the phase.
+ * @param hits Damage buffer that receives every hit; it is reset first.
+ * @param pool Optional worker pool; nullptr runs the phase on the calling thread.
+ */
+void TowerRegistry::attackAll(ConstCritterSpan critters, DamageBuffer& hits, ThreadPool* pool) {
+    hits.reset(critters.size());
+
+    bool indexed = critters.size() >= INDEX_MIN_CRITTERS && !liveTowers.empty();
+    if (indexed) {
+        critterIndex.build(critters, map->getWidth(), map->getHeight());
+    }
+    auto attackOne = [&](Tower* tower, DamageBuffer& out) {
+        if (indexed) {
+            tower->attack(critterIndex, out);
+        } else {
+            tower->attack(critters, out);
+        }
+    };
+
+    size_t ranges = pool ? min(pool->size(), liveTowers.size()) : 1;
+    if (ranges <= 1) {
+        for (Tower* tower : liveTowers) {
+            attackOne(tower, hits);
+        }
+        return;
+    }
+
+    if (workerHits.size() < ranges) {
+        workerHits.resize(ranges);
+    }
+
+    size_t towerCount = liveTowers.size();
+    pool->run(ranges, [&](size_t range) {
+        size_t begin = towerCount * range / ranges;
+        size_t end = towerCount * (range + 1) / ranges;
+
+        DamageBuffer& local = workerHits[range];
+        local.reset(critters.size());
+        for (size_t i = begin; i < end; i++) {
+            attackOne(liveTowers[i], local);
+        }
+    });
+
+    // Merge in range order so the touched-slot order is the same on every run
+    for (size_t range = 0; range < ranges; range++) {
+        hits.merge(workerHits[range]);
+    }
+}
+
+/**
+ * @brief Gets the handle of the i-th live tower.
+ *
+ * @param denseIndex Index into getTowers().
+ * @return Handle to that tower.
+ */
+TowerHandle TowerRegistry::handleAt(size_t denseIndex) const {
+    uint32_t slotIndex = liveSlots[denseIndex];
+    return TowerHandle{slotIndex, slots[slotIndex].generation};
+}
@@ -0,0 +1,232 @@
+/**
+ * @file TowerRegistry.h
+ * @brief Declaration of the TowerRegistry class that owns every tower placed on the map.
+ */
+
+#ifndef TOWER_REGISTRY_H
+#define TOWER_REGISTRY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory_resource>
+#include <new>
+#include <unordered_map>
+#include <vector>
+#include "mapgen.h"
+#include "tower.h"
+#include "DamageBuffer.h"
+#include "CritterIndex.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+/**
+ * @struct TowerHandle
+ * @brief Generational reference to a tower stored in a TowerRegistry.
+ *
+ * A handle stays cheap to copy and safe to keep around: once the tower it refers to is
+ * sold or removed, the slot's generation changes and the handle simply stops resolving.
+ * Subsystems that remember towers (targeting caches, analytics, ...) should hold handles
+ * instead of raw Tower pointers.
+ */
+struct TowerHandle {
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    uint32_t index = INVALID_INDEX; ///< Slot index inside the registry
+    uint32_t generation = 0;        ///< Generation of the slot when the handle was issued
+
+    /** @brief Checks if the handle was ever issued by a registry. */
+    bool isValid() const { return index != INVALID_INDEX; }
+
+    bool operator==(const TowerHandle& other) const {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const TowerHandle& other) const { return !(*this == other); }
+};
+
+/**
+ * @class TowerRegistry
+ * @brief Pooled storage for all towers on a map.
+ *
+ * Towers are constructed in place inside fixed-size slots that are recycled through a free
+ * list, so placing and selling towers does not hit the heap once the pool has grown. Live
+ * towers are also kept in a dense array for fast iteration during the attack phase; removal
+ * swaps the last live tower into the hole, which keeps selling O(1).
+ *
+ * The registry keeps the map in sync: placing a tower puts it on the map's tower overlay, so
+ * its cell reads as TOWER, and removing it uncovers the terrain underneath, which is PATH for
+ * a tower standing on the route of an open-field map.
+ */
+class TowerRegistry {
+private:
+    /// Size of a slot; large enough to hold any of the concrete tower types.
+    static constexpr size_t SLOT_SIZE = sizeof(BasicTower) > sizeof(AoETower) ? sizeof(BasicTower) : sizeof(AoETower);
+
+    /**
+     * @struct Slot
+     * @brief Storage for one pooled tower.
+     */
+    struct Slot {
+        alignas(alignof(max_align_t)) unsigned char storage[SLOT_SIZE]; ///< Raw storage for the tower
+        Tower* tower = nullptr;   ///< Tower constructed in storage, or nullptr if the slot is free
+        uint32_t generation = 0;  ///< Bumped every time the slot is freed
+        uint32_t denseIndex = 0;  ///< Position in liveTowers while occupied
+    };
+
+    Map* map;                                ///< Map whose TOWER cells mirror the registry
+    pmr::deque<Slot> slots;                       ///< Slot pool; a deque keeps slot addresses stable as it grows
+    pmr::vector<uint32_t> freeSlots;              ///< Indices of unoccupied slots
+    pmr::vector<Tower*> liveTowers;               ///< Dense list of live towers
+    pmr::vector<uint32_t> liveSlots;              ///< Slot index of each entry in liveTowers
+    pmr::unordered_map<int, uint32_t> cellToSlot; ///< Slot index of the tower on each occupied cell
+    vector<DamageBuffer> workerHits;         ///< Thread-local hit buffers reused by attackAll
+    CritterIndex critterIndex;               ///< Spatial index of the critters, rebuilt by attackAll on crowded ticks
+    uint64_t zobrist;                        ///< XOR of the Zobrist keys of the live towers
+
+    /**
+     * @brief Reserves a free slot, growing the pool if needed.
+     * @return Index of the reserved slot.
+     */
+    uint32_t acquireSlot();
+
+    /**
+     * @brief Registers a freshly constructed tower and issues its handle.
+     * @param slotIndex Slot the tower was constructed in.
+     * @param tower Tower constructed in the slot's storage.
+     * @return Handle to the tower.
+     */
+    TowerHandle commitSlot(uint32_t slotIndex, Tower* tower);
+
+    /**
+     * @brief Resolves a handle to its slot.
+     * @return Pointer to the slot, or nullptr if the handle is stale.
+     */
+    Slot* resolve(TowerHandle handle);
+
+    /** @brief Computes the cell key used by cellToSlot. */
+    int cellKey(int x, int y) const { return y * map->getWidth() + x; }
+
+public:
+    /**
+     * @brief Constructs an empty registry bound to a map.
+     * @param map Map that receives TOWER cells for placed towers.
+     * @param memory Memory resource the tower slots and indices allocate from.
+     */
+    explicit TowerRegistry(Map* map, pmr::memory_resource* memory = pmr::get_default_resource());
+
+    /** @brief Destroys every tower still held by the registry. */
+    ~TowerRegistry();
+
+    TowerRegistry(const TowerRegistry&) = delete;
+    TowerRegistry& operator=(const TowerRegistry&) = delete;
+
+    /**
+     * @brief Places a new tower of type T on the map.
+     * @param x X-coordinate of the tower.
+     * @param y Y-coordinate of the tower.
+     * @return Handle to the new tower, or an invalid handle if the map rejected the cell.
+     */
+    template <class T>
+    TowerHandle place(int x, int y) {
+        static_assert(sizeof(T) <= SLOT_SIZE, "Tower type does not fit in a registry slot");
+        static_assert(alignof(T) <= alignof(max_align_t), "Tower type is over-aligned for a registry slot");
+
+        if (!map->placeTower(x, y)) {
+            return TowerHandle();
+        }
+
+        uint32_t slotIndex = acquireSlot();
+        Tower* tower = new (slots[slotIndex].storage) T(x, y);
+        return commitSlot(slotIndex, tower);
+    }
+
+    /**
+     * @brief Places a new tower of the given type on the map.
+     * @param type Type of tower to construct.
+     * @param x X-coordinate of the tower.
+     * @param y Y-coordinate of the tower.
+     * @return Handle to the new tower, or an invalid handle if the type is unknown or the map rejected the cell.
+     */
+    TowerHandle place(TowerType type, int x, int y);
+
+    /**
+     * @brief Looks up the tower behind a handle.
+     * @param handle Handle issued by place().
+     * @return Pointer to the tower, or nullptr if it has been sold or removed.
+     */
+    Tower* get(TowerHandle handle);
+
+    /**
+     * @brief Finds the tower standing on a cell.
+     * @param x X-coordinate of the cell.
+     * @param y Y-coordinate of the cell.
+     * @return Handle to the tower, or an invalid handle if the cell is empty.
+     */
+    TowerHandle findAt(int x, int y) const;
+
+    /**
+     * @brief Upgrades the tower behind a handle.
+     * @param handle Handle of the tower.
+     * @return True if the tower was upgraded, false if the handle is stale or the tower is maxed out.
+     */
+    bool upgrade(TowerHandle handle);
+
+    /**
+     * @brief Sells a tower, removing it from the map.
+     * @param handle Handle of the tower.
+     * @return Gold refunded for the tower, or 0 if the handle is stale.
+     */
+    int sell(TowerHandle handle);
+
+    /**
+     * @brief Removes a tower without refunding it.
+     * @param handle Handle of the tower.
+     * @return True if a tower was removed, false if the handle is stale.
+     */
+    bool remove(TowerHandle handle);
+
+    /** @brief Removes every tower from the registry and the map. */
+    void clear();
+
+    /**
+     * @brief Gets the Zobrist hash of the live towers' cells, types and levels.
+     * Maintained in O(1) by place, remove and Tower::upgrade, and independent of placement order.
+     * @return Current hash; 0 when no tower is placed.
+     */
+    uint64_t getZobrist() const { return zobrist; }
+
+    /** @brief Gets the number of live towers. */
+    size_t size() const { return liveTowers.size(); }
+
+    /** @brief Checks if no towers are placed. */
+    bool empty() const { return liveTowers.empty(); }
+
+    /**
+     * @brief Gets the dense list of live towers for iteration.
+     * @return Reference to the live tower list; invalidated by place, sell and remove.
+     */
+    const pmr::vector<Tower*>& getTowers() const { return liveTowers; }
+
+    /**
+     * @brief Runs the attack phase of every live tower.
+     *
+     * With a pool, the towers are split into one contiguous range per pool thread. Each range
+     * records its hits into its own buffer and the buffers are merged in range order once all
+     * of them are done, so the result is identical to a single-threaded run. On crowded ticks
+     * the towers query a CritterIndex instead of scanning every critter.
+     * @param critters Active critters, read-only during the phase.
+     * @param hits Damage buffer that receives every hit; it is reset first.
+     * @param pool Optional worker pool; nullptr runs the phase on the calling thread.
+     */
+    void attackAll(ConstCritterSpan critters, DamageBuffer& hits, ThreadPool* pool = nullptr);
+
+    /**
+     * @brief Gets the handle of the i-th live tower.
+     * @param denseIndex Index into getTowers().
+     * @return Handle to that tower.
+     */
+    TowerHandle handleAt(size_t denseIndex) const;
+};
+
+#endif // TOWER_REGISTRY_H
@@ -0,0 +1,76 @@
+/**
+ * @file TripleBuffer.h
+ * @brief Declaration of the TripleBuffer class template that passes the latest state between two threads.
+ */
+
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+using namespace std;
+
+/**
+ * @class TripleBuffer
+ * @brief Lock-free exchange of the most recent value from one writer thread to one reader thread.
+ *
+ * Three slots rotate between the writer (back), the reader (front) and a shared middle slot.
+ * The writer fills its back slot and publish() swaps it with the middle one; the reader's
+ * update() swaps its front slot with the middle one if something new was published since.
+ * Each swap is a single atomic exchange, so neither side ever waits for the other: the
+ * writer never overwrites the slot being read, and the reader always gets the newest
+ * complete value, skipping any it was too slow to see.
+ *
+ * Slots are reused rather than reconstructed, so a value type holding vectors keeps its
+ * capacity and the steady state allocates nothing.
+ */
+template <typename T>
+class TripleBuffer {
+private:
+    static constexpr uint8_t INDEX_MASK = 3;  ///< Bits of the middle word holding a slot index
+    static constexpr uint8_t FRESH = 4;       ///< Set in the middle word when it holds an unread value
+
+    T slots[3];                               ///< The three rotating values
+    alignas(64) uint8_t backIndex;            ///< Slot owned by the writer
+    alignas(64) atomic<uint8_t> middle;       ///< Shared slot index, plus FRESH
+    alignas(64) uint8_t frontIndex;           ///< Slot owned by the reader
+
+public:
+    /** @brief Constructs a buffer of three default-constructed slots, none published yet. */
+    TripleBuffer() : backIndex(0), middle(1), frontIndex(2) {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    /**
+     * @brief Gets the slot the writer fills next; writer thread only.
+     * @return Back slot; it holds an older value, which may be reused or overwritten.
+     */
+    T& back() { return slots[backIndex]; }
+
+    /** @brief Makes the back slot the newest value and takes a new back slot; writer thread only. */
+    void publish() {
+        backIndex = middle.exchange(static_cast<uint8_t>(backIndex | FRESH), memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    /**
+     * @brief Takes the newest published value, if any arrived since the last call; reader thread only.
+     * @return True if front() changed.
+     */
+    bool update() {
+        if ((middle.load(memory_order_relaxed) & FRESH) == 0) {
+            return false;
+        }
+        frontIndex = middle.exchange(frontIndex, memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    /**
+     * @brief Gets the value the reader currently holds; reader thread only.
+     * @return Front slot; default-constructed until the first update() that returns true.
+     */
+    const T& front() const { return slots[frontIndex]; }
+};
+
+#endif // TRIPLE_BUFFER_H
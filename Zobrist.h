@@ -0,0 +1,66 @@
+/**
+ * @file Zobrist.h
+ * @brief Zobrist keys for incremental hashing of game state.
+ *
+ * A Zobrist hash is the XOR of one pseudo-random key per (feature, value) present in the state.
+ * XOR is its own inverse, so a change is applied in O(1) by XORing the old feature's key out
+ * and the new one in, and the result does not depend on the order the features were added.
+ *
+ * Keys are derived on the fly with the splitmix64 finalizer instead of read from a random
+ * table: the same state hashes the same on every run, thread and platform, and no table has
+ * to be sized for the map.
+ */
+
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <cstdint>
+
+/**
+ * @enum ZobristDomain
+ * @brief Separates the key spaces of the different kinds of state features.
+ */
+enum ZobristDomain : uint64_t {
+    ZOBRIST_CELL = 1,          ///< Map cell type at (x, y)
+    ZOBRIST_ENDPOINT = 2,      ///< Map entry or exit point
+    ZOBRIST_TOWER = 3,         ///< Tower type and level at (x, y)
+    ZOBRIST_CRITTER_HP = 4,    ///< Hit points of a critter, by identifier
+    ZOBRIST_CRITTER_CELL = 5,  ///< Position of a critter, by identifier
+    ZOBRIST_SCALAR = 6,        ///< Counters such as tick, gold or health
+    ZOBRIST_PROJECTILE = 7     ///< Shot in flight, by position in the projectile pool
+};
+
+/**
+ * @brief splitmix64 finalizer: a fast bijective mix of 64 bits.
+ * @param z Value to mix.
+ * @return Mixed value.
+ */
+inline uint64_t splitmix64(uint64_t z) {
+    z += 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief Gets the Zobrist key of a state feature.
+ * @param domain Kind of feature.
+ * @param a First coordinate of the feature, e.g. a cell index or critter identifier.
+ * @param b Value of the feature, e.g. a cell type or hit points.
+ * @return Pseudo-random 64-bit key.
+ */
+inline uint64_t zobristKey(ZobristDomain domain, uint64_t a, uint64_t b) {
+    return splitmix64(splitmix64(splitmix64(domain) ^ a) ^ b);
+}
+
+/**
+ * @brief Packs a cell position into one key coordinate.
+ * @param x X-coordinate of the cell.
+ * @param y Y-coordinate of the cell.
+ * @return Coordinate independent of the map's width.
+ */
+inline uint64_t zobristCell(int x, int y) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(y)) << 32) | static_cast<uint32_t>(x);
+}
+
+#endif // ZOBRIST_H
@@ -0,0 +1,277 @@
+/**
+ * @file batch.cpp
+ * @brief Monte Carlo batch runner that measures how well tower layouts survive random maps.
+ *
+ * Usage: td_batch [--games N] [--seed N] [--layout TEXT]... [--max-waves N] [--width N]
+ *                 [--height N] [--gold N] [--health N] [--threads N] [--csv FILE] [--json FILE]
+ *                 [--catalog FILE]
+ *
+ * For every --layout (e.g. 5b or 2b1a), plays --games headless games on the maps of seeds
+ * --seed, --seed + 1, ... until the player dies or survives --max-waves waves. Every game
+ * owns its Simulation (map, critters, towers) and shares nothing mutable with the others,
+ * so games are simply handed out to the worker threads one at a time. The results are
+ * aggregated into survival rates and percentiles of waves survived, gold and leaks.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "Simulation.h"
+#include "TowerLayout.h"
+#include "TowerCatalog.h"
+#include "ThreadPool.h"
+#include "Logger.h"
+
+using namespace std;
+
+/**
+ * @struct GameResult
+ * @brief Outcome of one simulated game.
+ */
+struct GameResult {
+    unsigned int seed = 0;   ///< Seed of the map
+    int towers = 0;          ///< Towers the layout managed to place
+    int wavesSurvived = 0;   ///< Waves fully cleared
+    bool survived = false;   ///< True if the player was still alive after the last wave
+    int gold = 0;            ///< Gold at the end of the game
+    int leaks = 0;           ///< Critters that reached the exit
+    int kills = 0;           ///< Critters killed
+    uint64_t ticks = 0;      ///< Ticks simulated
+};
+
+/**
+ * @struct Percentiles
+ * @brief Distribution summary of one metric.
+ */
+struct Percentiles {
+    double mean = 0.0;
+    int p5 = 0, p25 = 0, p50 = 0, p75 = 0, p95 = 0;
+};
+
+/**
+ * @brief Plays one game of a layout on one map.
+ * @param config Game configuration, with the seed of this game.
+ * @param layout Towers to buy before the first wave.
+ * @param maxWaves Number of waves to survive.
+ * @return Outcome of the game.
+ */
+static GameResult playGame(const SimulationConfig& config, const vector<TowerType>& layout, int maxWaves) {
+    const int STEP_TICKS = 32;
+    const uint64_t MAX_TICKS_PER_WAVE = 20000;  // Guards against critters stuck on a broken path
+
+    Simulation sim(config);
+    GameResult result;
+    result.seed = config.seed;
+    result.towers = placeGreedyLayout(sim, layout);
+
+    uint64_t tickLimit = MAX_TICKS_PER_WAVE * static_cast<uint64_t>(maxWaves);
+    while (!sim.isGameOver() && sim.getWave() <= maxWaves && sim.getTick() < tickLimit) {
+        sim.step(STEP_TICKS);
+    }
+
+    result.survived = !sim.isGameOver() && sim.getWave() > maxWaves;
+    result.wavesSurvived = min(sim.getWave() - 1, maxWaves);
+    result.gold = sim.getGold();
+    result.leaks = sim.getLeaks();
+    result.kills = sim.getKills();
+    result.ticks = sim.getTick();
+    return result;
+}
+
+/**
+ * @brief Summarizes one metric over all games with nearest-rank percentiles.
+ */
+static Percentiles summarize(vector<int> values) {
+    Percentiles result;
+    if (values.empty()) {
+        return result;
+    }
+
+    sort(values.begin(), values.end());
+    auto rank = [&values](double percentile) {
+        size_t index = static_cast<size_t>(ceil(percentile / 100.0 * values.size()));
+        return values[index > 0 ? index - 1 : 0];
+    };
+
+    double sum = 0.0;
+    for (int value : values) {
+        sum += value;
+    }
+    result.mean = sum / values.size();
+    result.p5 = rank(5);
+    result.p25 = rank(25);
+    result.p50 = rank(50);
+    result.p75 = rank(75);
+    result.p95 = rank(95);
+    return result;
+}
+
+/**
+ * @brief Prints one metric's distribution as a table row.
+ */
+static void printRow(const char* name, const Percentiles& p) {
+    printf("  %-8s mean %8.1f   p5 %6d  p25 %6d  p50 %6d  p75 %6d  p95 %6d\n", name, p.mean, p.p5, p.p25, p.p50,
+           p.p75, p.p95);
+}
+
+/**
+ * @brief Writes one metric's distribution as a JSON object.
+ */
+static void writeJSONPercentiles(FILE* file, const char* name, const Percentiles& p, bool last) {
+    fprintf(file, "      \"%s\": {\"mean\": %.2f, \"p5\": %d, \"p25\": %d, \"p50\": %d, \"p75\": %d, \"p95\": %d}%s\n",
+            name, p.mean, p.p5, p.p25, p.p50, p.p75, p.p95, last ? "" : ",");
+}
+
+int main(int argc, char* argv[]) {
+    SimulationConfig config;
+    int games = 1000;
+    unsigned int firstSeed = 1;
+    int maxWaves = 20;
+    size_t threads = 0;
+    vector<vector<TowerType>> layouts;
+    string csvPath;
+    string jsonPath;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--games") == 0 && hasValue) {
+            games = max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            firstSeed = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "--layout") == 0 && hasValue) {
+            vector<TowerType> layout;
+            if (!parseLayout(argv[++i], layout)) {
+                fprintf(stderr, "Invalid layout: %s (expected e.g. 3b2a)\n", argv[i]);
+                return 1;
+            }
+            layouts.push_back(layout);
+        } else if (strcmp(argv[i], "--max-waves") == 0 && hasValue) {
+            maxWaves = max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "--width") == 0 && hasValue) {
+            config.width = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--height") == 0 && hasValue) {
+            config.height = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--gold") == 0 && hasValue) {
+            config.startingGold = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--health") == 0 && hasValue) {
+            config.startingHealth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = static_cast<size_t>(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--catalog") == 0 && hasValue) {
+            string error;
+            if (!TowerCatalog::instance().load(argv[++i], error)) {
+                fprintf(stderr, "Cannot load tower catalog %s: %s\n", argv[i], error.c_str());
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--csv") == 0 && hasValue) {
+            csvPath = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0 && hasValue) {
+            jsonPath = argv[++i];
+        } else {
+            fprintf(stderr, "Unknown or incomplete option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (layouts.empty()) {
+        layouts.push_back(vector<TowerType>(5, BASIC_TOWER));
+    }
+
+    // Games run on the batch threads; each simulation stays single-threaded
+    Logger::instance().setLevel(LOG_OFF);
+    config.threads = 1;
+    ThreadPool pool(threads);
+
+    FILE* csv = nullptr;
+    if (!csvPath.empty()) {
+        csv = fopen(csvPath.c_str(), "w");
+        if (csv == nullptr) {
+            fprintf(stderr, "Could not write %s\n", csvPath.c_str());
+            return 1;
+        }
+        fprintf(csv, "layout,seed,towers,waves_survived,survived,gold,leaks,kills,ticks\n");
+    }
+    FILE* json = nullptr;
+    if (!jsonPath.empty()) {
+        json = fopen(jsonPath.c_str(), "w");
+        if (json == nullptr) {
+            fprintf(stderr, "Could not write %s\n", jsonPath.c_str());
+            return 1;
+        }
+        fprintf(json, "{\n  \"games\": %d,\n  \"first_seed\": %u,\n  \"max_waves\": %d,\n  \"map\": \"%dx%d\",\n"
+                      "  \"layouts\": [\n", games, firstSeed, maxWaves, config.width, config.height);
+    }
+
+    printf("%d games per layout, seeds %u..%u, %dx%d maps, up to %d waves, %zu threads\n", games, firstSeed,
+           firstSeed + games - 1, config.width, config.height, maxWaves, pool.size());
+
+    for (size_t l = 0; l < layouts.size(); l++) {
+        const vector<TowerType>& layout = layouts[l];
+        vector<GameResult> results(games);
+
+        auto start = chrono::steady_clock::now();
+        pool.run(static_cast<size_t>(games), [&](size_t game) {
+            SimulationConfig gameConfig = config;
+            gameConfig.seed = firstSeed + static_cast<unsigned int>(game);
+            results[game] = playGame(gameConfig, layout, maxWaves);
+        });
+        auto end = chrono::steady_clock::now();
+        double seconds = chrono::duration<double>(end - start).count();
+
+        int survivors = 0;
+        uint64_t ticks = 0;
+        vector<int> waves, gold, leaks;
+        for (const GameResult& result : results) {
+            survivors += result.survived;
+            ticks += result.ticks;
+            waves.push_back(result.wavesSurvived);
+            gold.push_back(result.gold);
+            leaks.push_back(result.leaks);
+        }
+        Percentiles wavePercentiles = summarize(waves);
+        Percentiles goldPercentiles = summarize(gold);
+        Percentiles leakPercentiles = summarize(leaks);
+        double survivalRate = 100.0 * survivors / games;
+        string name = formatLayout(layout);
+
+        printf("\nlayout %s: survival %.1f%% (%d/%d)  %.0f games/s  %.0f ticks/s\n", name.c_str(), survivalRate,
+               survivors, games, games / seconds, ticks / seconds);
+        printRow("waves", wavePercentiles);
+        printRow("gold", goldPercentiles);
+        printRow("leaks", leakPercentiles);
+
+        if (csv != nullptr) {
+            for (const GameResult& result : results) {
+                fprintf(csv, "%s,%u,%d,%d,%d,%d,%d,%d,%llu\n", name.c_str(), result.seed, result.towers,
+                        result.wavesSurvived, result.survived ? 1 : 0, result.gold, result.leaks, result.kills,
+                        static_cast<unsigned long long>(result.ticks));
+            }
+        }
+        if (json != nullptr) {
+            fprintf(json, "    {\n      \"layout\": \"%s\",\n      \"survival_rate\": %.4f,\n      \"seconds\": %.3f,\n",
+                    name.c_str(), survivalRate / 100.0, seconds);
+            writeJSONPercentiles(json, "waves_survived", wavePercentiles, false);
+            writeJSONPercentiles(json, "gold", goldPercentiles, false);
+            writeJSONPercentiles(json, "leaks", leakPercentiles, true);
+            fprintf(json, "    }%s\n", l + 1 < layouts.size() ? "," : "");
+        }
+    }
+
+    bool ok = true;
+    if (csv != nullptr) {
+        ok = fclose(csv) == 0 && ok;
+    }
+    if (json != nullptr) {
+        fprintf(json, "  ]\n}\n");
+        ok = fclose(json) == 0 && ok;
+    }
+    if (!ok) {
+        fprintf(stderr, "Could not finish writing the result files\n");
+        return 1;
+    }
+    return 0;
+}
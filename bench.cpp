@@ -0,0 +1,529 @@
+/**
+ * @file bench.cpp
+ * @brief Microbenchmark suite for the hot paths of the engine.
+ *
+ * Usage: td_bench [--filter TEXT] [--min-time MS] [--repetitions N] [--json FILE] [--quick]
+ *
+ * Every benchmark runs at several problem sizes. Each size is calibrated until a batch of
+ * iterations takes at least --min-time, then timed --repetitions times; the median and the
+ * fastest repetition are reported per operation. With --json, the results are also written
+ * as machine-readable JSON so scaling curves can be tracked across commits.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "mapgen.h"
+#include "critter.h"
+#include "CritterGroup.h"
+#include "tower.h"
+#include "TowerRegistry.h"
+#include "DamageBuffer.h"
+#include "DistanceField.h"
+#include "MapGenerator.h"
+#include "PathHierarchy.h"
+#include "Logger.h"
+
+using namespace std;
+
+/**
+ * @brief Runs a benchmark body for a number of iterations.
+ *
+ * The body times itself and returns the measured nanoseconds, so it can keep per-iteration
+ * setup (copying fresh state, resetting buffers) out of the measurement.
+ */
+using BenchBody = function<double(long iterations)>;
+
+/**
+ * @struct BenchResult
+ * @brief Timing of one benchmark at one problem size.
+ */
+struct BenchResult {
+    string name;                          ///< Benchmark name, e.g. "critter_group/move_all"
+    vector<pair<string, long>> params;    ///< Problem size, e.g. {"critters", 1000}
+    long iterations = 0;                  ///< Iterations per repetition
+    double medianNs = 0.0;                ///< Median time per iteration
+    double minNs = 0.0;                   ///< Fastest repetition's time per iteration
+    long itemsPerIteration = 0;           ///< Items processed per iteration, for throughput
+};
+
+/**
+ * @struct BenchOptions
+ * @brief Command-line options of the suite.
+ */
+struct BenchOptions {
+    string filter;          ///< Only run benchmarks whose name contains this text
+    double minTimeMs = 50;  ///< Minimum duration of a timed batch
+    int repetitions = 5;    ///< Timed batches per size
+    bool quick = false;     ///< Only run the smaller sizes
+};
+
+/**
+ * @brief Calibrates and times one benchmark at one size.
+ * @param options Suite options.
+ * @param body Benchmark body.
+ * @return Result with the name and params left empty.
+ */
+static BenchResult measure(const BenchOptions& options, const BenchBody& body) {
+    long iterations = 1;
+    double elapsed = body(iterations);
+    while (elapsed < options.minTimeMs * 1e6 && iterations < (1L << 30)) {
+        // Aim slightly past the target so calibration converges in a couple of rounds
+        double perIteration = max(elapsed / iterations, 1.0);
+        long next = static_cast<long>(options.minTimeMs * 1e6 * 1.2 / perIteration);
+        iterations = max(iterations * 2, min(next, iterations * 100));
+        elapsed = body(iterations);
+    }
+
+    vector<double> samples;
+    for (int r = 0; r < options.repetitions; r++) {
+        samples.push_back(body(iterations) / iterations);
+    }
+    sort(samples.begin(), samples.end());
+
+    BenchResult result;
+    result.iterations = iterations;
+    result.medianNs = samples[samples.size() / 2];
+    result.minNs = samples.front();
+    return result;
+}
+
+/** @brief Nanoseconds since an arbitrary epoch. */
+static double nowNs() {
+    return static_cast<double>(chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/** @brief Keeps a value alive so the optimizer cannot drop the code computing it. */
+static volatile long sink;
+
+/**
+ * @brief Builds a square map from a fixed seed.
+ */
+static Map makeMap(int size) {
+    Map map(size, size);
+    map.generateRandomMap(12345u);
+    return map;
+}
+
+/**
+ * @brief Collects the path cells of a map, entry to exit in row-major order.
+ */
+static vector<pair<int, int>> pathCells(const Map& map) {
+    vector<pair<int, int>> cells;
+    for (int y = 0; y < map.getHeight(); y++) {
+        for (int x = 0; x < map.getWidth(); x++) {
+            if (map.isPath(x, y)) {
+                cells.push_back({x, y});
+            }
+        }
+    }
+    return cells;
+}
+
+/**
+ * @brief Creates count critters spread over the path of a map.
+ */
+static vector<Critter> spreadCritters(const Map& map, int count) {
+    vector<pair<int, int>> cells = pathCells(map);
+    vector<Critter> critters;
+    critters.reserve(count);
+    for (int i = 0; i < count; i++) {
+        critters.emplace_back(1000000, 1, 1, 1, 5, cells[i % cells.size()], &map);
+        critters.back().setId(static_cast<uint32_t>(i + 1));
+    }
+    return critters;
+}
+
+/**
+ * @brief Places count towers of type T on the buildable cells closest to the path.
+ */
+template <class T>
+static void placeTowers(Map& map, TowerRegistry& towers, int count) {
+    for (int y = 0; y < map.getHeight() && static_cast<int>(towers.size()) < count; y++) {
+        for (int x = 0; x < map.getWidth() && static_cast<int>(towers.size()) < count; x++) {
+            if (!map.isPath(x, y) && map.getCoverage(x, y, TowerCatalog::instance().get(AOE_TOWER, 1).range) > 0) {
+                towers.place<T>(x, y);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Times T::attack of every tower against a crowd of critters.
+ */
+template <class T>
+static BenchBody towerAttack(TowerRegistry& towers, vector<Critter>& critters, DamageBuffer& hits) {
+    return [&](long iterations) {
+        double total = 0.0;
+        for (long i = 0; i < iterations; i++) {
+            hits.reset(critters.size());
+            double start = nowNs();
+            for (Tower* tower : towers.getTowers()) {
+                tower->attack(critters, hits);
+            }
+            total += nowNs() - start;
+        }
+        sink = static_cast<long>(hits.getHitCount());
+        return total;
+    };
+}
+
+/**
+ * @brief Writes the results as JSON.
+ * @return True if the file was written.
+ */
+static bool writeJSON(const string& path, const BenchOptions& options, const vector<BenchResult>& results) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+
+    fprintf(file, "{\n  \"min_time_ms\": %.1f,\n  \"repetitions\": %d,\n  \"benchmarks\": [", options.minTimeMs,
+            options.repetitions);
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& result = results[i];
+        fprintf(file, "%s\n    {\"name\": \"%s\", \"params\": {", i > 0 ? "," : "", result.name.c_str());
+        for (size_t p = 0; p < result.params.size(); p++) {
+            fprintf(file, "%s\"%s\": %ld", p > 0 ? ", " : "", result.params[p].first.c_str(), result.params[p].second);
+        }
+        fprintf(file, "}, \"iterations\": %ld, \"median_ns\": %.1f, \"min_ns\": %.1f", result.iterations,
+                result.medianNs, result.minNs);
+        if (result.itemsPerIteration > 0) {
+            fprintf(file, ", \"items_per_second\": %.0f", result.itemsPerIteration * 1e9 / result.medianNs);
+        }
+        fprintf(file, "}");
+    }
+    fprintf(file, "\n  ]\n}\n");
+    return fclose(file) == 0;
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    string jsonPath;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--filter") == 0 && hasValue) {
+            options.filter = argv[++i];
+        } else if (strcmp(argv[i], "--min-time") == 0 && hasValue) {
+            options.minTimeMs = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--repetitions") == 0 && hasValue) {
+            options.repetitions = max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "--json") == 0 && hasValue) {
+            jsonPath = argv[++i];
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            options.quick = true;
+            options.minTimeMs = 10;
+            options.repetitions = 3;
+        } else {
+            fprintf(stderr, "Unknown or incomplete option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    // Towers log on construction; keep that out of the measurements
+    Logger::instance().setLevel(LOG_OFF);
+
+    vector<int> mapSizes = options.quick ? vector<int>{16, 64} : vector<int>{16, 64, 256};
+    vector<int> critterCounts = options.quick ? vector<int>{100, 1000} : vector<int>{100, 1000, 10000};
+    vector<int> towerCounts = options.quick ? vector<int>{10, 100} : vector<int>{10, 100, 1000};
+
+    vector<BenchResult> results;
+    printf("%-34s %-28s %12s %12s %12s\n", "benchmark", "params", "iterations", "median_ns", "min_ns");
+
+    auto run = [&](const string& name, vector<pair<string, long>> params, long items, const BenchBody& body) {
+        if (!options.filter.empty() && name.find(options.filter) == string::npos) {
+            return;
+        }
+
+        BenchResult result = measure(options, body);
+        result.name = name;
+        result.params = std::move(params);
+        result.itemsPerIteration = items;
+        results.push_back(result);
+
+        string paramText;
+        for (const auto& param : result.params) {
+            paramText += (paramText.empty() ? "" : " ") + param.first + "=" + to_string(param.second);
+        }
+        printf("%-34s %-28s %12ld %12.1f %12.1f\n", name.c_str(), paramText.c_str(), result.iterations,
+               result.medianNs, result.minNs);
+        fflush(stdout);
+    };
+
+    // Map
+    for (int size : mapSizes) {
+        Map map = makeMap(size);
+        run("map/is_path_connected", {{"size", size}}, 0, [&](long iterations) {
+            long connected = 0;
+            double start = nowNs();
+            for (long i = 0; i < iterations; i++) {
+                connected += map.isPathConnected();
+            }
+            double elapsed = nowNs() - start;
+            sink = connected;
+            return elapsed;
+        });
+
+        unsigned int seed = 1;
+        run("map/generate_random_map", {{"size", size}}, 0, [&](long iterations) {
+            double start = nowNs();
+            for (long i = 0; i < iterations; i++) {
+                map.generateRandomMap(seed++);
+            }
+            return nowNs() - start;
+        });
+    }
+
+    // Winding maps: one candidate sampled and scored, and a full pick of the best of 64 on the
+    // worker pool; items_per_second is maps (or candidates) per second
+    ThreadPool pool;
+    for (int size : mapSizes) {
+        int range = TowerCatalog::instance().get(BASIC_TOWER, 1).range;
+        MapGenerator generator(size, size, MapGenerator::defaultConstraints(size, size, range));
+        unsigned int seed = 1;
+        run("map_generator/sample", {{"size", size}}, 1, [&](long iterations) {
+            long feasible = 0;
+            double start = nowNs();
+            for (long i = 0; i < iterations; i++) {
+                feasible += generator.sample(seed++).feasible;
+            }
+            double elapsed = nowNs() - start;
+            sink = feasible;
+            return elapsed;
+        });
+
+        Map map(size, size);
+        run("map_generator/generate",
+            {{"size", size}, {"candidates", MapGenerator::DEFAULT_CANDIDATES}, {"threads", static_cast<long>(pool.size())}},
+            MapGenerator::DEFAULT_CANDIDATES, [&](long iterations) {
+                long feasible = 0;
+                double start = nowNs();
+                for (long i = 0; i < iterations; i++) {
+                    feasible += generator.generate(map, seed++, MapGenerator::DEFAULT_CANDIDATES, &pool);
+                }
+                double elapsed = nowNs() - start;
+                sink = feasible;
+                return elapsed;
+            });
+    }
+
+    // Open-field routing: a tower placed and sold again, each repairing the distance field
+    vector<int> fieldSizes = options.quick ? vector<int>{64, 256} : vector<int>{64, 256, 512};
+    for (int size : fieldSizes) {
+        Map map = makeMap(size);
+        map.setOpenField(true);
+        DistanceField field;
+        run("distance_field/build", {{"size", size}}, static_cast<long>(size) * size, [&](long iterations) {
+            double start = nowNs();
+            for (long i = 0; i < iterations; i++) {
+                field.build(map);
+            }
+            return nowNs() - start;
+        });
+
+        // Cells on the old path, where a tower forces a detour; the entry and exit cannot be built on
+        vector<pair<int, int>> route;
+        for (pair<int, int> cell : pathCells(map)) {
+            if (cell != map.getEntry() && cell != map.getExit()) {
+                route.push_back(cell);
+            }
+        }
+        field.build(map);
+        size_t next = 0;
+        run("distance_field/place_and_sell", {{"size", size}}, 2, [&](long iterations) {
+            long reachable = 0;
+            double start = nowNs();
+            for (long i = 0; i < iterations; i++) {
+                pair<int, int> cell = route[next++ % route.size()];
+                field.setBlocked(cell.first, cell.second, true);
+                reachable += field.getDistance(map.getEntry().first, map.getEntry().second) >= 0;
+                field.setBlocked(cell.first, cell.second, false);
+            }
+            double elapsed = nowNs() - start;
+            sink = reachable;
+            return elapsed;
+        });
+    }
+
+    // Hierarchical routing on large open fields with a tenth of the cells built on, in walls of towers
+    vector<int> hierarchySizes = options.quick ? vector<int>{1024} : vector<int>{1024, 8192};
+    // Building an 8k map takes seconds, so skip it when the filter excludes these benchmarks
+    bool hierarchySelected = false;
+    for (const char* name : {"path_hierarchy/build", "path_hierarchy/edit_and_update", "path_hierarchy/route"}) {
+        hierarchySelected = hierarchySelected || options.filter.empty() || string(name).find(options.filter) != string::npos;
+    }
+    for (size_t s = 0; s < hierarchySizes.size() && hierarchySelected; s++) {
+        int size = hierarchySizes[s];
+        Map map = makeMap(size);
+        map.setOpenField(true);
+        unsigned int state = 99;
+        auto random = [&state](int bound) {
+            state = state * 1103515245u + 12345u;
+            return static_cast<int>((state >> 16) % static_cast<unsigned int>(bound));
+        };
+        for (long built = 0; built < static_cast<long>(size) * size / 10;) {
+            int x = random(size), y = random(size), length = 4 + random(61), across = random(2);
+            for (int i = 0; i < length; i++) {
+                pair<int, int> cell = across ? make_pair(x + i, y) : make_pair(x, y + i);
+                if (map.isWalkable(cell.first, cell.second) && cell != map.getEntry() && cell != map.getExit()) {
+                    map.placeTower(cell.first, cell.second);
+                    built++;
+                }
+            }
+        }
+
+        // A full build of the 8k map takes seconds per iteration; the cost of edits is what matters there
+        if (s == 0) {
+            run("path_hierarchy/build", {{"size", size}, {"threads", static_cast<long>(pool.size())}},
+                static_cast<long>(size) * size, [&](long iterations) {
+                    double start = nowNs();
+                    for (long i = 0; i < iterations; i++) {
+                        PathHierarchy hierarchy(map, PathHierarchy::DEFAULT_CLUSTER_SIZE, &pool);
+                        sink = static_cast<long>(hierarchy.getNodeCount());
+                    }
+                    return nowNs() - start;
+                });
+        }
+
+        PathHierarchy hierarchy(map, PathHierarchy::DEFAULT_CLUSTER_SIZE, &pool);
+        run("path_hierarchy/edit_and_update", {{"size", size}}, 2, [&](long iterations) {
+            long relinked = 0;
+            double start = nowNs();
+            for (long i = 0; i < iterations; i++) {
+                int x = random(size), y = random(size);
+                if (!map.isWalkable(x, y) || make_pair(x, y) == map.getEntry() || make_pair(x, y) == map.getExit()) {
+                    continue;
+                }
+                map.placeTower(x, y);
+                hierarchy.markChanged(x, y);
+                relinked += static_cast<long>(hierarchy.update());
+                map.removeTower(x, y);
+                hierarchy.markChanged(x, y);
+                relinked += static_cast<long>(hierarchy.update());
+            }
+            double elapsed = nowNs() - start;
+            sink = relinked;
+            return elapsed;
+        });
+
+        // Routes between random cells, at least half the map apart
+        run("path_hierarchy/route", {{"size", size}}, 1, [&](long iterations) {
+            long steps = 0;
+            double start = nowNs();
+            for (long i = 0; i < iterations; i++) {
+                int x = random(size / 4), y = random(size);
+                steps += hierarchy.findRoute(x, y, size - 1 - random(size / 4), random(size));
+            }
+            double elapsed = nowNs() - start;
+            sink = steps;
+            return elapsed;
+        });
+    }
+
+    // Critters
+    Map critterMap = makeMap(64);
+    for (int count : critterCounts) {
+        vector<Critter> initial = spreadCritters(critterMap, count);
+        vector<Critter> work;
+
+        run("critter/move", {{"critters", count}}, count, [&](long iterations) {
+            double total = 0.0;
+            for (long i = 0; i < iterations; i++) {
+                work = initial;
+                double start = nowNs();
+                for (Critter& critter : work) {
+                    critter.move();
+                }
+                total += nowNs() - start;
+            }
+            return total;
+        });
+
+        CritterGroup group(&critterMap);
+        int wave = max((count - 5) / 2, 1);
+        run("critter_group/generate_wave", {{"critters", 5 + 2 * wave}}, 5 + 2 * wave, [&](long iterations) {
+            double total = 0.0;
+            for (long i = 0; i < iterations; i++) {
+                group.restoreState(wave - 1, 1, vector<Critter>(), deque<Critter>());
+                double start = nowNs();
+                group.generateWave();
+                total += nowNs() - start;
+            }
+            return total;
+        });
+
+        run("critter_group/move_all_critters", {{"critters", count}}, count, [&](long iterations) {
+            double total = 0.0;
+            int exits = 0;
+            for (long i = 0; i < iterations; i++) {
+                group.restoreState(1, static_cast<uint32_t>(count + 1), initial, deque<Critter>());
+                double start = nowNs();
+                group.moveAllCritters([&exits](int) { exits++; });
+                total += nowNs() - start;
+            }
+            sink = exits;
+            return total;
+        });
+
+        // Every tenth critter is dead, as after a typical damage phase
+        vector<Critter> wounded = initial;
+        for (size_t i = 0; i < wounded.size(); i += 10) {
+            wounded[i].takeDamage(wounded[i].getHitPoints());
+        }
+        run("critter_group/remove_dead_critters", {{"critters", count}, {"dead_percent", 10}}, count,
+            [&](long iterations) {
+                double total = 0.0;
+                int rewards = 0;
+                for (long i = 0; i < iterations; i++) {
+                    group.restoreState(1, static_cast<uint32_t>(count + 1), wounded, deque<Critter>());
+                    double start = nowNs();
+                    group.removeDeadCritters([&rewards](int reward) { rewards += reward; });
+                    total += nowNs() - start;
+                }
+                sink = rewards;
+                return total;
+            });
+    }
+
+    // Towers
+    Map towerMap = makeMap(256);
+    for (int towerCount : towerCounts) {
+        for (int critterCount : critterCounts) {
+            vector<Critter> critters = spreadCritters(towerMap, critterCount);
+            DamageBuffer hits;
+            {
+                TowerRegistry towers(&towerMap);
+                placeTowers<BasicTower>(towerMap, towers, towerCount);
+                long placed = static_cast<long>(towers.size());
+                run("tower/basic_attack", {{"towers", placed}, {"critters", critterCount}}, placed,
+                    towerAttack<BasicTower>(towers, critters, hits));
+                towers.clear();
+            }
+            {
+                TowerRegistry towers(&towerMap);
+                placeTowers<AoETower>(towerMap, towers, towerCount);
+                long placed = static_cast<long>(towers.size());
+                run("tower/aoe_attack", {{"towers", placed}, {"critters", critterCount}}, placed,
+                    towerAttack<AoETower>(towers, critters, hits));
+                towers.clear();
+            }
+        }
+    }
+
+    if (!jsonPath.empty()) {
+        if (!writeJSON(jsonPath, options, results)) {
+            fprintf(stderr, "Could not write %s\n", jsonPath.c_str());
+            return 1;
+        }
+        printf("results written to %s\n", jsonPath.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file bench_attack.cpp
+ * @brief Scaling benchmark for the parallel tower attack phase.
+ *
+ * Builds a late-game layout (1000 towers around a long path crowded with critters) and times
+ * TowerRegistry::attackAll with 1 to 32 threads, reporting the speedup over one thread. Every
+ * run is also checked against the single-threaded damage buffer to make sure the parallel
+ * phase stays deterministic.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "mapgen.h"
+#include "critter.h"
+#include "tower.h"
+#include "TowerRegistry.h"
+#include "DamageBuffer.h"
+#include "ThreadPool.h"
+#include "Logger.h"
+
+using namespace std;
+
+/**
+ * @brief Checks that two damage buffers hold the same damage for every slot.
+ */
+static bool sameDamage(const DamageBuffer& a, const DamageBuffer& b) {
+    if (a.size() != b.size() || a.getHitCount() != b.getHitCount()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a.getDamage(i) != b.getDamage(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    int towerCount = argc > 1 ? atoi(argv[1]) : 1000;
+    int critterCount = argc > 2 ? atoi(argv[2]) : 2000;
+    int ticks = argc > 3 ? atoi(argv[3]) : 50;
+
+    Map map(256, 256);
+    map.generateRandomMap();
+
+    // Collect path cells and buildable cells next to the path
+    vector<pair<int, int>> pathCells;
+    vector<pair<int, int>> buildCells;
+    for (int y = 0; y < map.getHeight(); y++) {
+        for (int x = 0; x < map.getWidth(); x++) {
+            if (map.isPath(x, y)) {
+                pathCells.push_back({x, y});
+            } else if (map.isPath(x - 1, y) || map.isPath(x + 1, y) || map.isPath(x, y - 1) || map.isPath(x, y + 1)
+                       || map.isPath(x - 2, y) || map.isPath(x + 2, y) || map.isPath(x, y - 2) || map.isPath(x, y + 2)) {
+                buildCells.push_back({x, y});
+            }
+        }
+    }
+
+    // Towers log on construction; keep that out of the output
+    Logger::instance().setLevel(LOG_OFF);
+
+    TowerRegistry towers(&map);
+    for (int i = 0; i < towerCount && i < static_cast<int>(buildCells.size()); i++) {
+        if (i % 4 == 0) {
+            towers.place<AoETower>(buildCells[i].first, buildCells[i].second);
+        } else {
+            towers.place<BasicTower>(buildCells[i].first, buildCells[i].second);
+        }
+    }
+
+    vector<Critter> critters;
+    critters.reserve(critterCount);
+    for (int i = 0; i < critterCount; i++) {
+        critters.emplace_back(1000000, 10, 1, 1, 20, pathCells[i % pathCells.size()], &map);
+    }
+
+    DamageBuffer reference;
+    towers.attackAll(critters, reference);
+
+    printf("towers=%zu critters=%d ticks=%d cores=%u\n", towers.size(), critterCount, ticks, thread::hardware_concurrency());
+    printf("%8s %12s %10s %14s\n", "threads", "ms/tick", "speedup", "deterministic");
+
+    double baseline = 0.0;
+    for (int threads = 1; threads <= 32; threads *= 2) {
+        ThreadPool pool(threads);
+        DamageBuffer hits;
+
+        auto start = chrono::steady_clock::now();
+        for (int t = 0; t < ticks; t++) {
+            towers.attackAll(critters, hits, &pool);
+        }
+        auto end = chrono::steady_clock::now();
+
+        double msPerTick = chrono::duration<double, milli>(end - start).count() / ticks;
+        if (threads == 1) {
+            baseline = msPerTick;
+        }
+        printf("%8d %12.3f %9.2fx %14s\n", threads, msPerTick, baseline / msPerTick, sameDamage(hits, reference) ? "yes" : "NO");
+    }
+
+    return 0;
+}
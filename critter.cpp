@@ -4,6 +4,7 @@
  */
 
 #include "critter.h"
+#include "DistanceField.h"
 
 /**
  * @brief Constructs a Critter with given attributes and initial position.
@@ -17,6 +18,7 @@
  * @param gameMap Pointer to the game map to determine movement.
  */
 Critter::Critter(int hp, int str, int spd, int lvl, int rwd, pair<int, int> pos, const Map* gameMap) {
+    id = 0;
     hitPoints = hp;
     strength = str;
     speed = spd;
@@ -69,6 +71,31 @@ void Critter::move() {
     }
 }
 
+/**
+ * @brief Moves the critter towards the exit along a distance field.
+ *
+ * Like move(), the critter takes up to `speed` steps and notices the exit at the start of a
+ * step, so both kinds of map take the same number of ticks over a route of the same length.
+ *
+ * @param field Distances to the exit of the critter's map.
+ */
+void Critter::moveAlong(const DistanceField& field) {
+    if (reachedExit || isDead()) {
+        return;
+    }
+
+    pair<int, int> exitPoint = map->getExit();
+    for (int moves = 0; moves < speed; moves++) {
+        if (position == exitPoint) {
+            reachedExit = true;
+            return;
+        }
+        if (!field.nextStep(position.first, position.second, position)) {
+            break;  // Walled in; the placement check keeps this from happening
+        }
+    }
+}
+
 /**
  * @brief Reduces the critter's hit points by a given damage amount.
  *
@@ -88,6 +115,18 @@ bool Critter::isDead() const {
 }
 
 // Getter and setter methods
+/** @brief Gets the identifier assigned when the critter spawned. */
+uint32_t Critter::getId() const { return id; }
+
+/**
+ * @brief Sets the identifier of the critter.
+ *
+ * @param critterId Identifier unique within the critter's group.
+ */
+void Critter::setId(uint32_t critterId) {
+    id = critterId;
+}
+
 /** @brief Gets the current hit points of the critter. */
 int Critter::getHitPoints() const { return hitPoints; }
 
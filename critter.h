@@ -6,6 +6,7 @@
 #ifndef CRITTER_H
 #define CRITTER_H
 
+#include <cstdint>
 #include <utility>
 #include "mapgen.h"
 #include <iostream>
@@ -13,6 +14,8 @@
 
 using namespace std;
 
+class DistanceField;
+
 /**
  * @class Critter
  * @brief Represents a single enemy unit in the tower defense game.
@@ -22,6 +25,7 @@ using namespace std;
  */
 class Critter {
 private:
+    uint32_t id;         ///< Identifier assigned by the CritterGroup when the critter spawns
     int hitPoints;       ///< Current health of the critter
     int strength;        ///< Damage dealt to player when reaching exit
     int speed;           ///< Movement speed of the critter
@@ -50,6 +54,15 @@ public:
      */
     void move();
 
+    /**
+     * @brief Moves the critter towards the exit along a distance field, for open-field maps.
+     *
+     * Each step goes to the neighbouring cell closest to the exit, so the critter follows
+     * whatever route the towers leave open.
+     * @param field Distances to the exit of the critter's map.
+     */
+    void moveAlong(const DistanceField& field);
+
     /**
      * @brief Reduces the critter's hit points by a given damage amount.
      *
@@ -65,6 +78,16 @@ public:
     bool isDead() const;
 
     // Getter and setter methods
+    /** @brief Gets the identifier assigned when the critter spawned. */
+    uint32_t getId() const;
+
+    /**
+     * @brief Sets the identifier of the critter.
+     *
+     * @param critterId Identifier unique within the critter's group.
+     */
+    void setId(uint32_t critterId);
+
     /** @brief Gets the current hit points of the critter. */
     int getHitPoints() const;
 
@@ -102,4 +125,51 @@ public:
     void setPosition(int x, int y);
 };
 
+/**
+ * @class CritterSpanT
+ * @brief Non-owning view over a contiguous run of critters.
+ *
+ * Towers and renderers read the active critters through a view instead of a copy, so no
+ * per-frame allocation is needed. The view is invalidated by anything that adds or removes
+ * critters (spawning, damage resolution, movement).
+ *
+ * @tparam T Critter or const Critter.
+ */
+template <class T>
+class CritterSpanT {
+private:
+    T* first;     ///< First critter of the view
+    size_t count; ///< Number of critters in the view
+
+public:
+    /** @brief Constructs an empty view. */
+    CritterSpanT() : first(nullptr), count(0) {}
+
+    /**
+     * @brief Constructs a view over count critters starting at data.
+     * @param data First critter of the view.
+     * @param count Number of critters.
+     */
+    CritterSpanT(T* data, size_t count) : first(data), count(count) {}
+
+    /**
+     * @brief Constructs a view over every critter of a vector.
+     * @param critters Vector to view; must outlive the view.
+     */
+    template <class Vector>
+    CritterSpanT(Vector& critters) : first(critters.data()), count(critters.size()) {}
+
+    /** @brief Allows a mutable view to be passed where a read-only view is expected. */
+    operator CritterSpanT<const T>() const { return CritterSpanT<const T>(first, count); }
+
+    T* begin() const { return first; }
+    T* end() const { return first + count; }
+    T* data() const { return first; }
+    T& operator[](size_t i) const { return first[i]; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+};
+
+typedef CritterSpanT<const Critter> ConstCritterSpan;  ///< Read-only view of critters
+
 #endif // CRITTER_H
@@ -4,110 +4,316 @@
  */
 
 #include <SFML/Graphics.hpp>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <thread>
 #include <vector>
 #include "mapgen.h"
 #include "tower.h"
+#include "TowerCatalog.h"
+#include "TowerRegistry.h"
 #include "CritterGroup.h"
+#include "ProjectilePool.h"
+#include "Simulation.h"
+#include "FixedTimestep.h"
+#include "RenderList.h"
+#include "RenderSnapshot.h"
+#include "TripleBuffer.h"
+#include "Replay.h"
+#include "Logger.h"
+#include "CommandQueue.h"
+#include "ConsoleInput.h"
 
 using namespace std;
 
 const int TILE_SIZE = 40;  // Size of each grid tile in pixels
 
 /**
- * @brief Renders the game map and objects using SFML.
+ * @brief Appends the triangles of a render quad to a vertex array.
+ * @param vertices Vertex array drawn as sf::Triangles.
+ * @param quad Quad to append; discs are approximated with a 12-sided polygon.
+ */
+void appendQuad(sf::VertexArray &vertices, const RenderQuad &quad) {
+    sf::Color color(quad.color.r, quad.color.g, quad.color.b);
+
+    if (quad.shape == QUAD_SQUARE) {
+        sf::Vector2f a(quad.x, quad.y), b(quad.x + quad.size, quad.y);
+        sf::Vector2f c(quad.x + quad.size, quad.y + quad.size), d(quad.x, quad.y + quad.size);
+        vertices.append(sf::Vertex(a, color));
+        vertices.append(sf::Vertex(b, color));
+        vertices.append(sf::Vertex(c, color));
+        vertices.append(sf::Vertex(a, color));
+        vertices.append(sf::Vertex(c, color));
+        vertices.append(sf::Vertex(d, color));
+        return;
+    }
+
+    const int SEGMENTS = 12;
+    float radius = quad.size / 2;
+    sf::Vector2f center(quad.x + radius, quad.y + radius);
+    for (int i = 0; i < SEGMENTS; i++) {
+        float a0 = 6.2831853f * i / SEGMENTS;
+        float a1 = 6.2831853f * (i + 1) / SEGMENTS;
+        vertices.append(sf::Vertex(center, color));
+        vertices.append(sf::Vertex(sf::Vector2f(center.x + radius * cos(a0), center.y + radius * sin(a0)), color));
+        vertices.append(sf::Vertex(sf::Vector2f(center.x + radius * cos(a1), center.y + radius * sin(a1)), color));
+    }
+}
+
+/**
+ * @brief Renders a frame using SFML vertex arrays: two draw calls per frame.
  * @param window SFML window reference.
- * @param map The game map object.
- * @param towers The list of placed towers.
- * @param critters The list of active critters.
+ * @param list Render list built from the game state.
+ * @param mapVertices Cached vertices of the map layer; rebuilt only when mapChanged is true.
+ * @param entityVertices Reused vertex array for the entity layer.
+ * @param mapChanged True if the list's map layer was rebuilt since the previous frame.
  */
-void renderMap(sf::RenderWindow &window, Map &map, vector<Tower*> &towers, vector<Critter> &critters) {
+void renderFrame(sf::RenderWindow &window, const RenderList &list, sf::VertexArray &mapVertices,
+                 sf::VertexArray &entityVertices, bool mapChanged) {
+    if (mapChanged) {
+        mapVertices.clear();
+        for (const RenderQuad &quad : list.getMapLayer()) {
+            appendQuad(mapVertices, quad);
+        }
+    }
+
+    entityVertices.clear();
+    for (const RenderQuad &quad : list.getEntities()) {
+        appendQuad(entityVertices, quad);
+    }
+
     window.clear();
+    window.draw(mapVertices);
+    window.draw(entityVertices);
+    window.display();
+}
+
+/**
+ * @brief Applies a queued player command at a tick boundary and reports the outcome.
+ * @param sim Simulation to change.
+ * @param command Command taken from the GUI or the console queue.
+ */
+void applyCommand(Simulation &sim, const PlayerCommand &command) {
+    if (command.type == COMMAND_PLACE && !checkBuildable(sim.getMap(), sim.getTowers(), command.x, command.y)) {
+        return;
+    }
 
-    for (int y = 0; y < map.getHeight(); y++) {
-        for (int x = 0; x < map.getWidth(); x++) {
-            sf::RectangleShape tile(sf::Vector2f(TILE_SIZE, TILE_SIZE));
-            tile.setPosition(x * TILE_SIZE, y * TILE_SIZE);
+    int gold = sim.getGold();
+    bool applied = sim.apply(command);
+    if (command.type == COMMAND_SELL && applied) {
+        TD_LOG_INFO("Tower sold for %d gold", sim.getGold() - gold);
+    } else if (command.type == COMMAND_PLACE && !applied && TowerCatalog::instance().get(command.towerType, 1).cost > gold) {
+        TD_LOG_WARN("Not enough gold!");
+    }
+}
 
-            // Set colors based on cell type
-            if (map.isPath(x, y)) {
-                tile.setFillColor(sf::Color(150, 75, 0)); // Brown for path
-            } else {
-                tile.setFillColor(sf::Color(50, 205, 50)); // Green for scenery
+int main(int argc, char* argv[]) {
+    // Optional parallel attack phase: --threads N; optional recording of the session: --record FILE;
+    // phase timings printed on exit: --profile; tower stats from a catalog file: --catalog FILE;
+    // towers allowed on the path to maze the critters: --open-field; a winding, maze-like path: --winding
+    SimulationConfig config;
+    config.seed = static_cast<unsigned int>(time(0));
+    const char* recordPath = nullptr;
+    bool profile = false;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            config.threads = static_cast<size_t>(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--record") == 0 && hasValue) {
+            recordPath = argv[++i];
+        } else if (strcmp(argv[i], "--profile") == 0) {
+            profile = true;
+        } else if (strcmp(argv[i], "--open-field") == 0) {
+            config.openField = true;
+        } else if (strcmp(argv[i], "--winding") == 0) {
+            config.windingPath = true;
+        } else if (strcmp(argv[i], "--catalog") == 0 && hasValue) {
+            string error;
+            if (!TowerCatalog::instance().load(argv[++i], error)) {
+                fprintf(stderr, "Cannot load tower catalog %s: %s\n", argv[i], error.c_str());
+                return 1;
             }
-            window.draw(tile);
         }
     }
 
-    // Draw towers
-    for (Tower* tower : towers) {
-        sf::CircleShape towerShape(TILE_SIZE / 2 - 5);
-        towerShape.setPosition(tower->getX() * TILE_SIZE + 5, tower->getY() * TILE_SIZE + 5);
-        towerShape.setFillColor(sf::Color::Blue);
-        window.draw(towerShape);
+    // The simulation owns the 10x10 map, the towers and the critter waves
+    Simulation sim(config);
+    Replay recording(config);
+    if (recordPath != nullptr) {
+        sim.setRecorder(&recording);
     }
+    PlayerCommand command;
+    TowerType selectedTower = BASIC_TOWER;
 
-    // Draw critters
-    for (const Critter &critter : critters) {
-        sf::CircleShape critterShape(TILE_SIZE / 2 - 8);
-        critterShape.setPosition(critter.getPosition().first * TILE_SIZE + 8, critter.getPosition().second * TILE_SIZE + 8);
-        critterShape.setFillColor(sf::Color::Red);
-        window.draw(critterShape);
-    }
+    // Input never blocks either thread: window events and console lines are queued and applied
+    // by the simulation thread between ticks. Each queue has exactly one producer.
+    CommandQueue consoleCommands;
+    CommandQueue windowCommands;
+    ConsoleInput console(consoleCommands);
+    TD_LOG_INFO("Console commands: place basic|aoe X Y, sell X Y, upgrade X Y");
 
-    window.display();
-}
+    // Requests from the window to the simulation thread
+    atomic<bool> running(true);
+    atomic<int> requestedSpeed(-1);   // GameSpeed to switch to, or -1
+    atomic<int> rewindRequests(0);    // Backspace presses not handled yet
+
+    // Each profiler is only touched by one thread
+    Profiler profiler;
+    Profiler renderProfiler;
+    Profiler* activeProfiler = profile ? &profiler : nullptr;
+    sim.setProfiler(activeProfiler);
 
-int main() {
-    // Initialize the game map (10x10)
-    Map gameMap(10, 10);
-    gameMap.generateRandomMap();
+    // The simulation thread publishes what is drawn through a triple buffer, so a slow frame
+    // never delays a tick and a heavy tick never holds up a frame
+    TripleBuffer<RenderSnapshot> snapshots;
+    snapshots.back().capture(sim);
+    snapshots.publish();
 
-    // Tower list
-    vector<Tower*> towers;
+    thread simulation([&]() {
+        // Simulation ticks run at a fixed rate, independent of the frame rate
+        FixedTimestep timestep;
+        auto previous = chrono::steady_clock::now();
 
-    // Critter management
-    CritterGroup group(&gameMap);
-    int numCritters = group.generateWave();
+        // State captured once per simulated second; Backspace rewinds through it
+        const uint64_t SNAPSHOT_TICKS = 10;
+        SnapshotRing history;
+        vector<uint8_t> snapshot;
+
+        while (running.load(memory_order_relaxed)) {
+            int speed = requestedSpeed.exchange(-1, memory_order_relaxed);
+            if (speed >= 0) {
+                timestep.setSpeed(static_cast<GameSpeed>(speed));
+            }
+
+            // Rewind the game by one snapshot per request; a recording cannot be rewound
+            bool rewound = false;
+            for (int requests = rewindRequests.exchange(0); requests > 0; requests--) {
+                if (history.size() == 0 || recordPath != nullptr) {
+                    break;
+                }
+                size_t stepsBack = history.size() > 1 ? 1 : 0;
+                if (history.get(stepsBack, snapshot) && sim.loadSnapshot(snapshot)) {
+                    history.discardNewest(stepsBack + 1);  // the restored state is captured again on the next tick
+                    rewound = true;
+                }
+            }
+
+            // Game logic: run however many ticks are owed, applying queued input before each
+            auto now = chrono::steady_clock::now();
+            double elapsed = chrono::duration<double>(now - previous).count();
+            previous = now;
+            int ticks = timestep.advance(elapsed, [&]() {
+                PlayerCommand queued;
+                while (consoleCommands.pop(queued) || windowCommands.pop(queued)) {
+                    applyCommand(sim, queued);
+                }
+
+                if (sim.getTick() % SNAPSHOT_TICKS == 0) {
+                    sim.saveSnapshot(snapshot);
+                    history.push(snapshot);
+                }
+                sim.step();
+                return !sim.isGameOver();
+            });
+
+            if (ticks > 0 || rewound) {
+                snapshots.back().capture(sim);
+                snapshots.publish();
+            }
+            if (timestep.getSpeed() != SPEED_UNCAPPED || sim.isGameOver()) {
+                this_thread::sleep_for(chrono::milliseconds(1));
+            }
+        }
+    });
 
     // Create SFML window
     sf::RenderWindow window(sf::VideoMode(400, 400), "Tower Defense Game");
+    window.setFramerateLimit(60);
+
+    // Frame description and the SFML buffers it is uploaded to
+    RenderList renderList(TILE_SIZE);
+    sf::VertexArray mapVertices(sf::Triangles);
+    sf::VertexArray entityVertices(sf::Triangles);
 
     while (window.isOpen()) {
+        snapshots.update();
+        const RenderSnapshot &state = snapshots.front();
+
         sf::Event event;
         while (window.pollEvent(event)) {
             if (event.type == sf::Event::Closed) {
                 window.close();
             }
 
-            // Handle mouse click to place a tower
+            // Handle left click to place the selected tower type and right click to sell a tower
             if (event.type == sf::Event::MouseButtonPressed) {
-                int x = event.mouseButton.x / TILE_SIZE;
-                int y = event.mouseButton.y / TILE_SIZE;
-                placeTowerInteractive(gameMap, towers, x, y);
+                command.x = event.mouseButton.x / TILE_SIZE;
+                command.y = event.mouseButton.y / TILE_SIZE;
+                command.type = event.mouseButton.button == sf::Mouse::Right ? COMMAND_SELL : COMMAND_PLACE;
+                command.towerType = selectedTower;
+                if (!windowCommands.push(command)) {
+                    TD_LOG_WARN("Input queue full, click dropped");
+                }
             }
-        }
 
-        // Game logic: move critters and attack them
-        group.spawnNextCritter();
-        vector<Critter> crittersCopy = group.getActiveCritters();  // Get active critters
+            // Show how much of the path the hovered cell would cover
+            if (event.type == sf::Event::MouseMoved) {
+                int x = event.mouseMove.x / TILE_SIZE;
+                int y = event.mouseMove.y / TILE_SIZE;
+                if (state.contains(x, y)) {
+                    window.setTitle("Tower Defense Game - path in range: Basic "
+                                    + to_string(state.getCell(x, y).basicCoverage)
+                                    + ", AoE " + to_string(state.getCell(x, y).aoeCoverage));
+                }
+            }
 
-        for (Tower* tower : towers) {
-            tower->attack(crittersCopy);
-        }
+            // Keys 1-4 select 1x, 2x, 8x and uncapped game speed; B and A select the tower type to build
+            if (event.type == sf::Event::KeyPressed) {
+                if (event.key.code == sf::Keyboard::B) selectedTower = BASIC_TOWER;
+                if (event.key.code == sf::Keyboard::A) selectedTower = AOE_TOWER;
+                if (event.key.code == sf::Keyboard::Num1) requestedSpeed.store(SPEED_1X);
+                if (event.key.code == sf::Keyboard::Num2) requestedSpeed.store(SPEED_2X);
+                if (event.key.code == sf::Keyboard::Num3) requestedSpeed.store(SPEED_8X);
+                if (event.key.code == sf::Keyboard::Num4) requestedSpeed.store(SPEED_UNCAPPED);
+            }
+
+            // Handle Backspace to rewind the game by one snapshot
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::BackSpace) {
+                rewindRequests.fetch_add(1);
+            }
 
-        group.moveAllCritters([](int damage) {
-            cout << "A critter reached the exit! Player takes " << damage << " damage!\n";
-        });
+            // Handle 'U' to upgrade the tower under the mouse cursor
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::U) {
+                sf::Vector2i mouse = sf::Mouse::getPosition(window);
+                command.type = COMMAND_UPGRADE;
+                command.x = mouse.x / TILE_SIZE;
+                command.y = mouse.y / TILE_SIZE;
+                windowCommands.push(command);
+            }
+        }
 
-        // Render game objects
-        renderMap(window, gameMap, towers, crittersCopy);
+        // Render the latest published state
+        {
+            TD_PROFILE_SCOPE(profile ? &renderProfiler : nullptr, PHASE_RENDER);
+            bool mapChanged = renderList.build(state);
+            renderFrame(window, renderList, mapVertices, entityVertices, mapChanged);
+        }
     }
 
-    // Free memory (delete dynamically allocated towers)
-    for (Tower* tower : towers) {
-        delete tower;
+    running.store(false);
+    simulation.join();
+
+    if (profile) {
+        profiler.printSummary(stdout);
+        renderProfiler.printSummary(stdout);
     }
 
+    if (recordPath != nullptr && !recording.save(recordPath)) {
+        TD_LOG_ERROR("Could not write replay %s", recordPath);
+        return 1;
+    }
     return 0;
 }
-
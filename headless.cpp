@@ -0,0 +1,305 @@
+/**
+ * @file headless.cpp
+ * @brief Command-line client that runs the game without a window.
+ *
+ * Usage: td_headless [--seed N] [--ticks N] [--width N] [--height N] [--threads N] [--towers N]
+ *                    [--layout TEXT] [--catalog FILE] [--open-field] [--winding]
+ *                    [--render-every N] [--frames DIR] [--snapshot-every N] [--checkpoint-dir DIR]
+ *                    [--record FILE] [--replay FILE] [--profile] [--profile-csv FILE]
+ *                    [--profile-json FILE] [--profile-sample N] [--verbose]
+ *
+ * Places --towers basic towers (or the towers of --layout, e.g. 3b2a) on the cells that cover
+ * the most path, simulates --ticks
+ * ticks and prints the final state together with the simulation speed. With --render-every,
+ * a frame is rasterized on the CPU every N ticks and the rendering cost is reported; with
+ * --frames, those frames are also written to DIR as PPM images. With --snapshot-every, the
+ * game state is captured into a rewind ring every N ticks and the snapshot cost and ring
+ * memory are reported, and the incremental state hash is checked against a full
+ * recomputation at every snapshot; with --checkpoint-dir, every snapshot is also written to DIR in the
+ * background. --record saves the player's commands and the tick checksums to FILE; --replay
+ * re-simulates such a recording at full speed and reports whether it reproduced the game.
+ * --profile prints p50/p99/max latencies of every tick phase; --profile-csv and
+ * --profile-json also export the timings of every tick. --profile-sample N measures only
+ * every N-th tick, which keeps the overhead negligible even on tiny maps. --open-field lets
+ * critters walk every free cell and towers go on the path, as long as they leave a route open.
+ * --winding plays on a winding, maze-like path picked from many candidates by MapGenerator.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <string>
+#include "Simulation.h"
+#include "RenderList.h"
+#include "SoftwareRasterizer.h"
+#include "Replay.h"
+#include "Logger.h"
+#include "TowerLayout.h"
+#include "TowerCatalog.h"
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+    SimulationConfig config;
+    int ticks = 10000;
+    int towerCount = 5;
+    vector<TowerType> layout;
+    bool verbose = false;
+    int renderEvery = 0;
+    string frameDir;
+    int snapshotEvery = 0;
+    string checkpointDir;
+    string recordPath;
+    string replayPath;
+    bool profile = false;
+    string profileCsv;
+    string profileJson;
+    int profileSample = 1;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            config.seed = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "--ticks") == 0 && hasValue) {
+            ticks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--width") == 0 && hasValue) {
+            config.width = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--height") == 0 && hasValue) {
+            config.height = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            config.threads = static_cast<size_t>(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--open-field") == 0) {
+            config.openField = true;
+        } else if (strcmp(argv[i], "--winding") == 0) {
+            config.windingPath = true;
+        } else if (strcmp(argv[i], "--catalog") == 0 && hasValue) {
+            string error;
+            if (!TowerCatalog::instance().load(argv[++i], error)) {
+                fprintf(stderr, "Cannot load tower catalog %s: %s\n", argv[i], error.c_str());
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--towers") == 0 && hasValue) {
+            towerCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--layout") == 0 && hasValue) {
+            if (!parseLayout(argv[++i], layout)) {
+                fprintf(stderr, "Invalid layout: %s (expected e.g. 3b2a)\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--render-every") == 0 && hasValue) {
+            renderEvery = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--frames") == 0 && hasValue) {
+            frameDir = argv[++i];
+            renderEvery = max(renderEvery, 1);
+        } else if (strcmp(argv[i], "--snapshot-every") == 0 && hasValue) {
+            snapshotEvery = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--checkpoint-dir") == 0 && hasValue) {
+            checkpointDir = argv[++i];
+            snapshotEvery = max(snapshotEvery, 1);
+        } else if (strcmp(argv[i], "--record") == 0 && hasValue) {
+            recordPath = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && hasValue) {
+            replayPath = argv[++i];
+        } else if (strcmp(argv[i], "--profile") == 0) {
+            profile = true;
+        } else if (strcmp(argv[i], "--profile-csv") == 0 && hasValue) {
+            profileCsv = argv[++i];
+            profile = true;
+        } else if (strcmp(argv[i], "--profile-json") == 0 && hasValue) {
+            profileJson = argv[++i];
+            profile = true;
+        } else if (strcmp(argv[i], "--profile-sample") == 0 && hasValue) {
+            profileSample = atoi(argv[++i]);
+            profile = true;
+        } else if (strcmp(argv[i], "--verbose") == 0) {
+            verbose = true;
+        } else {
+            fprintf(stderr, "Unknown or incomplete option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    // Towers and the map log every action and each tick is summarized; only keep that with --verbose
+    Logger::instance().setLevel(verbose ? LOG_DEBUG : LOG_OFF);
+
+    if (!replayPath.empty()) {
+        Replay replay;
+        if (!replay.load(replayPath)) {
+            fprintf(stderr, "Could not read replay %s\n", replayPath.c_str());
+            return 1;
+        }
+        ReplayResult result = playReplay(replay, config.threads);
+        Logger::instance().flush();
+
+        // The interactive client runs at 10 ticks per second at 1x speed
+        double realMs = replay.getTickCount() * 100.0;
+        printf("replay seed=%u map=%dx%d commands=%zu ticks=%llu\n", replay.getConfig().seed,
+               replay.getConfig().width, replay.getConfig().height, replay.getCommands().size(),
+               static_cast<unsigned long long>(replay.getTickCount()));
+        printf("elapsed=%.3f ms (%.0fx real time)\n", result.elapsedMs,
+               result.elapsedMs > 0 ? realMs / result.elapsedMs : 0.0);
+        if (!result.catalogMatched) {
+            printf("CATALOG MISMATCH: recorded with another tower catalog; pass the same --catalog FILE\n");
+            return 1;
+        }
+        if (!result.hashConsistent) {
+            printf("HASH MISMATCH after tick %llu: the incremental state hash differs from a full recomputation\n",
+                   static_cast<unsigned long long>(result.ticks));
+            return 1;
+        }
+        if (!result.matched) {
+            printf("DIVERGED between tick %llu and %llu\n", static_cast<unsigned long long>(result.divergedAfter),
+                   static_cast<unsigned long long>(result.divergedAfter + Replay::CHECKSUM_INTERVAL));
+            return 1;
+        }
+        printf("replay matched\n");
+        return 0;
+    }
+
+    Simulation sim(config);
+    Replay recording(config);
+    if (!recordPath.empty()) {
+        sim.setRecorder(&recording);
+    }
+    if (layout.empty()) {
+        layout.assign(max(towerCount, 0), BASIC_TOWER);
+    }
+    placeGreedyLayout(sim, layout);
+
+    Profiler profiler(!profileCsv.empty() || !profileJson.empty(), static_cast<uint64_t>(max(profileSample, 1)));
+    if (profile) {
+        sim.setProfiler(&profiler);
+    }
+
+    RenderList renderList;
+    SoftwareRasterizer rasterizer;
+    unique_ptr<ThreadPool> renderPool = config.threads > 1 ? make_unique<ThreadPool>(config.threads) : nullptr;
+    int frames = 0;
+    double renderMs = 0.0;
+    double ms = 0.0;
+
+    SnapshotRing ring;
+    unique_ptr<CheckpointWriter> checkpoints = checkpointDir.empty() ? nullptr : make_unique<CheckpointWriter>();
+    vector<uint8_t> snapshot;
+    int snapshots = 0;
+    double snapshotMs = 0.0;
+    bool hashOk = true;  // Incremental state hash equal to a full recomputation at every snapshot
+
+    for (int done = 0; done < ticks && !sim.isGameOver();) {
+        int chunk = ticks - done;
+        if (renderEvery > 0) {
+            chunk = min(chunk, renderEvery - done % renderEvery);
+        }
+        if (snapshotEvery > 0) {
+            chunk = min(chunk, snapshotEvery - done % snapshotEvery);
+        }
+
+        auto start = chrono::steady_clock::now();
+        sim.step(chunk);
+        auto end = chrono::steady_clock::now();
+        ms += chrono::duration<double, milli>(end - start).count();
+        done += chunk;
+
+        if (snapshotEvery > 0 && done % snapshotEvery == 0) {
+            hashOk = hashOk && sim.stateHash() == sim.recomputeStateHash();
+            start = chrono::steady_clock::now();
+            sim.saveSnapshot(snapshot);
+            ring.push(snapshot);
+            end = chrono::steady_clock::now();
+            snapshotMs += chrono::duration<double, milli>(end - start).count();
+
+            if (checkpoints) {
+                char name[40];
+                snprintf(name, sizeof(name), "/checkpoint_%06d.tds", snapshots);
+                checkpoints->write(checkpointDir + name, snapshot);
+            }
+            snapshots++;
+        }
+
+        if (renderEvery > 0 && done % renderEvery == 0) {
+            start = chrono::steady_clock::now();
+            {
+                TD_PROFILE_SCOPE(profile ? &profiler : nullptr, PHASE_RENDER);
+                renderList.build(sim.getMap(), sim.getTowers(), sim.getCritters(), sim.getProjectiles());
+                rasterizer.render(renderList, renderPool.get());
+            }
+            end = chrono::steady_clock::now();
+            renderMs += chrono::duration<double, milli>(end - start).count();
+
+            if (!frameDir.empty()) {
+                char name[32];
+                snprintf(name, sizeof(name), "/frame_%06d.ppm", frames);
+                if (!rasterizer.savePPM(frameDir + name)) {
+                    fprintf(stderr, "Could not write %s%s\n", frameDir.c_str(), name);
+                    return 1;
+                }
+            }
+            frames++;
+        }
+    }
+
+    // Restoring the oldest snapshot in the ring into a fresh game and saving it again must give the same bytes
+    bool rewindOk = true;
+    if (ring.size() > 0) {
+        Simulation restored(config);
+        vector<uint8_t> oldest, reloaded;
+        rewindOk = ring.get(ring.size() - 1, oldest) && restored.loadSnapshot(oldest);
+        if (rewindOk) {
+            restored.saveSnapshot(reloaded);
+            rewindOk = reloaded == oldest;
+            hashOk = hashOk && restored.stateHash() == restored.recomputeStateHash();
+        }
+    }
+
+
+    Logger::instance().flush();
+    printf("seed=%u map=%dx%d towers=%zu\n", config.seed, config.width, config.height, sim.getTowers().size());
+    printf("ticks=%llu wave=%d gold=%d health=%d kills=%d leaks=%d%s\n",
+           static_cast<unsigned long long>(sim.getTick()), sim.getWave(), sim.getGold(), sim.getHealth(),
+           sim.getKills(), sim.getLeaks(), sim.isGameOver() ? " (game over)" : "");
+    printf("elapsed=%.3f ms (%.1f ticks/ms)\n", ms, ms > 0 ? sim.getTick() / ms : 0.0);
+    if (frames > 0) {
+        printf("frames=%d %dx%d px render=%.3f ms/frame\n", frames, rasterizer.getWidth(), rasterizer.getHeight(),
+               renderMs / frames);
+    }
+    if (snapshots > 0) {
+        printf("snapshots=%d size=%zu bytes save=%.1f us/snapshot ring=%zu entries %zu bytes rewind=%s hash=%s\n",
+               snapshots, snapshot.size(), snapshotMs * 1000.0 / snapshots, ring.size(), ring.getStoredBytes(),
+               rewindOk ? "ok" : "MISMATCH", hashOk ? "ok" : "MISMATCH");
+    }
+    if (profile) {
+#ifndef TD_ENABLE_PROFILING
+        printf("profiling is compiled out; reconfigure with -DTD_ENABLE_PROFILING=ON\n");
+#endif
+        profiler.printSummary(stdout);
+        if (!profileCsv.empty() && !profiler.writeCSV(profileCsv)) {
+            fprintf(stderr, "Could not write %s\n", profileCsv.c_str());
+            return 1;
+        }
+        if (!profileJson.empty() && !profiler.writeJSON(profileJson)) {
+            fprintf(stderr, "Could not write %s\n", profileJson.c_str());
+            return 1;
+        }
+    }
+    if (!recordPath.empty()) {
+        vector<uint8_t> encoded;
+        recording.encode(encoded);
+        if (!recording.save(recordPath)) {
+            fprintf(stderr, "Could not write replay %s\n", recordPath.c_str());
+            return 1;
+        }
+        printf("recorded %zu commands over %llu ticks to %s (%zu bytes)\n", recording.getCommands().size(),
+               static_cast<unsigned long long>(recording.getTickCount()), recordPath.c_str(), encoded.size());
+    }
+    if (checkpoints) {
+        checkpoints->flush();
+        if (checkpoints->getFailures() > 0) {
+            fprintf(stderr, "%zu checkpoints could not be written to %s\n", checkpoints->getFailures(),
+                    checkpointDir.c_str());
+            return 1;
+        }
+    }
+    return rewindOk && hashOk ? 0 : 1;
+}
@@ -4,8 +4,12 @@
  */
 
 #include "mapgen.h"
-#include <cstdlib>  // rand()
 #include <ctime>    // time()
+#include <random>   // mt19937
+#include <algorithm>
+#include "Logger.h"
+#include "TowerCatalog.h"
+#include "Zobrist.h"
 
 /**
  * @brief Constructs a new Map object with given dimensions.
@@ -17,33 +21,143 @@ Map::Map(int w, int h) {
     height = h;
     entrySet = false;
     exitSet = false;
+    openField = false;
+    revision = 0;
+    zobrist = 0;
 
     // Create a 2D grid filled with SCENERY
-    grid.resize(height, vector<CellType>(width, SCENERY));
+    layout = make_shared<Layout>();
+    layout->grid.resize(height, vector<CellType>(width, SCENERY));
+    layout->coverageRanges = TowerCatalog::instance().getRanges();
+    layout->coverageBuilt = false;
+}
+
+/**
+ * @brief Gets the layout for writing, cloning it first if other maps share it.
+ * @return Layout owned by this map alone.
+ */
+Map::Layout& Map::mutableLayout() {
+    if (layout.use_count() > 1) {
+        layout = make_shared<Layout>(*layout);
+    }
+    return *layout;
+}
+
+/**
+ * @brief Checks the tower overlay for a cell.
+ * @param x X-coordinate.
+ * @param y Y-coordinate.
+ * @return True if a tower stands on the cell.
+ */
+bool Map::hasTower(int x, int y) const {
+    size_t bit = static_cast<size_t>(y) * width + x;
+    return !towerCells.empty() && (towerCells[bit / 64] >> (bit % 64) & 1) != 0;
+}
+
+/**
+ * @brief Computes the coverage heatmap ahead of time so copies only ever read the shared layout.
+ */
+void Map::prepareForSharing() {
+    if (!layout->coverageBuilt) {
+        buildCoverage();
+    }
 }
 
 /**
  * @brief Sets a cell as PATH if coordinates are valid.
+ *
+ * Only the terrain changes: a tower standing on the cell stays there.
+ *
  * @param x X-coordinate.
  * @param y Y-coordinate.
  */
  void Map::setPath(int x, int y) {
-    if (isValidCoordinate(x, y)) {
-        grid[y][x] = PATH;
+    if (isValidCoordinate(x, y) && layout->grid[y][x] != PATH) {
+        if (hasTower(x, y)) {
+            mutableLayout().grid[y][x] = PATH;
+            revision++;
+        } else {
+            writeCell(x, y, PATH);
+        }
+        if (layout->coverageBuilt) {
+            adjustCoverage(x, y, 1);
+        }
     }
 }
 
+/**
+ * @brief Gets the Zobrist key of a cell type at (x, y).
+ * @param x X-coordinate.
+ * @param y Y-coordinate.
+ * @param type Cell type.
+ * @return Key of the cell, or 0 for SCENERY.
+ */
+uint64_t Map::cellZobrist(int x, int y, CellType type) {
+    return type == SCENERY ? 0 : zobristKey(ZOBRIST_CELL, zobristCell(x, y), type);
+}
+
+/**
+ * @brief Computes the Zobrist hash of the cells and entry/exit points from scratch.
+ * @return Hash of the current cells and endpoints.
+ */
+uint64_t Map::computeZobrist() const {
+    uint64_t hash = 0;
+    if (entrySet) {
+        hash ^= zobristKey(ZOBRIST_ENDPOINT, 0, zobristCell(entryPoint.first, entryPoint.second));
+    }
+    if (exitSet) {
+        hash ^= zobristKey(ZOBRIST_ENDPOINT, 1, zobristCell(exitPoint.first, exitPoint.second));
+    }
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            hash ^= cellZobrist(x, y, getCell(x, y));
+        }
+    }
+    return hash;
+}
+
+/**
+ * @brief Changes the type of a valid cell, keeping the Zobrist hash and revision up to date.
+ * @param x X-coordinate.
+ * @param y Y-coordinate.
+ * @param type New type of the cell.
+ */
+void Map::writeCell(int x, int y, CellType type) {
+    zobrist ^= cellZobrist(x, y, getCell(x, y)) ^ cellZobrist(x, y, type);
+
+    size_t bit = static_cast<size_t>(y) * width + x;
+    if (type == TOWER) {
+        if (towerCells.empty()) {
+            towerCells.assign((static_cast<size_t>(width) * height + 63) / 64, 0);
+        }
+        towerCells[bit / 64] |= uint64_t(1) << (bit % 64);
+    } else if (!towerCells.empty()) {
+        towerCells[bit / 64] &= ~(uint64_t(1) << (bit % 64));
+    }
+
+    // Towers stand on top of the terrain; only terrain changes touch the shared layout
+    CellType terrain = type == TOWER ? layout->grid[y][x] : type;
+    if (layout->grid[y][x] != terrain) {
+        mutableLayout().grid[y][x] = terrain;
+    }
+    revision++;
+}
+
 /**
  * @brief Sets the entry point if it's a valid PATH cell.
  * @param x X-coordinate.
  * @param y Y-coordinate.
  */
  void Map::setEntry(int x, int y) {
-    if (isValidCoordinate(x, y) && grid[y][x] == PATH) {
+    if (isPath(x, y)) {
+        if (entrySet) {
+            zobrist ^= zobristKey(ZOBRIST_ENDPOINT, 0, zobristCell(entryPoint.first, entryPoint.second));
+        }
         entryPoint = {x, y};
         entrySet = true;
+        zobrist ^= zobristKey(ZOBRIST_ENDPOINT, 0, zobristCell(x, y));
     } else {
-        cout << "Invalid entry point! Must be a PATH cell." << endl;
+        TD_LOG_WARN("Invalid entry point! Must be a PATH cell.");
     }
 }
 
@@ -53,11 +167,15 @@ Map::Map(int w, int h) {
  * @param y Y-coordinate.
  */
  void Map::setExit(int x, int y) {
-    if (isValidCoordinate(x, y) && grid[y][x] == PATH) {
+    if (isPath(x, y)) {
+        if (exitSet) {
+            zobrist ^= zobristKey(ZOBRIST_ENDPOINT, 1, zobristCell(exitPoint.first, exitPoint.second));
+        }
         exitPoint = {x, y};
         exitSet = true;
+        zobrist ^= zobristKey(ZOBRIST_ENDPOINT, 1, zobristCell(x, y));
     } else {
-        cout << "Invalid exit point! Must be a PATH cell." << endl;
+        TD_LOG_WARN("Invalid exit point! Must be a PATH cell.");
     }
 }
 
@@ -69,20 +187,39 @@ Map::Map(int w, int h) {
  */
  bool Map::placeTower(int x, int y) {
     if (!isValidCoordinate(x, y)) {
-        cout << "Invalid coordinates!" << endl;
+        TD_LOG_WARN("Invalid coordinates!");
+        return false;
+    }
+    if (layout->grid[y][x] == PATH && !openField) {
+        TD_LOG_WARN("Cannot place tower on a path!");
         return false;
     }
-    if (grid[y][x] == PATH) {
-        cout << "Cannot place tower on a path!" << endl;
+    if ((entrySet && entryPoint == make_pair(x, y)) || (exitSet && exitPoint == make_pair(x, y))) {
+        TD_LOG_WARN("Cannot place tower on the entry or exit!");
         return false;
     }
-    if (grid[y][x] == TOWER) {
-        cout << "A tower is already placed here!" << endl;
+    if (hasTower(x, y)) {
+        TD_LOG_WARN("A tower is already placed here!");
+        return false;
+    }
+
+    writeCell(x, y, TOWER);
+    TD_LOG_DEBUG("Map cell (%d, %d) marked as tower", x, y);
+    return true;
+}
+
+/**
+ * @brief Removes a tower from the map, uncovering the terrain underneath.
+ * @param x X-coordinate.
+ * @param y Y-coordinate.
+ * @return True if a tower was removed, false otherwise.
+ */
+ bool Map::removeTower(int x, int y) {
+    if (!isValidCoordinate(x, y) || !hasTower(x, y)) {
         return false;
     }
 
-    grid[y][x] = TOWER;
-    cout << "Tower placed at (" << x << ", " << y << ")" << endl;
+    writeCell(x, y, layout->grid[y][x]);
     return true;
 }
 
@@ -113,9 +250,9 @@ Map::Map(int w, int h) {
                 cout << "E ";          // Entry point
             else if (exitSet && exitPoint == make_pair(x, y))
                 cout << "X ";          // Exit point
-            else if (grid[y][x] == TOWER)
+            else if (hasTower(x, y))
                 cout << "T ";          // Tower cell (NEW)
-            else if (grid[y][x] == PATH)
+            else if (layout->grid[y][x] == PATH)
                 cout << "# ";          // Path cell
             else
                 cout << ". ";          // Scenery cell
@@ -130,7 +267,7 @@ Map::Map(int w, int h) {
  */
  bool Map::validateMap() {
     if (!entrySet || !exitSet) {
-        cout << "Error: Entry and exit points must be set!" << endl;
+        TD_LOG_ERROR("Entry and exit points must be set!");
         return false;
     }
     return isPathConnected();  // Check if there's a valid path
@@ -179,7 +316,7 @@ bool Map::isPathConnected() {
             int newX = currentX + dx[i];
             int newY = currentY + dy[i];
 
-            if (isValidCoordinate(newX, newY) && !visited[newY][newX] && grid[newY][newX] == PATH) {
+            if (isValidCoordinate(newX, newY) && !visited[newY][newX] && layout->grid[newY][newX] == PATH) {
                 toCheck.push({newX, newY});
                 visited[newY][newX] = true;
             }
@@ -192,36 +329,63 @@ bool Map::isPathConnected() {
  * @brief Generates a random valid map layout.
  */
  void Map::generateRandomMap() {
-    srand(time(0));  // Initialize random number generator
-
-    // Set entry and exit points on opposite sides
-    int entryX = 0, entryY = rand() % height;
-    int exitX = width - 1, exitY = rand() % height;
+    generateRandomMap(static_cast<unsigned int>(time(0)));
+}
 
-    entryPoint = {entryX, entryY};
-    exitPoint = {exitX, exitY};
-    entrySet = exitSet = true;
+/**
+ * @brief Generates a random valid map layout from a seed.
+ * @param seed Seed for the layout's random number generator.
+ */
+ void Map::generateRandomMap(unsigned int seed) {
+    mt19937 rng(seed);  // Local generator: deterministic per seed and safe to use from several threads
 
-    // Reset map to all scenery
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            grid[y][x] = SCENERY;
-        }
-    }
+    // Set entry and exit points on opposite sides
+    int entryX = 0, entryY = rng() % height;
+    int exitX = width - 1, exitY = rng() % height;
 
     // Create random path from entry to exit
     int x = entryX, y = entryY;
-    grid[y][x] = PATH;
+    vector<pair<int, int>> path = {{x, y}};
 
     while (x != exitX || y != exitY) {
-        int direction = rand() % 2;  // Randomly choose horizontal or vertical movement
+        int direction = rng() % 2;  // Randomly choose horizontal or vertical movement
         if (direction == 0 && x != exitX) {
             x += (exitX > x) ? 1 : -1;  // Move right if exit is to the right, else left
         } else if (y != exitY) {
             y += (exitY > y) ? 1 : -1;  // Move down if exit is below, else up
         }
-        grid[y][x] = PATH;  // Mark the cell as path
+        path.push_back({x, y});
     }
+    loadPath(path);
+}
+
+/**
+ * @brief Replaces the terrain with a path of PATH cells.
+ *
+ * @param path Cells from entry to exit, each next to the one before.
+ */
+void Map::loadPath(const vector<pair<int, int>>& path) {
+    entryPoint = path.front();
+    exitPoint = path.back();
+    entrySet = exitSet = true;
+
+    // Reset map to all scenery
+    Layout& terrain = mutableLayout();
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            terrain.grid[y][x] = SCENERY;
+        }
+    }
+    towerCells.clear();
+    zobrist = zobristKey(ZOBRIST_ENDPOINT, 0, zobristCell(entryPoint.first, entryPoint.second))
+              ^ zobristKey(ZOBRIST_ENDPOINT, 1, zobristCell(exitPoint.first, exitPoint.second));
+
+    for (const pair<int, int>& cell : path) {
+        writeCell(cell.first, cell.second, PATH);
+    }
+
+    layout->coverageBuilt = false;  // The whole layout changed; rebuild the heatmap on next use
+    revision++;
 }
 
 /**
@@ -231,5 +395,169 @@ bool Map::isPathConnected() {
  * @return True if cell is PATH, false if SCENERY.
  */
 bool Map::isPath(int x, int y) const {
-    return isValidCoordinate(x, y) && grid[y][x] == PATH;
+    return isValidCoordinate(x, y) && layout->grid[y][x] == PATH;
+}
+
+/**
+ * @brief Checks if critters may enter a cell.
+ * @param x X-coordinate.
+ * @param y Y-coordinate.
+ * @return True for PATH cells, or for every cell without a tower in open-field mode.
+ */
+bool Map::isWalkable(int x, int y) const {
+    if (!isValidCoordinate(x, y)) {
+        return false;
+    }
+    return openField ? !hasTower(x, y) : layout->grid[y][x] == PATH;
+}
+
+/**
+ * @brief Gets the type of a cell.
+ * @param x X-coordinate.
+ * @param y Y-coordinate.
+ * @return Type of the cell; SCENERY for invalid coordinates.
+ */
+CellType Map::getCell(int x, int y) const {
+    if (!isValidCoordinate(x, y)) {
+        return SCENERY;
+    }
+    return hasTower(x, y) ? TOWER : layout->grid[y][x];
+}
+
+/**
+ * @brief Overwrites the type of a cell.
+ * @param x X-coordinate.
+ * @param y Y-coordinate.
+ * @param type New type of the cell.
+ */
+void Map::setCell(int x, int y, CellType type) {
+    if (!isValidCoordinate(x, y) || getCell(x, y) == type) {
+        return;
+    }
+
+    // A tower keeps the terrain under it, so only a change of terrain moves the heatmap
+    CellType terrain = type == TOWER ? layout->grid[y][x] : type;
+    if (layout->coverageBuilt && (layout->grid[y][x] == PATH) != (terrain == PATH)) {
+        adjustCoverage(x, y, terrain == PATH ? 1 : -1);
+    }
+    writeCell(x, y, type);
+}
+
+/**
+ * @brief Sets the tower ranges the coverage heatmap is maintained for.
+ * Setting the ranges the map already has changes nothing, so a shared layout stays shared.
+ *
+ * @param ranges Manhattan ranges to support.
+ */
+void Map::setCoverageRanges(const vector<int>& ranges) {
+    if (ranges == layout->coverageRanges) {
+        return;
+    }
+    Layout& terrain = mutableLayout();
+    terrain.coverageRanges = ranges;
+    terrain.coverageBuilt = false;
+}
+
+/**
+ * @brief Rebuilds the coverage heatmap for every supported range.
+ *
+ * In rotated coordinates u = x + y and v = x - y + (height - 1), the Manhattan diamond
+ * |dx| + |dy| <= r around a cell becomes the square |du| <= r, |dv| <= r. One prefix-sum
+ * table over the rotated grid therefore answers every range in O(1) per cell.
+ */
+void Map::buildCoverage() {
+    int n = width + height - 1;  // Side of the rotated grid
+    int stride = n + 1;
+    vector<int> prefix(static_cast<size_t>(stride) * stride, 0);
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (layout->grid[y][x] == PATH) {
+                int u = x + y;
+                int v = x - y + height - 1;
+                prefix[(u + 1) * stride + (v + 1)] = 1;
+            }
+        }
+    }
+    for (int u = 1; u <= n; u++) {
+        for (int v = 1; v <= n; v++) {
+            prefix[u * stride + v] += prefix[(u - 1) * stride + v] + prefix[u * stride + v - 1]
+                                      - prefix[(u - 1) * stride + v - 1];
+        }
+    }
+
+    Layout& terrain = mutableLayout();
+    terrain.coverage.assign(terrain.coverageRanges.size(), vector<int>(static_cast<size_t>(width) * height, 0));
+    for (size_t r = 0; r < terrain.coverageRanges.size(); r++) {
+        int range = terrain.coverageRanges[r];
+        vector<int>& counts = terrain.coverage[r];
+
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                int u = x + y;
+                int v = x - y + height - 1;
+                int u0 = max(u - range, 0), u1 = min(u + range, n - 1);
+                int v0 = max(v - range, 0), v1 = min(v + range, n - 1);
+                counts[y * width + x] = prefix[(u1 + 1) * stride + (v1 + 1)] - prefix[u0 * stride + (v1 + 1)]
+                                        - prefix[(u1 + 1) * stride + v0] + prefix[u0 * stride + v0];
+            }
+        }
+    }
+
+    terrain.coverageBuilt = true;
+}
+
+/**
+ * @brief Adds delta to the coverage of every cell within range of (x, y).
+ * @param x X-coordinate of the changed cell.
+ * @param y Y-coordinate of the changed cell.
+ * @param delta +1 when the cell became PATH, -1 when it stopped being PATH.
+ */
+void Map::adjustCoverage(int x, int y, int delta) {
+    Layout& terrain = mutableLayout();
+    for (size_t r = 0; r < terrain.coverageRanges.size(); r++) {
+        int range = terrain.coverageRanges[r];
+        vector<int>& counts = terrain.coverage[r];
+
+        for (int cy = max(y - range, 0); cy <= min(y + range, height - 1); cy++) {
+            int reach = range - abs(cy - y);
+            for (int cx = max(x - reach, 0); cx <= min(x + reach, width - 1); cx++) {
+                counts[cy * width + cx] += delta;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Gets the number of PATH cells a tower at (x, y) would cover.
+ * @param x X-coordinate of the candidate cell.
+ * @param y Y-coordinate of the candidate cell.
+ * @param range Manhattan range of the tower.
+ * @return Number of PATH cells within range, or 0 for invalid coordinates.
+ */
+int Map::getCoverage(int x, int y, int range) {
+    if (!isValidCoordinate(x, y)) {
+        return 0;
+    }
+
+    for (size_t r = 0; r < layout->coverageRanges.size(); r++) {
+        if (layout->coverageRanges[r] == range) {
+            if (!layout->coverageBuilt) {
+                buildCoverage();
+            }
+            return layout->coverage[r][y * width + x];
+        }
+    }
+
+    // Unsupported range: count the diamond directly
+    int count = 0;
+    for (int cy = max(y - range, 0); cy <= min(y + range, height - 1); cy++) {
+        int reach = range - abs(cy - y);
+        for (int cx = max(x - reach, 0); cx <= min(x + reach, width - 1); cx++) {
+            if (layout->grid[cy][cx] == PATH) {
+                count++;
+            }
+        }
+    }
+    return count;
 }
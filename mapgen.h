@@ -4,6 +4,8 @@
 #include <iostream>
 #include <vector>
 #include <queue>
+#include <memory>
+#include <cstdint>
 
 using namespace std;
 
@@ -16,7 +18,7 @@ using namespace std;
  * - PATH: The route that critters (enemies) follow from entry to exit point
  * - TOWER: A location where a tower is placed
  */
-enum CellType { SCENERY, PATH, TOWER };
+enum CellType : uint8_t { SCENERY, PATH, TOWER };
 
 /**
  * @class Map
@@ -28,24 +30,81 @@ enum CellType { SCENERY, PATH, TOWER };
  * - Managing entry and exit points
  * - Ensuring map validity (connected path, proper entry/exit)
  * - Generating random valid maps
- * - Allowing towers to be placed on SCENERY cells
+ * - Allowing towers to be placed on SCENERY cells, or on any free cell in open-field mode
+ * - Sharing its terrain copy-on-write with copies of itself
  */
 class Map {
 private:
+    /**
+     * @struct Layout
+     * @brief Terrain of a map: PATH/SCENERY cells and the coverage heatmap derived from them.
+     *
+     * Copies of a map share one layout and only clone it when one of them changes its
+     * terrain, so thousands of sessions on the same level keep a single copy of the grid
+     * and heatmap. Towers live in a per-map overlay and never force a clone.
+     */
+    struct Layout {
+        vector<vector<CellType>> grid;    // PATH or SCENERY for every cell
+        vector<int> coverageRanges;       // Tower ranges the coverage heatmap is maintained for
+        vector<vector<int>> coverage;     // Per range: number of PATH cells within range of each cell
+        bool coverageBuilt;               // True while the coverage heatmap is up to date
+    };
+
     int width, height;                    // Dimensions of the map grid
-    vector<vector<CellType>> grid;        // 2D grid representing the map layout
+    shared_ptr<Layout> layout;            // Terrain, shared copy-on-write with copies of this map
+    vector<uint64_t> towerCells;          // One bit per cell holding a tower; empty until the first tower
     pair<int, int> entryPoint;            // Starting point where critters spawn
     pair<int, int> exitPoint;             // End point where critters escape
     bool entrySet, exitSet;               // Flags to track if entry/exit points are defined
+    bool openField;                       // True if critters may walk every cell without a tower
+    unsigned long long revision;          // Incremented on every change to the grid
+    uint64_t zobrist;                     // Zobrist hash of the cells and endpoints, updated on every change
 
     /**
-     * @brief Validates if given coordinates are within map boundaries
-     * @param x X-coordinate to check
-     * @param y Y-coordinate to check
-     * @return true if coordinates are valid, false otherwise
+     * @brief Gets the layout for writing, cloning it first if other maps share it
+     * @return Layout owned by this map alone
      */
-    bool isValidCoordinate(int x, int y) const;
+    Layout& mutableLayout();
+
+    /**
+     * @brief Checks the tower overlay for a cell
+     * @param x X-coordinate of a valid cell
+     * @param y Y-coordinate of a valid cell
+     * @return true if a tower stands on the cell
+     */
+    bool hasTower(int x, int y) const;
+
+    /**
+     * @brief Rebuilds the coverage heatmap for every supported range in a single pass
+     * Path cells are counted with 2-D prefix sums in rotated (u = x + y, v = x - y) coordinates,
+     * where each Manhattan diamond becomes an axis-aligned square
+     */
+    void buildCoverage();
+
+    /**
+     * @brief Adds delta to the coverage of every cell within range of (x, y)
+     * Used to keep the heatmap current when a single cell joins or leaves the path
+     * @param x X-coordinate of the changed cell
+     * @param y Y-coordinate of the changed cell
+     * @param delta +1 when the cell became PATH, -1 when it stopped being PATH
+     */
+    void adjustCoverage(int x, int y, int delta);
+
+    /**
+     * @brief Gets the Zobrist key of a cell type at (x, y)
+     * SCENERY has no key, so an empty map hashes to 0
+     */
+    static uint64_t cellZobrist(int x, int y, CellType type);
+
+    /**
+     * @brief Changes the type of a valid cell, keeping the tower overlay, Zobrist hash and revision up to date
+     * @param x X-coordinate of the cell
+     * @param y Y-coordinate of the cell
+     * @param type New type of the cell
+     */
+    void writeCell(int x, int y, CellType type);
 
+public:
     /**
      * @brief Checks if there exists a valid path from entry to exit point
      * Uses breadth-first search to verify path connectivity
@@ -53,7 +112,6 @@ private:
      */
     bool isPathConnected();
 
-public:
     /**
      * @brief Constructs a new map with specified dimensions
      * @param w Width of the map
@@ -62,8 +120,63 @@ public:
      */
     Map(int w, int h);
 
+    /**
+     * @brief Validates if given coordinates are within map boundaries
+     * @param x X-coordinate to check
+     * @param y Y-coordinate to check
+     * @return true if coordinates are valid, false otherwise
+     */
+    bool isValidCoordinate(int x, int y) const;
+
+    /** @brief Gets the width of the map in cells. */
+    int getWidth() const { return width; }
+
+    /** @brief Gets the height of the map in cells. */
+    int getHeight() const { return height; }
+
+    /**
+     * @brief Gets the revision of the grid
+     * Changes whenever a cell changes type, so renderers can cache the static map layer
+     * @return Current revision number
+     */
+    unsigned long long getRevision() const { return revision; }
+
+    /**
+     * @brief Gets the Zobrist hash of the cells and entry/exit points
+     * Maintained in O(1) per changed cell; equal maps have equal hashes on every run and thread
+     * @return Current hash
+     */
+    uint64_t getZobrist() const { return zobrist; }
+
+    /**
+     * @brief Computes the Zobrist hash of the cells and entry/exit points from scratch
+     * O(width * height); a check of getZobrist(), which it equals unless an update was missed
+     * @return Hash of the current cells and endpoints
+     */
+    uint64_t computeZobrist() const;
+
+    /**
+     * @brief Switches open-field mode on or off
+     * In open-field mode critters may walk every cell that holds no tower, and towers may be
+     * placed on PATH cells too (never on the entry or exit), so players build the route
+     * @param enabled True for open-field mode
+     */
+    void setOpenField(bool enabled) { openField = enabled; }
+
+    /** @brief Checks if the map is in open-field mode. */
+    bool isOpenField() const { return openField; }
+
+    /**
+     * @brief Checks if critters may enter a cell
+     * @param x X-coordinate to check
+     * @param y Y-coordinate to check
+     * @return true for PATH cells, or for every cell without a tower in open-field mode
+     */
+    bool isWalkable(int x, int y) const;
+
     /**
      * @brief Marks a cell as part of the PATH
+     * A tower on the cell keeps standing; only the terrain under it changes
      * @param x X-coordinate of the cell
      * @param y Y-coordinate of the cell
      * Used for creating the route that critters will follow
@@ -94,6 +207,14 @@ public:
      */
     bool placeTower(int x, int y);
 
+    /**
+     * @brief Removes a tower from the given location, uncovering the terrain underneath
+     * @param x X-coordinate
+     * @param y Y-coordinate
+     * @return true if a tower was removed, false if the cell held no tower
+     */
+    bool removeTower(int x, int y);
+
     /**
      * @brief Gets the current entry point coordinates
      * @return pair<int, int> containing (x,y) coordinates
@@ -131,13 +252,84 @@ public:
      */
     void generateRandomMap();
 
+    /**
+     * @brief Generates a random valid map layout from a seed
+     * The same seed always produces the same layout, on every platform
+     * @param seed Seed for the layout's random number generator
+     */
+    void generateRandomMap(unsigned int seed);
+
+    /**
+     * @brief Replaces the terrain with a path of PATH cells
+     * Every other cell becomes SCENERY and towers are removed; the first cell becomes the entry
+     * and the last one the exit
+     * @param path Cells from entry to exit, each next to the one before
+     */
+    void loadPath(const vector<pair<int, int>>& path);
+
     /**
      * @brief Checks if a given cell is part of the PATH
+     * Looks at the terrain only; in open-field mode a tower may stand on a PATH cell
      * @param x X-coordinate to check
      * @param y Y-coordinate to check
      * @return true if cell is PATH, false if SCENERY
      */
     bool isPath(int x, int y) const;
+
+    /**
+     * @brief Gets the type of a cell
+     * @param x X-coordinate of the cell
+     * @param y Y-coordinate of the cell
+     * @return Type of the cell; SCENERY for invalid coordinates
+     */
+    CellType getCell(int x, int y) const;
+
+    /**
+     * @brief Overwrites the type of a cell, e.g. when restoring a saved map
+     * Keeps the coverage heatmap and the revision up to date
+     * @param x X-coordinate of the cell
+     * @param y Y-coordinate of the cell
+     * @param type New type of the cell
+     */
+    void setCell(int x, int y, CellType type);
+
+    /**
+     * @brief Sets the tower ranges the coverage heatmap is maintained for
+     * Maps start with TowerCatalog::getRanges(); setting the same ranges again changes nothing
+     * @param ranges Manhattan ranges to support, e.g. {2, 3}
+     */
+    void setCoverageRanges(const vector<int>& ranges);
+
+    /**
+     * @brief Gets the tower ranges the coverage heatmap is maintained for
+     * @return Supported ranges
+     */
+    const vector<int>& getCoverageRanges() const { return layout->coverageRanges; }
+
+    /**
+     * @brief Computes the lazily built terrain data (the coverage heatmap) ahead of time
+     * After this, copies of the map share a layout they only read, so they can be used
+     * from different threads until one of them changes its terrain
+     */
+    void prepareForSharing();
+
+    /**
+     * @brief Checks if this map shares its terrain with another map
+     * @param other Map to compare with
+     * @return true if both maps read the same layout
+     */
+    bool sharesLayoutWith(const Map& other) const { return layout == other.layout; }
+
+    /**
+     * @brief Gets the number of PATH cells a tower at (x, y) would cover
+     * O(1) for supported ranges once the heatmap is built; the heatmap is built on first use
+     * and kept current by setPath afterwards. Unsupported ranges fall back to a direct scan
+     * @param x X-coordinate of the candidate cell
+     * @param y Y-coordinate of the candidate cell
+     * @param range Manhattan range of the tower
+     * @return Number of PATH cells within range, or 0 for invalid coordinates
+     */
+    int getCoverage(int x, int y, int range);
 };
 
 #endif // MAPGEN_H
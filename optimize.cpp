@@ -0,0 +1,88 @@
+/**
+ * @file optimize.cpp
+ * @brief Searches the strongest tower layout a budget can buy on one map.
+ *
+ * Usage: td_optimize [--seed N] [--width N] [--height N] [--budget N] [--max-waves N]
+ *                    [--health N] [--cells N] [--beam N] [--generations N] [--evaluations N]
+ *                    [--threads N] [--catalog FILE]
+ *
+ * Runs a LayoutOptimizer beam search on the map of --seed, simulating candidate layouts
+ * in parallel, and prints the best layout next to the greedy coverage layout it started from.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "LayoutOptimizer.h"
+#include "TowerCatalog.h"
+#include "Logger.h"
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+    SimulationConfig config;
+    OptimizerConfig options;
+    size_t threads = 0;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            config.seed = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "--width") == 0 && hasValue) {
+            config.width = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--height") == 0 && hasValue) {
+            config.height = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--budget") == 0 && hasValue) {
+            options.budget = max(atoi(argv[++i]), 0);
+        } else if (strcmp(argv[i], "--max-waves") == 0 && hasValue) {
+            options.maxWaves = max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "--health") == 0 && hasValue) {
+            config.startingHealth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--cells") == 0 && hasValue) {
+            options.candidateCells = max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "--beam") == 0 && hasValue) {
+            options.beamWidth = max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "--generations") == 0 && hasValue) {
+            options.generations = max(atoi(argv[++i]), 0);
+        } else if (strcmp(argv[i], "--evaluations") == 0 && hasValue) {
+            options.maxEvaluations = max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = static_cast<size_t>(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--catalog") == 0 && hasValue) {
+            string error;
+            if (!TowerCatalog::instance().load(argv[++i], error)) {
+                fprintf(stderr, "Cannot load tower catalog %s: %s\n", argv[i], error.c_str());
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "Unknown or incomplete option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    Logger::instance().setLevel(LOG_OFF);
+    // The budget is the only gold available before the first wave
+    config.startingGold = options.budget;
+    ThreadPool pool(threads);
+    LayoutOptimizer optimizer(config, options, &pool);
+
+    printf("Seed %u, %dx%d map, budget %d, up to %d waves, %zu threads\n", config.seed, config.width, config.height,
+           options.budget, options.maxWaves, pool.size());
+
+    auto start = chrono::steady_clock::now();
+    OptimizerResult result = optimizer.optimize();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    printf("Greedy layout: %d waves, %d kills, %d leaks\n", result.greedyScore.wavesSurvived,
+           result.greedyScore.kills, result.greedyScore.leaks);
+    printf("Best layout: %d waves, %d kills, %d leaks\n", result.score.wavesSurvived, result.score.kills,
+           result.score.leaks);
+    for (const TowerPlacement& tower : result.layout) {
+        printf("  %s at (%d, %d)\n", tower.type == AOE_TOWER ? "AoE  " : "Basic", tower.x, tower.y);
+    }
+    printf("Simulated %zu layouts, %zu transposition hits, %zu pruned, %.2f s (%.1f layouts/s)\n", result.simulated,
+           result.cacheHits, result.pruned, seconds, result.simulated / max(seconds, 1e-9));
+    return 0;
+}
@@ -0,0 +1,162 @@
+/**
+ * @file sessions.cpp
+ * @brief Runs many concurrent headless games in one process through a SessionHost.
+ *
+ * Usage: td_sessions [--sessions N] [--levels N] [--ticks N] [--towers N] [--width N]
+ *                    [--height N] [--threads N] [--catalog FILE] [--winding] [--no-share] [--check]
+ *
+ * Opens --sessions games spread over --levels seeds, buys --towers towers in each and steps
+ * all of them for --ticks ticks. Prints the resident memory per game (idle, right after
+ * opening, and after the run) and the aggregate tick rate. --no-share builds every game as
+ * a standalone Simulation with its own map and the global heap, for comparison. --winding
+ * plays on MapGenerator mazes instead of staircase paths. --check replays the first game of
+ * every level as a standalone Simulation and fails unless their state hashes match.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <unistd.h>
+#include "SessionHost.h"
+#include "TowerLayout.h"
+#include "TowerCatalog.h"
+#include "Logger.h"
+
+using namespace std;
+
+/**
+ * @brief Gets the resident set size of the process.
+ * @return Resident memory in bytes, or 0 if /proc is unavailable.
+ */
+static size_t residentBytes() {
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm == nullptr) {
+        return 0;
+    }
+    unsigned long pages = 0, resident = 0;
+    if (fscanf(statm, "%lu %lu", &pages, &resident) != 2) {
+        resident = 0;
+    }
+    fclose(statm);
+    return static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+int main(int argc, char* argv[]) {
+    SimulationConfig config;
+    int sessionCount = 5000;
+    int levelCount = 8;
+    int ticks = 1000;
+    int towers = 4;
+    size_t threads = 0;
+    bool share = true;
+    bool check = false;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--sessions") == 0 && hasValue) {
+            sessionCount = max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "--levels") == 0 && hasValue) {
+            levelCount = max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "--ticks") == 0 && hasValue) {
+            ticks = max(atoi(argv[++i]), 0);
+        } else if (strcmp(argv[i], "--towers") == 0 && hasValue) {
+            towers = max(atoi(argv[++i]), 0);
+        } else if (strcmp(argv[i], "--width") == 0 && hasValue) {
+            config.width = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--height") == 0 && hasValue) {
+            config.height = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = static_cast<size_t>(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--catalog") == 0 && hasValue) {
+            string error;
+            if (!TowerCatalog::instance().load(argv[++i], error)) {
+                fprintf(stderr, "Cannot load tower catalog %s: %s\n", argv[i], error.c_str());
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--winding") == 0) {
+            config.windingPath = true;
+        } else if (strcmp(argv[i], "--no-share") == 0) {
+            share = false;
+        } else if (strcmp(argv[i], "--check") == 0) {
+            check = true;
+        } else {
+            fprintf(stderr, "Unknown or incomplete option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    Logger::instance().setLevel(LOG_OFF);
+    config.startingHealth = 1000000;  // Keep every game running for the whole measurement
+    config.threads = 1;
+    vector<TowerType> layout(static_cast<size_t>(towers), BASIC_TOWER);
+
+    SessionHost host(threads);
+    vector<unique_ptr<Simulation>> standalone;  // Games of the --no-share baseline
+    vector<Simulation*> games;
+    games.reserve(sessionCount);
+
+    size_t baseline = residentBytes();
+    for (int i = 0; i < sessionCount; i++) {
+        SimulationConfig gameConfig = config;
+        gameConfig.seed = 1 + static_cast<unsigned int>(i % levelCount);
+        if (share) {
+            games.push_back(host.get(host.open(gameConfig)));
+        } else {
+            standalone.push_back(make_unique<Simulation>(gameConfig));
+            games.push_back(standalone.back().get());
+        }
+    }
+    size_t idle = residentBytes();
+
+    for (Simulation* game : games) {
+        placeGreedyLayout(*game, layout);
+    }
+
+    auto start = chrono::steady_clock::now();
+    if (share) {
+        host.stepAll(ticks);
+    } else {
+        ThreadPool pool(threads);
+        pool.run(games.size(), [&games, ticks](size_t i) { games[i]->step(ticks); });
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    size_t running = residentBytes();
+
+    printf("%d games on %d levels (%s), %zu threads\n", sessionCount, levelCount,
+           share ? "shared level maps, per-game arenas" : "standalone games", host.getThreadCount());
+    printf("memory per idle game    %8.2f KiB\n", (idle - min(idle, baseline)) / 1024.0 / sessionCount);
+    printf("memory per running game %8.2f KiB\n", (running - min(running, baseline)) / 1024.0 / sessionCount);
+    if (share) {
+        printf("arena per running game  %8.2f KiB\n", host.getArenaBytes() / 1024.0 / sessionCount);
+    }
+    printf("%d ticks per game in %.3f s: %.0f game-ticks/s\n", ticks, seconds,
+           static_cast<double>(ticks) * sessionCount / max(seconds, 1e-9));
+
+    if (check) {
+        // Game i runs on level i % levelCount, so the first levelCount games cover every level
+        int mismatches = 0;
+        for (int i = 0; i < min(levelCount, sessionCount); i++) {
+            SimulationConfig gameConfig = config;
+            gameConfig.seed = 1 + static_cast<unsigned int>(i);
+            Simulation reference(gameConfig);
+            placeGreedyLayout(reference, layout);
+            reference.step(ticks);
+            if (reference.stateHash() != games[i]->stateHash()) {
+                fprintf(stderr, "Seed %u: game hash %016llx, standalone %016llx\n", gameConfig.seed,
+                        static_cast<unsigned long long>(games[i]->stateHash()),
+                        static_cast<unsigned long long>(reference.stateHash()));
+                mismatches++;
+            }
+        }
+        printf("check: %d of %d levels match a standalone game\n", min(levelCount, sessionCount) - mismatches,
+               min(levelCount, sessionCount));
+        if (mismatches > 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
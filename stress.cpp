@@ -0,0 +1,143 @@
+/**
+ * @file stress.cpp
+ * @brief Runs a generated large-scale scenario headless and checks it against scaling targets.
+ *
+ * Usage: td_stress [--preset small|medium|large|huge] [--seed N] [--width N] [--height N]
+ *                  [--towers N] [--aoe FRACTION] [--critters N] [--spawn-ticks N] [--ticks N]
+ *                  [--threads N] [--catalog FILE] [--min-tps N] [--max-rss-mb N]
+ *
+ * Generates the scenario from its seed (map up to 4096x4096, up to 10k towers along the path,
+ * waves of 100k+ critters), simulates --ticks ticks and reports the setup cost, ticks per
+ * second, peak resident memory and the p50/p99/max latency of every tick phase. Options after
+ * --preset override single fields of it. With --min-tps or --max-rss-mb the run exits with
+ * status 2 when a target is missed, so scaling regressions fail a release check.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/resource.h>
+#include "StressScenario.h"
+#include "TowerCatalog.h"
+#include "Profiler.h"
+#include "Logger.h"
+
+using namespace std;
+
+/**
+ * @brief Gets the peak resident set size of the process so far.
+ * @return Peak resident memory in bytes.
+ */
+static size_t peakResidentBytes() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;  // Kilobytes on Linux
+}
+
+/**
+ * @brief Gets the milliseconds elapsed since a time point.
+ */
+static double millisecondsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    StressScenario scenario;
+    findStressPreset("small", scenario);
+    size_t threads = 1;
+    double minTicksPerSecond = 0;
+    double maxResidentMiB = 0;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--preset") == 0 && hasValue) {
+            if (!findStressPreset(argv[++i], scenario)) {
+                fprintf(stderr, "Unknown preset: %s (expected", argv[i]);
+                for (const string& name : getStressPresetNames()) {
+                    fprintf(stderr, " %s", name.c_str());
+                }
+                fprintf(stderr, ")\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            scenario.seed = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "--width") == 0 && hasValue) {
+            scenario.width = min(max(atoi(argv[++i]), 2), 4096);
+        } else if (strcmp(argv[i], "--height") == 0 && hasValue) {
+            scenario.height = min(max(atoi(argv[++i]), 2), 4096);
+        } else if (strcmp(argv[i], "--towers") == 0 && hasValue) {
+            scenario.towers = max(atoi(argv[++i]), 0);
+        } else if (strcmp(argv[i], "--aoe") == 0 && hasValue) {
+            scenario.aoeShare = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--critters") == 0 && hasValue) {
+            scenario.critters = max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "--hp") == 0 && hasValue) {
+            scenario.hitPoints = max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "--spawn-ticks") == 0 && hasValue) {
+            scenario.spawnTicks = max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "--ticks") == 0 && hasValue) {
+            scenario.ticks = max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = static_cast<size_t>(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--catalog") == 0 && hasValue) {
+            string error;
+            if (!TowerCatalog::instance().load(argv[++i], error)) {
+                fprintf(stderr, "Cannot load tower catalog %s: %s\n", argv[i], error.c_str());
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--min-tps") == 0 && hasValue) {
+            minTicksPerSecond = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--max-rss-mb") == 0 && hasValue) {
+            maxResidentMiB = atof(argv[++i]);
+        } else {
+            fprintf(stderr, "Unknown or incomplete option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    // Towers log on construction; keep that out of the measurements
+    Logger::instance().setLevel(LOG_OFF);
+
+    auto start = chrono::steady_clock::now();
+    Simulation sim(makeStressConfig(scenario, threads));
+    double mapMs = millisecondsSince(start);
+
+    start = chrono::steady_clock::now();
+    int placed = placeStressTowers(sim, scenario);
+    double towerMs = millisecondsSince(start);
+
+    Profiler profiler;
+    sim.setProfiler(&profiler);
+    size_t peakCritters = 0;
+    start = chrono::steady_clock::now();
+    for (int tick = 0; tick < scenario.ticks; tick++) {
+        sim.step();
+        peakCritters = max(peakCritters, sim.getCritterView().size());
+    }
+    double seconds = millisecondsSince(start) / 1000.0;
+    double ticksPerSecond = scenario.ticks / max(seconds, 1e-9);
+    double residentMiB = peakResidentBytes() / (1024.0 * 1024.0);
+
+    printf("scenario %s, seed %u: %dx%d map, %d towers, %d critters per wave, %zu threads\n",
+           scenario.name.c_str(), scenario.seed, scenario.width, scenario.height, placed, scenario.critters, threads);
+    printf("setup: map %.1f ms, towers %.1f ms\n", mapMs, towerMs);
+    printf("%d ticks in %.3f s: %.1f ticks/s\n", scenario.ticks, seconds, ticksPerSecond);
+    printf("peak critters %zu, wave %d, kills %d, leaks %d, projectile overflows %zu\n", peakCritters, sim.getWave(),
+           sim.getKills(), sim.getLeaks(), sim.getProjectiles().getOverflowCount());
+    printf("peak memory %.1f MiB\n\n", residentMiB);
+    profiler.printSummary(stdout);
+
+    int status = 0;
+    if (minTicksPerSecond > 0 && ticksPerSecond < minTicksPerSecond) {
+        fprintf(stderr, "FAIL: %.1f ticks/s is below the target of %.1f\n", ticksPerSecond, minTicksPerSecond);
+        status = 2;
+    }
+    if (maxResidentMiB > 0 && residentMiB > maxResidentMiB) {
+        fprintf(stderr, "FAIL: peak memory %.1f MiB is above the target of %.1f MiB\n", residentMiB, maxResidentMiB);
+        status = 2;
+    }
+    return status;
+}
@@ -4,105 +4,156 @@
  */
 
 #include "tower.h"
+#include "TowerRegistry.h"
+#include "Logger.h"
+#include "Zobrist.h"
 
 /**
- * @brief Constructs a Tower object with specified properties.
+ * @brief Constructs a level-1 Tower at a cell.
  */
-Tower::Tower(int x, int y, int cost, int refund, int range, int power, int fireRate, int upgradeCost)
-    : x(x), y(y), buyCost(cost), refundValue(refund), range(range), power(power), fireRate(fireRate), upgradeCost(upgradeCost), level(1) {
-    cout << "Tower created at (" << x << ", " << y << ")\n";
+Tower::Tower(int x, int y) : x(x), y(y), level(1), stateHash(nullptr) {
+    TD_LOG_INFO("Tower created at (%d, %d)", x, y);
 }
 
 /**
- * @brief Upgrades the tower, increasing attack power and refund value.
+ * @brief Upgrades the tower to the next level of its catalog row.
+ * @return True if the tower was upgraded, false if it is already at max level.
  */
-void Tower::upgrade() {
-    if (level < 3) {
+bool Tower::upgrade() {
+    if (level < TowerCatalog::instance().getMaxLevel(getType())) {
+        if (stateHash != nullptr) {
+            *stateHash ^= zobristKey();
+        }
         level++;
-        power += 5;
-        refundValue += 25;
-        cout << "Tower at (" << x << ", " << y << ") upgraded to level " << level << "!\n";
-    } else {
-        cout << "Tower is already at max level!\n";
+        if (stateHash != nullptr) {
+            *stateHash ^= zobristKey();
+        }
+        TD_LOG_INFO("Tower at (%d, %d) upgraded to level %d!", x, y, level);
+        return true;
+    }
+    TD_LOG_WARN("Tower at (%d, %d) is already at max level!", x, y);
+    return false;
+}
+
+/**
+ * @brief Gets the Zobrist key of the tower.
+ * @return Key derived from the tower's cell, type and level.
+ */
+uint64_t Tower::zobristKey() const {
+    return zobristKey(x, y, getType(), level);
+}
+
+/**
+ * @brief Gets the Zobrist key of a tower that need not exist.
+ *
+ * @param x X-coordinate of the tower's cell.
+ * @param y Y-coordinate of the tower's cell.
+ * @param type Tower type.
+ * @param level Tower level.
+ * @return Key derived from the cell, type and level.
+ */
+uint64_t Tower::zobristKey(int x, int y, TowerType type, int level) {
+    return ::zobristKey(ZOBRIST_TOWER, zobristCell(x, y), (static_cast<uint64_t>(type) << 8) | static_cast<uint64_t>(level));
+}
+
+/**
+ * @brief Moves the tower's key from its current owner hash to another one.
+ * @param hash Hash to keep current from now on, or nullptr to detach.
+ */
+void Tower::attachStateHash(uint64_t* hash) {
+    if (stateHash != nullptr) {
+        *stateHash ^= zobristKey();
+    }
+    stateHash = hash;
+    if (stateHash != nullptr) {
+        *stateHash ^= zobristKey();
     }
 }
 
 /**
- * @brief Constructs a BasicTower with predefined attributes.
+ * @brief Constructs a level-1 BasicTower.
  */
-BasicTower::BasicTower(int x, int y) : Tower(x, y, 100, 50, 3, 10, 1, 50) {}
+BasicTower::BasicTower(int x, int y) : Tower(x, y) {}
 
 /**
- * @brief Attacks the first critter within range.
+ * @brief Fires a projectile at the first critter within range.
  */
-void BasicTower::attack(vector<Critter>& critters) {
-    for (Critter& critter : critters) {
+void BasicTower::attack(ConstCritterSpan critters, DamageBuffer& hits) {
+    const TowerLevelStats& stats = getStats();
+    for (size_t i = 0; i < critters.size(); i++) {
+        const Critter& critter = critters[i];
         if (critter.isDead()) continue;
-        if (abs(critter.getPosition().first - x) + abs(critter.getPosition().second - y) <= range) {
-            critter.takeDamage(power);
-            cout << "BasicTower at (" << x << ", " << y << ") hit a critter for " << power << " damage!\n";
+        if (abs(critter.getPosition().first - x) + abs(critter.getPosition().second - y) <= stats.range) {
+            hits.addShot(i, stats.power, x, y, stats.projectileSpeed);
             return;
         }
     }
 }
 
 /**
- * @brief Constructs an AoETower with predefined attributes.
+ * @brief Fires a projectile at the first critter within range, looking only at nearby critters.
+ */
+void BasicTower::attack(const CritterIndex& index, DamageBuffer& hits) {
+    const TowerLevelStats& stats = getStats();
+    int target = index.findFirst(x, y, stats.range);
+    if (target >= 0) {
+        hits.addShot(static_cast<size_t>(target), stats.power, x, y, stats.projectileSpeed);
+    }
+}
+
+/**
+ * @brief Constructs a level-1 AoETower.
  */
-AoETower::AoETower(int x, int y) : Tower(x, y, 200, 100, 2, 7, 1, 75) {}
+AoETower::AoETower(int x, int y) : Tower(x, y) {}
 
 /**
  * @brief Attacks multiple critters within range.
  */
-void AoETower::attack(vector<Critter>& critters) {
-    for (Critter& critter : critters) {
+void AoETower::attack(ConstCritterSpan critters, DamageBuffer& hits) {
+    const TowerLevelStats& stats = getStats();
+    for (size_t i = 0; i < critters.size(); i++) {
+        const Critter& critter = critters[i];
         if (critter.isDead()) continue;
-        if (abs(critter.getPosition().first - x) + abs(critter.getPosition().second - y) <= range) {
-            critter.takeDamage(power);
-            cout << "AoETower at (" << x << ", " << y << ") hit multiple critters for " << power << " damage!\n";
+        if (abs(critter.getPosition().first - x) + abs(critter.getPosition().second - y) <= stats.range) {
+            hits.addHit(i, stats.power);
         }
     }
 }
 
 /**
- * @brief Allows the user to place a tower interactively.
+ * @brief Attacks every critter within range, looking only at nearby critters.
+ *
+ * Hits are recorded in bucket order rather than slot order; damage is summed per slot, so
+ * the outcome is the same.
  */
-void placeTowerInteractive(Map& map, vector<Tower*>& towers) {
-    int x, y;
-    cout << "Enter tower coordinates (x y): ";
-    cin >> x >> y;
+void AoETower::attack(const CritterIndex& index, DamageBuffer& hits) {
+    const TowerLevelStats& stats = getStats();
+    index.forEachInRange(x, y, stats.range, [&](uint32_t slot) { hits.addHit(slot, stats.power); });
+}
 
+/**
+ * @brief Checks whether a tower can be built on a cell, logging why not.
+ *
+ * @param map Reference to the game map.
+ * @param towers Registry of currently placed towers.
+ * @param x X-coordinate of the cell.
+ * @param y Y-coordinate of the cell.
+ * @return True if the cell is on the map, off the path (unless the map is open-field) and free.
+ */
+bool checkBuildable(const Map& map, const TowerRegistry& towers, int x, int y) {
     if (!map.isValidCoordinate(x, y)) {
-        cout << "Invalid coordinates!\n";
-        return;
+        TD_LOG_WARN("Invalid coordinates!");
+        return false;
     }
 
-    if (map.isPath(x, y)) {
-        cout << "Cannot place a tower on a path!\n";
-        return;
+    if (map.isPath(x, y) && !map.isOpenField()) {
+        TD_LOG_WARN("Cannot place a tower on a path!");
+        return false;
     }
 
-    for (Tower* t : towers) {
-        if (t->getX() == x && t->getY() == y) {
-            cout << "There is already a tower here!\n";
-            return;
-        }
+    if (towers.findAt(x, y).isValid()) {
+        TD_LOG_WARN("There is already a tower here!");
+        return false;
     }
-
-    cout << "Choose a tower type:\n1. Basic Tower (100 gold)\n2. AoE Tower (200 gold)\nEnter choice: ";
-    int choice;
-    cin >> choice;
-
-    Tower* newTower = nullptr;
-    if (choice == 1) {
-        newTower = new BasicTower(x, y);
-    } else if (choice == 2) {
-        newTower = new AoETower(x, y);
-    } else {
-        cout << "Invalid choice!\n";
-        return;
-    }
-
-    towers.push_back(newTower);
-    cout << "Tower placed at (" << x << ", " << y << ")\n";
+    return true;
 }
@@ -8,56 +8,110 @@
 
 #include <iostream>
 #include <vector>
+#include <cstdint>
 #include "mapgen.h"
 #include "critter.h"
+#include "DamageBuffer.h"
+#include "CritterIndex.h"
+#include "TowerCatalog.h"
 
 using namespace std;
 
+class TowerRegistry;
+
 /**
  * @class Tower
  * @brief Base class for all tower types.
  *
- * This class defines the fundamental properties of a tower, including:
- * - Position (x, y)
- * - Attack power, range, fire rate
- * - Purchase & refund value
- * - Upgrade mechanics
+ * A tower only stores its position and level; its attack power, range, fire rate, purchase
+ * and refund values and upgrade costs are read from the TowerCatalog row of its type and level.
  */
 class Tower {
 protected:
     int x, y;        ///< Tower position on the map
-    int buyCost;     ///< Gold cost to purchase the tower
-    int refundValue; ///< Gold refunded when selling the tower
-    int range;       ///< Attack range (radius in grid units)
-    int power;       ///< Attack damage
-    int fireRate;    ///< Attack speed (shots per second)
-    int level;       ///< Tower level (1-3)
-    int upgradeCost; ///< Gold required to upgrade
+    int level;       ///< Tower level, from 1 to the catalog's max level for the type
+    uint64_t* stateHash; ///< Zobrist hash of the owning registry, kept current by upgrade(); nullptr if unowned
 
 public:
-    Tower(int x, int y, int cost, int refund, int range, int power, int fireRate, int upgradeCost);
+    Tower(int x, int y);
     virtual ~Tower() {}
 
-    virtual void attack(vector<Critter>& critters) = 0;
-    void upgrade();
+    /** @brief Gets the concrete type of the tower. */
+    virtual TowerType getType() const = 0;
+
+    /**
+     * @brief Chooses targets among the critters and records the hits in a damage buffer.
+     * @param critters Active critters; they are only read, damage is applied when the buffer is resolved.
+     * @param hits Per-tick damage buffer indexed by critter slot.
+     */
+    virtual void attack(ConstCritterSpan critters, DamageBuffer& hits) = 0;
+
+    /**
+     * @brief Same as attack(critters, hits), but only looks at the critters near the tower.
+     *
+     * Chooses exactly the targets the linear scan would.
+     * @param index Spatial index built from the same critter view.
+     * @param hits Per-tick damage buffer indexed by critter slot.
+     */
+    virtual void attack(const CritterIndex& index, DamageBuffer& hits) = 0;
+
+    /**
+     * @brief Upgrades the tower by one level.
+     * @return True if the tower was upgraded, false if it is already at max level.
+     */
+    bool upgrade();
+
+    /**
+     * @brief Gets the Zobrist key of the tower: its cell, type and level.
+     * @return Key to XOR into a state hash.
+     */
+    uint64_t zobristKey() const;
+
+    /**
+     * @brief Gets the Zobrist key of a tower that need not exist, e.g. one of a planned layout.
+     * @param x X-coordinate of the tower's cell.
+     * @param y Y-coordinate of the tower's cell.
+     * @param type Tower type.
+     * @param level Tower level.
+     * @return The key a tower with these properties would have.
+     */
+    static uint64_t zobristKey(int x, int y, TowerType type, int level);
+
+    /**
+     * @brief Moves the tower's key from its current owner hash to another one.
+     * @param hash Hash to keep current from now on, or nullptr to detach.
+     */
+    void attachStateHash(uint64_t* hash);
+
+    /** @brief Gets the catalog stats of the tower's type at its current level. */
+    const TowerLevelStats& getStats() const { return TowerCatalog::instance().get(getType(), level); }
 
     int getX() { return x; }
     int getY() { return y; }
-    int getRange() { return range; }
-    int getPower() { return power; }
-    int getBuyCost() { return buyCost; }
-    int getRefundValue() { return refundValue; }
+    int getRange() { return getStats().range; }
+    int getPower() { return getStats().power; }
+    int getBuyCost() { return TowerCatalog::instance().get(getType(), 1).cost; }
+    int getRefundValue() { return getStats().refund; }
     int getLevel() { return level; }
+
+    /** @brief Gets the gold needed for the next level, or 0 if the tower is at max level. */
+    int getUpgradeCost() {
+        const TowerCatalog& catalog = TowerCatalog::instance();
+        return level < catalog.getMaxLevel(getType()) ? catalog.get(getType(), level + 1).cost : 0;
+    }
+    int getProjectileSpeed() { return getStats().projectileSpeed; }
 };
 
 /**
  * @class BasicTower
- * @brief A tower that deals single-target damage.
+ * @brief A tower that fires single-target projectiles.
  */
 class BasicTower : public Tower {
 public:
     BasicTower(int x, int y);
-    void attack(vector<Critter>& critters) override;
+    TowerType getType() const override { return BASIC_TOWER; }
+    void attack(ConstCritterSpan critters, DamageBuffer& hits) override;
+    void attack(const CritterIndex& index, DamageBuffer& hits) override;
 };
 
 /**
@@ -67,14 +121,19 @@ public:
 class AoETower : public Tower {
 public:
     AoETower(int x, int y);
-    void attack(vector<Critter>& critters) override;
+    TowerType getType() const override { return AOE_TOWER; }
+    void attack(ConstCritterSpan critters, DamageBuffer& hits) override;
+    void attack(const CritterIndex& index, DamageBuffer& hits) override;
 };
 
 /**
- * @brief Allows the user to place a tower interactively.
+ * @brief Checks whether a tower can be built on a cell, logging why not.
  * @param map Reference to the game map.
- * @param towers Vector of currently placed towers.
+ * @param towers Registry of currently placed towers.
+ * @param x X-coordinate of the cell.
+ * @param y Y-coordinate of the cell.
+ * @return True if the cell is on the map, off the path (unless the map is open-field) and free.
  */
-void placeTowerInteractive(Map& map, vector<Tower*>& towers);
+bool checkBuildable(const Map& map, const TowerRegistry& towers, int x, int y);
 
 #endif // TOWER_H